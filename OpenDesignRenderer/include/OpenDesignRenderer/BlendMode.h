@@ -0,0 +1,12 @@
+#pragma once
+
+namespace odr {
+//! Arithmetic used to blend straight (non-premultiplied) alpha colors.
+enum class BlendMode {
+    //! Floating point, see PixelColor::Blend. The reference results.
+    Float,
+    //! Integer fixed point, see PixelColor::BlendFixedPoint. At most 1 off the Float results in each color channel.
+    //! Faster than Float with every instruction set, about 2.5x with AVX2 on translucent pixels.
+    FixedPoint,
+};
+}
@@ -1,18 +1,37 @@
 #pragma once
 
+#include <stddef.h>
+
+#include <memory>
+#include <mutex>
 #include <string>
 
+#include <OpenDesignRenderer/ImageComparison.h>
+#include <OpenDesignRenderer/ImageContentInfo.h>
 #include <OpenDesignRenderer/ImageDimensions.h>
+#include <OpenDesignRenderer/ImageHash.h>
+#include <OpenDesignRenderer/ImageSaveSettings.h>
+#include <OpenDesignRenderer/ImageView.h>
+#include <OpenDesignRenderer/InstructionSet.h>
 #include <OpenDesignRenderer/PixelCoordinates.h>
+#include <OpenDesignRenderer/PixelFormat.h>
+#include <OpenDesignRenderer/PixelRectangle.h>
+#include <OpenDesignRenderer/ResamplingFilter.h>
 
 
 // Forward declarations
 namespace odr {
+class ImageResampler;
+class MipmapPyramid;
+class PixelBuffer;
 struct PixelColor;
 }
 
 namespace odr {
-//! 2D Image representation.
+/*!
+    \brief 2D Image representation.
+    \note Image data is allocated from the image allocator current on the calling thread, see ImageAllocatorScope.
+*/
 class Image {
 public:
     //! Construct an unitialized image.
@@ -20,42 +39,187 @@ public:
     //! Destructor.
     ~Image();
 
+    //! Take over the data of another image without copying it. The other image is left uninitialized.
+    Image(Image&& other) noexcept;
+    //! Release the data of this image and take over the data of another one, see the move constructor.
+    Image& operator=(Image&& other) noexcept;
+    //! Images are copied explicitly, see CloneFrom.
+    Image(const Image&) = delete;
+    Image& operator=(const Image&) = delete;
+
     //! Detect if the image is initialized (has data and non-null dimensions).
     bool IsInitialized() const;
 
     //! Clear the image - return to uninitialized state.
     void Clear();
-    //! Initialize an image with the specified dimensions and color.
-    bool Initialize(const ImageDimensions& dimensions, const PixelColor& color);
-    //! Clone from the specified other image - perform a deep copy of the other image and its data.
+    //! Initialize an image with the specified dimensions, color and pixel format. Reuses the data buffer of the same size.
+    bool Initialize(const ImageDimensions& dimensions, const PixelColor& color, PixelFormat pixelFormat = PixelFormat::Straight);
+    /*!
+        \brief Clone from the specified other image - a copy of the other image that shares its data.
+        \note The data is copied when either of the images changes it first, through SetColor, ConvertToPixelFormat or
+            the GetRowData pointers. Images sharing data may be used and changed on different threads: an image
+            changes the data in place only after all reads of the other images released since are complete.
+    */
     bool CloneFrom(const Image& otherImage);
 
-    //! Load image from an RGBA file on the filesystem.
-    bool Load(const std::string& filepath);
-    //! Save image to an RGBA file on the filesystem.
-    bool Save(const std::string& filepath) const;
+    //! Load image from an RGBA file on the filesystem and convert it to the specified pixel format.
+    bool Load(const std::string& filepath, PixelFormat pixelFormat = PixelFormat::Straight);
+    /*!
+        \brief Load image from an RGBA file by mapping it into memory, without copying the pixel data.
+        \note The image data stays in the page cache shared with other processes mapping the file. Pages are copied
+            privately on their first change, the file is never written. Conversion to another pixel format changes
+            all pages. Falls back to Load on platforms without memory mapping.
+            The file must not be modified at all while it is mapped: writes by others show through the private mapping
+            in pages not yet copied, and are neither detected nor reflected in the content identifier. Truncation makes
+            reads of the lost pages crash.
+    */
+    bool LoadMapped(const std::string& filepath, PixelFormat pixelFormat = PixelFormat::Straight);
+    //! Detect if the image data is a memory mapped file, see LoadMapped.
+    bool IsFileMapped() const;
+    //! Detect if the image data is shared with other images, see CloneFrom.
+    bool IsDataShared() const;
+    /*!
+        \brief Give the image a private copy of its data if it is shared with other images.
+        \note Done by all methods changing the image. Call it before changing the image through GetRowData pointers
+            from multiple threads, the copy itself is not thread-safe.
+    */
+    bool DetachData();
+    /*!
+        \brief Save image to an RGBA file on the filesystem. RGBA files always contain straight alpha.
+        \note The pixels are written straight from the image data, premultiplied images are converted in small chunks.
+    */
+    bool Save(const std::string& filepath, const ImageSaveSettings& settings = ImageSaveSettings()) const;
 
     //! Provide read-only access to image dimensions.
     const ImageDimensions& GetDimensions() const;
+    //! Pixel format of the image data.
+    PixelFormat GetPixelFormat() const;
+    /*!
+        \brief Identifier of the current image content, unique within the process.
+        \note A new identifier is assigned whenever the image changes through its methods. Changes made through
+            the GetRowData pointers are not detected, call MarkContentChanged after them.
+    */
+    uint64_t GetContentId() const;
+    //! Assign a new content identifier after the image data was changed through the GetRowData pointers.
+    void MarkContentChanged();
+    /*!
+        \brief 128-bit hash of the pixels, dimensions and pixel format, e.g. to key caches on content or to deduplicate assets.
+        \note Computed at memory bandwidth on first use and cached until the content identifier changes, see GetContentId.
+            Images sharing data through CloneFrom share the hash. Safe to call from multiple threads.
+        \param maxInstructionSet Fastest hash kernel to use if supported by the CPU. All kernels give identical hashes.
+    */
+    ImageHash GetContentHash(InstructionSet maxInstructionSet = InstructionSet::Avx2) const;
+    /*!
+        \brief Opacity, uniformity and bounds of the non-transparent pixels, e.g. to copy, skip or clip images when drawing.
+        \note Computed in one pass over the pixels on first use and cached until the content identifier changes, like
+            GetContentHash. Images sharing data through CloneFrom share the info. Safe to call from multiple threads.
+    */
+    ImageContentInfo GetContentInfo() const;
+    //! Convert the image data to another pixel format. Conversion to premultiplied alpha loses color precision.
+    bool ConvertToPixelFormat(PixelFormat newPixelFormat);
 
-    //! Get color at pixel.
+    //! Get color at pixel. The color is in straight alpha regardless of the pixel format.
     PixelColor GetColor(const PixelCoordinates& coords) const;
-    //! Set color at pixel.
+    //! Set color at pixel. The color is in straight alpha regardless of the pixel format.
     bool SetColor(const PixelColor& color, const PixelCoordinates& coords);
 
+    //! Set all pixels to the color, in straight alpha. Runs at memory bandwidth.
+    bool Fill(const PixelColor& color);
+    //! Set the pixels of a rectangle to the color, in straight alpha. The rectangle is clipped to the image.
+    bool FillRect(const PixelRectangle& rectangle, const PixelColor& color);
+    /*!
+        \brief Copy a rectangle of pixels of the source image to a position in this image, converting the pixel format.
+        \note The rectangle is clipped to both images. The source may be this image, overlapping rectangles are handled.
+    */
+    bool CopyRect(const Image& source, const PixelRectangle& sourceRectangle, const PixelCoordinates& targetPosition);
+
+    //! Distance between the starts of two consecutive rows of the GetRowData pointers, in bytes.
+    size_t GetRowStride() const;
+    //! Read-only access to the RGBA data of a row, in the image pixel format. Returns nullptr for rows outside of the image.
+    const unsigned char* GetRowData(uint32_t top) const;
+    /*!
+        \brief Access to the RGBA data of a row, in the image pixel format, for changing it. Returns nullptr for rows outside of the image.
+        \note Copies data shared with other images first, see CloneFrom. Use the const overload for reading.
+    */
+    unsigned char* GetRowData(uint32_t top);
+
     //! Detect if another image is identical to this one.
     bool operator==(const Image& other) const;
 
-    //! Construct a new image that is the result of scaling this image to new dimensions.
-    Image Scaled(const ImageDimensions& newDimensions) const;
+    //! Construct a new image that is the result of scaling this image to new dimensions. Keeps the pixel format.
+    Image Scaled(const ImageDimensions& newDimensions, ResamplingFilter filter = ResamplingFilter::Box) const;
+
+    /*!
+        \brief Enable or disable the mipmap pyramid of the image - copies of it halved until a side is 1 pixel.
+        \note When enabled, Scaled and RenderingEngine::Draw start downscales from the smallest level at least as
+            large as the scaled image instead of the full image. The pyramid is built on the first such downscale
+            and rebuilt after the image changes. It takes up to a third of the image memory. Disabled by default.
+    */
+    void SetMipmapsEnabled(bool isEnabled);
+    //! Detect if the mipmap pyramid is enabled, see SetMipmapsEnabled.
+    bool IsMipmapsEnabled() const;
+    //! Release the mipmap pyramid, e.g. under memory pressure. It is built again when needed.
+    void DiscardMipmaps() const;
+    //! Memory taken by the built mipmap pyramid, in bytes. Zero when it is not built.
+    size_t GetMipmapByteSize() const;
 
-    //! Comoute the absolute difference between two images.
-    static Image AbsoluteDiff(const Image& imageA, const Image& imageB);
+    //! Comoute the absolute difference between two images, or views of any parts of images.
+    static Image AbsoluteDiff(const ImageView& imageA, const ImageView& imageB);
+    /*!
+        \brief Compare two images, or views of any parts of images, row by row without allocating a diff image.
+        \param settings The tolerance, early exit and instruction set of the comparison.
+        \param diffImage Receives the absolute difference like AbsoluteDiff when not nullptr. Rows not compared
+            because of an early exit are transparent.
+    */
+    static ImageComparison Compare(
+        const ImageView& imageA,
+        const ImageView& imageB,
+        const ImageComparisonSettings& settings = ImageComparisonSettings(),
+        Image* diffImage = nullptr);
 
 private:
+    friend class ImageResampler;
+
+    //! Prepare an uninitialized buffer for the dimensions, reuse the current one if it has the same size.
+    bool Allocate(const ImageDimensions& newDimensions, PixelFormat newPixelFormat);
+    //! Replace the pixel buffer, counting this image as an owner of the new one only, see PixelBuffer::AddOwner.
+    void SetPixelBuffer(std::shared_ptr<PixelBuffer> newPixelBuffer);
+
+    //! Mipmap pyramid of the current content, built when missing or outdated. Safe to call from multiple threads.
+    std::shared_ptr<const MipmapPyramid> GetMipmaps() const;
+
     //! Image dimensions - width and height.
     ImageDimensions dimensions = IMAGE_DIMENSIONS_EMPTY;
-    //! Image data buffer.
+    //! Pixel format of the image data.
+    PixelFormat pixelFormat = PixelFormat::Straight;
+    //! Memory holding the image data, possibly shared with other images or a mapped RGBA file.
+    std::shared_ptr<PixelBuffer> pixelBuffer;
+    //! Image data inside the pixel buffer.
     unsigned char* imageBuffer = nullptr;
+    //! See GetContentId.
+    uint64_t contentId = 0;
+    //! See SetMipmapsEnabled.
+    bool isMipmapsEnabled = false;
+    //! Built mipmap pyramid, accessed atomically. May be of older content.
+    mutable std::shared_ptr<const MipmapPyramid> mipmaps;
+    //! Serializes building of the mipmap pyramid, so concurrent draws of the image build it only once.
+    //! Builds of different images do not wait for each other. Not moved with the image.
+    mutable std::mutex mipmapBuildMutex;
+
+    //! A content hash and the content identifier it was computed for.
+    struct CachedContentHash {
+        uint64_t contentId;
+        ImageHash hash;
+    };
+    //! Computed content hash, accessed atomically. May be of older content.
+    mutable std::shared_ptr<const CachedContentHash> contentHash;
+
+    //! Content info and the content identifier it was computed for.
+    struct CachedContentInfo {
+        uint64_t contentId;
+        ImageContentInfo info;
+    };
+    //! Computed content info, accessed atomically. May be of older content.
+    mutable std::shared_ptr<const CachedContentInfo> contentInfo;
 };
 }
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <memory>
+
+namespace odr {
+/*!
+    \brief Source of the memory of image data, with usage statistics.
+    \note The base class allocates from the system heap. Images allocate their data from the allocator current on
+        the calling thread, see ImageAllocatorScope, and keep it alive until the data is released. Thread-safe.
+*/
+class ImageAllocator {
+public:
+    //! Alignment of all allocated memory, a cache line, enough for all SIMD loads.
+    static constexpr size_t ALIGNMENT = 64;
+
+    ImageAllocator();
+    virtual ~ImageAllocator();
+
+    ImageAllocator(const ImageAllocator&) = delete;
+    ImageAllocator& operator=(const ImageAllocator&) = delete;
+
+    //! Allocate memory aligned to ALIGNMENT. nullptr on failure.
+    virtual void* Allocate(size_t size);
+    //! Release memory returned by Allocate for the same size.
+    virtual void Deallocate(void* data, size_t size);
+
+    //! Number of bytes allocated and not released yet.
+    size_t GetLiveByteSize() const;
+    //! The highest number of live bytes so far.
+    size_t GetPeakLiveByteSize() const;
+    //! Number of allocations so far.
+    uint64_t GetAllocationCount() const;
+    //! Number of allocations served with released memory, without the system heap.
+    uint64_t GetReusedAllocationCount() const;
+    //! Share of reused allocations, between 0 and 1.
+    double GetReuseRate() const;
+
+    //! Allocator of new image data on the calling thread - of the innermost ImageAllocatorScope, or the default one.
+    static std::shared_ptr<ImageAllocator> GetCurrent();
+    //! Process-wide allocator used outside of any ImageAllocatorScope.
+    static const std::shared_ptr<ImageAllocator>& GetDefault();
+
+protected:
+    //! Aligned memory from the system heap, not counted in the statistics.
+    static void* AllocateFromSystem(size_t size);
+    static void DeallocateToSystem(void* data);
+
+    //! Count an allocation in the statistics.
+    void CountAllocation(size_t size, bool isReused);
+    //! Count a deallocation in the statistics.
+    void CountDeallocation(size_t size);
+
+private:
+    std::atomic<size_t> liveByteSize;
+    std::atomic<size_t> peakLiveByteSize;
+    std::atomic<uint64_t> allocationCount;
+    std::atomic<uint64_t> reusedAllocationCount;
+};
+
+/*!
+    \brief Makes an allocator current for new image data on the calling thread while the scope exists.
+    \note Scopes nest, the innermost one wins. Typically spans one render job using an ImagePoolAllocator.
+*/
+class ImageAllocatorScope {
+public:
+    explicit ImageAllocatorScope(std::shared_ptr<ImageAllocator> allocator);
+    ~ImageAllocatorScope();
+
+    ImageAllocatorScope(const ImageAllocatorScope&) = delete;
+    ImageAllocatorScope& operator=(const ImageAllocatorScope&) = delete;
+
+private:
+    friend class ImageAllocator;
+
+    std::shared_ptr<ImageAllocator> allocator;
+    //! The scope current before this one.
+    ImageAllocatorScope* outerScope;
+};
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <OpenDesignRenderer/InstructionSet.h>
+
+namespace odr {
+//! Image::Compare configuration.
+struct ImageComparisonSettings {
+    //! Largest channel difference of pixels considered equal.
+    uint8_t tolerance = 0;
+    /*!
+        Stop comparing once more pixels than this differ by more than the tolerance. The statistics then only
+        cover the rows compared so far, see ImageComparison::isComplete.
+    */
+    uint64_t maxDifferentPixelCount = UINT64_MAX;
+    //! The most advanced instruction set the comparison may use. Lowered automatically if the CPU does not support it.
+    InstructionSet maxInstructionSet = InstructionSet::Avx2;
+};
+
+/*!
+    \brief Statistics of the channel differences between two images, see Image::Compare.
+    \note Straight alpha colors are compared. Pixels outside of one of the images are compared to transparent black.
+*/
+struct ImageComparison {
+    //! Number of compared pixels.
+    uint64_t pixelCount = 0;
+    //! Number of pixels with a channel differing by more than the tolerance.
+    uint64_t differentPixelCount = 0;
+    //! Largest difference of a channel.
+    uint8_t maxChannelError = 0;
+    //! Mean absolute difference of all channels.
+    double meanError = 0.0;
+    //! Root mean square difference of all channels.
+    double rmsError = 0.0;
+    //! Peak signal-to-noise ratio in decibels, infinity for identical images.
+    double psnr = 0.0;
+    //! False if the comparison stopped early, see ImageComparisonSettings::maxDifferentPixelCount.
+    bool isComplete = true;
+
+    //! Detect if all pixels were compared and none differs by more than the tolerance.
+    bool IsMatch() const {
+        return isComplete && differentPixelCount == 0;
+    }
+};
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <OpenDesignRenderer/PixelColor.h>
+#include <OpenDesignRenderer/PixelRectangle.h>
+
+namespace odr {
+//! Properties of all pixels of an image, see Image::GetContentInfo.
+struct ImageContentInfo {
+    //! All pixels have full alpha. Uninitialized images are neither opaque nor transparent.
+    bool isOpaque = false;
+    //! All pixels have zero alpha.
+    bool isTransparent = false;
+    //! All pixels are stored as the same bytes.
+    bool isUniform = false;
+    //! The color of all pixels of a uniform image, in straight alpha. Transparent otherwise.
+    PixelColor uniformColor = COLOR_TRANSPARENT;
+    //! The smallest rectangle containing all pixels with non-zero alpha. Empty for transparent images.
+    PixelRectangle contentBounds = PIXEL_RECTANGLE_EMPTY;
+};
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <functional>
+
+namespace odr {
+//! 128-bit hash of the content of an image, see Image::GetContentHash.
+struct ImageHash {
+    uint64_t low = 0;
+    uint64_t high = 0;
+
+    bool operator==(const ImageHash& other) const {
+        return low == other.low && high == other.high;
+    }
+    bool operator!=(const ImageHash& other) const {
+        return !(*this == other);
+    }
+};
+}
+
+namespace std {
+//! Image hashes as keys of unordered containers, e.g. to deduplicate assets.
+template<>
+struct hash<odr::ImageHash> {
+    size_t operator()(const odr::ImageHash& imageHash) const noexcept {
+        return static_cast<size_t>(imageHash.low);
+    }
+};
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <OpenDesignRenderer/ImageAllocator.h>
+
+namespace odr {
+/*!
+    \brief Image allocator recycling released memory by size class, for jobs churning through same-sized images.
+    \note Sizes are rounded up to classes at most 25% apart, released memory is kept for the next allocation of
+        its class. Everything kept is released by ReleaseCached and by the destructor - at the end of the job,
+        once the images allocated by it are released. Thread-safe.
+*/
+class ImagePoolAllocator : public ImageAllocator {
+public:
+    //! Construct an empty pool keeping at most maxCachedByteSize bytes of released memory.
+    explicit ImagePoolAllocator(size_t maxCachedByteSize = SIZE_MAX);
+    ~ImagePoolAllocator() override;
+
+    void* Allocate(size_t size) override;
+    void Deallocate(void* data, size_t size) override;
+
+    //! Number of bytes of released memory kept for reuse.
+    size_t GetCachedByteSize() const;
+    //! Return all kept memory to the system.
+    void ReleaseCached();
+
+    //! Size of the memory allocated for a requested size.
+    static size_t GetSizeClass(size_t size);
+
+private:
+    const size_t maxCachedByteSize;
+
+    mutable std::mutex mutex;
+    //! Released memory by size class.
+    std::unordered_map<size_t, std::vector<void*>> cachedBuffers;
+    size_t cachedByteSize = 0;
+};
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+namespace odr {
+//! Image::Save configuration.
+struct ImageSaveSettings {
+    //! Flush the file to the storage device before Save returns (fsync), so it survives a system crash. Slower.
+    bool isSynced = false;
+    /*!
+        Write around the page cache (O_DIRECT), so saving large renders does not evict other cached files.
+        Done through a small aligned buffer. Ignored where not supported by the platform or the file system.
+    */
+    bool isDirect = false;
+};
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+
+#include <OpenDesignRenderer/ImageDimensions.h>
+#include <OpenDesignRenderer/ImageSaveSettings.h>
+#include <OpenDesignRenderer/PixelCoordinates.h>
+#include <OpenDesignRenderer/PixelFormat.h>
+#include <OpenDesignRenderer/PixelRectangle.h>
+#include <OpenDesignRenderer/ResamplingFilter.h>
+
+
+// Forward declarations
+namespace odr {
+class Image;
+struct PixelColor;
+}
+
+namespace odr {
+/*!
+    \brief Read-only view of RGBA pixels owned elsewhere - a whole image, a part of it, or any strided memory.
+    \note Views are cheap to copy and never copy the pixels. The viewed memory must outlive the view and not move:
+        a view of an Image is invalidated by changing the image, which may copy shared data, see Image::CloneFrom.
+*/
+class ImageView {
+public:
+    //! Construct an empty view.
+    ImageView();
+    //! View memory with rows of dimensions.width pixels, rowStride bytes apart.
+    ImageView(const unsigned char* data, const ImageDimensions& dimensions, size_t rowStride, PixelFormat pixelFormat);
+    //! View a whole image.
+    ImageView(const Image& image);
+    //! View a rectangle of an image, clipped to it.
+    ImageView(const Image& image, const PixelRectangle& rectangle);
+
+    //! View a rectangle of this view, clipped to it.
+    ImageView Subview(const PixelRectangle& rectangle) const;
+
+    //! Detect if the view has pixels.
+    bool IsInitialized() const;
+    //! Dimensions of the viewed pixels.
+    const ImageDimensions& GetDimensions() const;
+    //! Pixel format of the viewed pixels.
+    PixelFormat GetPixelFormat() const;
+    //! Distance between the starts of two consecutive rows, in bytes.
+    size_t GetRowStride() const;
+
+    //! Get color at pixel. The color is in straight alpha regardless of the pixel format.
+    PixelColor GetColor(const PixelCoordinates& coords) const;
+    //! Read-only access to the RGBA data of a row, in the pixel format of the view. Returns nullptr for rows outside of the view.
+    const unsigned char* GetRowData(uint32_t top) const;
+
+    //! Construct a new image that is the result of scaling the viewed pixels to new dimensions. Keeps the pixel format.
+    Image Scaled(const ImageDimensions& newDimensions, ResamplingFilter filter = ResamplingFilter::Box) const;
+    //! Save the viewed pixels to an RGBA file on the filesystem. RGBA files always contain straight alpha.
+    bool Save(const std::string& filepath, const ImageSaveSettings& settings = ImageSaveSettings()) const;
+
+private:
+    const unsigned char* data = nullptr;
+    ImageDimensions dimensions = IMAGE_DIMENSIONS_EMPTY;
+    size_t rowStride = 0;
+    PixelFormat pixelFormat = PixelFormat::Straight;
+};
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+namespace odr {
+//! CPU instruction sets the pixel processing kernels can be implemented with, ordered from the most basic one.
+enum class InstructionSet {
+    //! Portable C++, one pixel at a time.
+    Scalar,
+    //! x86 SSE2, 4 pixels at a time.
+    Sse2,
+    //! x86 AVX2, 8 pixels at a time.
+    Avx2,
+};
+}
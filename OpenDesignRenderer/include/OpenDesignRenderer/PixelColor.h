@@ -18,6 +18,20 @@ struct PixelColor {
 
     //! Blend color over background.
     static PixelColor Blend(const PixelColor& bgColor, const PixelColor& fgColor);
+    /*!
+        \brief Blend color over background using integer fixed-point arithmetic.
+        \note The alpha channel is identical to Blend. Color channels differ from Blend by at most 1
+            (in about 0.04% of all color and alpha combinations, verified exhaustively).
+    */
+    static PixelColor BlendFixedPoint(const PixelColor& bgColor, const PixelColor& fgColor);
+    //! Blend premultiplied color over premultiplied background.
+    static PixelColor BlendPremultiplied(const PixelColor& bgColor, const PixelColor& fgColor);
+
+    //! Convert straight alpha color to premultiplied alpha color.
+    static PixelColor Premultiplied(const PixelColor& color);
+    //! Convert premultiplied alpha color to straight alpha color.
+    static PixelColor Unpremultiplied(const PixelColor& color);
+
     //! Compute the absolute difference between two pixels.
     static PixelColor AbsoluteDiff(const PixelColor& colorA, const PixelColor& colorB);
 };
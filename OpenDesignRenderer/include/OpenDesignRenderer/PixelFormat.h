@@ -0,0 +1,11 @@
+#pragma once
+
+namespace odr {
+//! Layout of the color channels of RGBA pixels in an image buffer.
+enum class PixelFormat {
+    //! Straight (non-premultiplied) alpha. The format of RGBA files.
+    Straight,
+    //! Color channels premultiplied by alpha. Blending is a multiply-add, no division by the resulting alpha.
+    Premultiplied,
+};
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <OpenDesignRenderer/ImageDimensions.h>
+#include <OpenDesignRenderer/PixelCoordinates.h>
+
+namespace odr {
+//! Axis aligned rectangle of pixels.
+struct PixelRectangle {
+    PixelCoordinates position;
+    ImageDimensions dimensions;
+
+    //! Column right after the last column of the rectangle.
+    uint32_t Right() const;
+    //! Row right after the last row of the rectangle.
+    uint32_t Bottom() const;
+
+    //! Detect if the rectangle contains no pixels.
+    bool IsEmpty() const;
+    //! Detect if the other rectangle lies entirely inside this one.
+    bool Contains(const PixelRectangle& other) const;
+    //! Compute the intersection of two rectangles. Empty rectangle if they do not overlap.
+    PixelRectangle Intersected(const PixelRectangle& other) const;
+    //! Compute the smallest rectangle containing both rectangles. Empty rectangles are ignored.
+    PixelRectangle United(const PixelRectangle& other) const;
+    /*!
+        \brief Compute the part of the rectangle not covered by the other one.
+        \note Exact when the remaining part is a rectangle, otherwise the rectangle is returned unchanged.
+    */
+    PixelRectangle Subtracted(const PixelRectangle& other) const;
+
+    bool operator==(const PixelRectangle& other) const;
+    bool operator!=(const PixelRectangle& other) const;
+
+    //! Clip an unbounded rectangle to the <0, bounds) area.
+    static PixelRectangle Clipped(
+        const PixelCoordinatesUnbounded& position,
+        const ImageDimensions& dimensions,
+        const ImageDimensions& bounds);
+};
+//! PixelRectangle presets
+constexpr PixelRectangle PIXEL_RECTANGLE_EMPTY{ { 0, 0 }, { 0, 0 } };
+}
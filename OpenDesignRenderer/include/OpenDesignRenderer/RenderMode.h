@@ -0,0 +1,17 @@
+#pragma once
+
+namespace odr {
+//! When the RenderingEngine draw calls touch the frame buffer.
+enum class RenderMode {
+    //! Every draw call is composited into the frame buffer right away.
+    Immediate,
+    //! Draw calls are recorded into a display list, which is executed tile by tile on Render or Flush.
+    Deferred,
+    /*!
+        Draw calls are recorded like in the Deferred mode and kept after Render as the retained scene.
+        BeginFrame starts recording the scene again. On Render only the areas where the new scene draws
+        differently than the previous one are cleared and recomposited.
+    */
+    Retained,
+};
+}
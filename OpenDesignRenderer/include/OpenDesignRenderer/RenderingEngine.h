@@ -1,21 +1,81 @@
 #pragma once
 
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
 #include <OpenDesignRenderer/Image.h>
+#include <OpenDesignRenderer/PixelRectangle.h>
+#include <OpenDesignRenderer/RenderingEngineSettings.h>
+
 
+// Forward declarations
+namespace odr {
+struct BlendKernels;
+class DirtyRegion;
+class DisplayList;
+class ImageAllocator;
+class ImagePoolAllocator;
+class ImageResampler;
+class ThreadPool;
+}
 
 namespace odr {
 //! Simple 2D rendering engine.
 class RenderingEngine {
 public:
-    explicit RenderingEngine() = default;
+    explicit RenderingEngine();
+    explicit RenderingEngine(const RenderingEngineSettings& settings);
+    //! Destructor.
+    ~RenderingEngine();
+
+    //! Provide read-only access to the engine settings.
+    const RenderingEngineSettings& GetSettings() const;
+    //! The instruction set actually used for blending, depends on the settings and the CPU.
+    InstructionSet GetInstructionSet() const;
 
     //! Initialize frame buffer to the specified dimensions.
     bool InitializeFrameBuffer(const ImageDimensions& dimensions);
-    //! Render frame buffer to image.
-    bool Render(Image& image) const;
+    /*!
+        \brief Render frame buffer to image. The image is always in straight alpha. Executes the recorded draw calls first.
+        \note A straight alpha frame buffer is shared with the image, see Image::CloneFrom, it is copied when either changes.
+    */
+    bool Render(Image& image);
+    /*!
+        \brief Update the image rendered previously, only the frame buffer areas changed since then are copied.
+        \param image The result of the previous Render. Rendered whole if it has other dimensions or pixel format.
+        \param changedRegions Set to the non-overlapping areas of the image that were updated.
+    */
+    bool Render(Image& image, std::vector<PixelRectangle>& changedRegions);
+    /*!
+        \brief Move the rendered frame buffer into the image, without copying it, and start a new transparent frame.
+        \note The image is always in straight alpha. Executes the recorded draw calls first. The new frame buffer
+            reuses the data of the passed image when it has the same size, so alternating two images renders
+            frames without allocations. Like InitializeFrameBuffer, recorded draw calls are cleared, except in the
+            retained render mode: the new frame buffer starts with the retained scene, see RenderMode::Retained.
+    */
+    bool TakeFrameBuffer(Image& image);
+    /*!
+        \brief Start the next frame: resets GetLayerByteSize and drops open layers. In the retained render mode
+            starts recording the next frame of the scene, see RenderMode::Retained.
+    */
+    void BeginFrame();
+    /*!
+        \brief Execute the draw calls recorded in the deferred and retained render modes. Does nothing in the immediate mode.
+        \note Fails while layers are open, see BeginLayer, as do Render and TakeFrameBuffer.
+    */
+    bool Flush();
+    //! Number of draw commands waiting for Flush or Render. Fully clipped draw calls are not recorded, adjacent rectangles are merged.
+    size_t GetDeferredCommandCount() const;
+    //! Number of pixels not blended since InitializeFrameBuffer, because later opaque content covered them.
+    uint64_t GetCulledPixelCount() const;
 
     /*!
         \brief Draw an image to the specified position on the frame buffer.
+        \note Uses the content info of the image, see Image::GetContentInfo. Opaque unscaled images are copied instead
+            of blended. With premultiplied frame buffers transparent images are skipped and unscaled images are drawn
+            only below their non-transparent pixels.
         \param image The image to be drawn.
         \param imagePosition The position in the frame buffer where the image will be drawn.
         \param imageDimensions The dimensions of the drawn image. May cause the image to scale.
@@ -25,6 +85,19 @@ public:
         const PixelCoordinatesUnbounded& imagePosition,
         const ImageDimensions& imageDimensions);
 
+    /*!
+        \brief Draw viewed pixels, e.g. a part of an image or pixels owned by the caller, without copying them first.
+        \note Views are not cached in the scaled image cache. Deferred and retained render modes record a copy
+            of the visible part, the viewed pixels may change after the call.
+        \param image The view to be drawn.
+        \param imagePosition The position in the frame buffer where the view will be drawn.
+        \param imageDimensions The dimensions of the drawn view. May cause the view to scale.
+    */
+    bool Draw(
+        const ImageView& image,
+        const PixelCoordinatesUnbounded& imagePosition,
+        const ImageDimensions& imageDimensions);
+
     /*!
         \brief Draw a rectangle to the specified position on the frame buffer.
         \param rectanglePosition The position in the frame buffer where the rectangle will be drawn.
@@ -40,7 +113,93 @@ public:
         uint32_t innerStrokeWidth,
         const PixelColor& strokeColor);
 
+    /*!
+        \brief Start drawing into an offscreen layer, composited with its opacity by EndLayer, e.g. for group opacity.
+        \note The layer covers only its content rectangle, clipped to the frame buffer and the enclosing layer, and
+            draws outside of it are clipped. Draws inside layers use frame buffer coordinates and are immediate in all
+            render modes. A finished layer is drawn like an image. Layers nest. Their buffers are recycled by a pool,
+            see GetLayerAllocator, and are in the frame buffer pixel format.
+        \param contentPosition Position of the content rectangle in the frame buffer.
+        \param contentDimensions Dimensions of the content rectangle - the union of everything drawn into the layer.
+        \param opacity Alpha applied to the whole layer, 255 for fully opaque.
+    */
+    bool BeginLayer(
+        const PixelCoordinatesUnbounded& contentPosition,
+        const ImageDimensions& contentDimensions,
+        unsigned char opacity);
+    //! Composite the innermost layer with its opacity over the enclosing layer or the frame buffer. False if no layer is open.
+    bool EndLayer();
+    //! Number of open layers, see BeginLayer.
+    size_t GetLayerDepth() const;
+    //! Bytes of the layer buffers of the current frame, since the last BeginFrame or InitializeFrameBuffer.
+    uint64_t GetLayerByteSize() const;
+    //! The pool allocating the layer buffers, e.g. for its reuse statistics. Its kept memory can be released between frames.
+    ImagePoolAllocator& GetLayerAllocator() const;
+
+    //! Number of threads rasterizing the frame buffer.
+    uint32_t GetThreadCount() const;
+
 private:
+    //! An offscreen layer being drawn into, see BeginLayer.
+    struct Layer {
+        //! The layer buffer, uninitialized when the content rectangle is clipped away.
+        std::shared_ptr<Image> image;
+        //! The area of the frame buffer covered by the layer buffer.
+        PixelRectangle area;
+        //! See BeginLayer.
+        unsigned char opacity;
+    };
+
+    //! The image draws go to - the innermost layer, or the frame buffer.
+    Image& GetTarget();
+    //! Convert frame buffer coordinates to the coordinates of the target, see GetTarget.
+    PixelCoordinatesUnbounded ToTargetCoordinates(const PixelCoordinatesUnbounded& position) const;
+    //! Detect if draws are recorded instead of executed - in the deferred and retained render modes, outside of layers.
+    bool IsRecording() const;
+    //! Run draw for the part of the area in every tile, on the thread pool if there is one.
+    void ForEachTile(const PixelRectangle& area, const std::function<void(const PixelRectangle&)>& draw);
+    //! Find or create the image scaled to the dimensions in the frame buffer pixel format in the cache. nullptr if it is not to be cached.
+    std::shared_ptr<const Image> FindCachedScaledImage(const Image& image, const ImageDimensions& imageDimensions);
+    //! Draw or record an image already scaled and in the frame buffer pixel format.
+    bool DrawScaledImage(
+        const std::shared_ptr<const Image>& scaledImage,
+        const PixelCoordinatesUnbounded& imagePosition,
+        const PixelRectangle& area);
+    /*!
+        \brief Draw or record the area of an image or view scaled by the resampler, not cached. Opaque unscaled images are copied.
+        \param sourceContentId Content identifier of the source image, zero for views. The retained scene reuses
+            the image recorded from an unchanged source, see DisplayList::FindRecordedImage.
+    */
+    bool DrawResampled(
+        const ImageResampler& resampler,
+        const PixelCoordinatesUnbounded& imagePosition,
+        const PixelRectangle& area,
+        bool isImageOpaque,
+        uint64_t sourceContentId);
+    //! Execute the part of the display list inside the area.
+    bool ExecuteDisplayList(const PixelRectangle& area);
+    //! Recomposite the areas where the recorded scene differs from the retained one.
+    bool FlushRetained();
+
+    RenderingEngineSettings settings;
+    //! Blending kernels selected for the settings and the CPU.
+    const BlendKernels* blendKernels = nullptr;
+    //! Draw calls recorded in the deferred render mode.
+    std::unique_ptr<DisplayList> displayList;
+    //! The scene the frame buffer shows, in the retained render mode.
+    std::unique_ptr<DisplayList> retainedDisplayList;
+    //! Frame buffer areas changed since the last Render.
+    std::unique_ptr<DirtyRegion> unrenderedRegion;
+    //! See GetCulledPixelCount.
+    std::atomic<uint64_t> culledPixelCount;
+    //! Threads for tiled rasterization, nullptr when rendering on the calling thread only.
+    std::unique_ptr<ThreadPool> threadPool;
     Image frameBuffer;
+    //! Open layers, the innermost one last.
+    std::vector<Layer> layers;
+    //! Source of the layer buffers, see GetLayerAllocator.
+    std::shared_ptr<ImagePoolAllocator> layerAllocator;
+    //! See GetLayerByteSize.
+    uint64_t layerByteSize;
 };
 }
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <memory>
+
+#include <OpenDesignRenderer/BlendMode.h>
+#include <OpenDesignRenderer/InstructionSet.h>
+#include <OpenDesignRenderer/PixelFormat.h>
+#include <OpenDesignRenderer/RenderMode.h>
+#include <OpenDesignRenderer/ResamplingFilter.h>
+#include <OpenDesignRenderer/ScaledImageCache.h>
+
+namespace odr {
+//! RenderingEngine configuration, fixed at engine construction.
+struct RenderingEngineSettings {
+    //! The most advanced instruction set the engine may use. Lowered automatically if the CPU does not support it.
+    InstructionSet maxInstructionSet = InstructionSet::Avx2;
+    //! Blending arithmetic for straight alpha frame buffers. Both have scalar, SSE2 and AVX2 kernels, see maxInstructionSet.
+    BlendMode blendMode = BlendMode::Float;
+    //! Pixel format of the frame buffer. Drawn images are converted to it, rendered images are converted back to straight alpha.
+    PixelFormat frameBufferPixelFormat = PixelFormat::Straight;
+    //! Number of threads rasterizing the frame buffer. 1 renders on the calling thread, 0 uses all hardware threads.
+    uint32_t threadCount = 1;
+    //! Width and height of the frame buffer tiles rasterized independently by the threads.
+    uint32_t tileSize = 64;
+    //! Composite draw calls right away, or record them and composite them all on Render.
+    RenderMode renderMode = RenderMode::Immediate;
+    //! Skip recorded draw calls, or their parts, hidden below later fully opaque content. Deferred and retained render modes only.
+    bool isOcclusionCullingEnabled = true;
+    //! Filter used to scale the drawn images. Box keeps the results of the original renderer.
+    ResamplingFilter resamplingFilter = ResamplingFilter::Box;
+    //! Cache of the scaled images drawn, may be shared with other engines. Images are scaled on every Draw if nullptr.
+    std::shared_ptr<ScaledImageCache> scaledImageCache;
+};
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+namespace odr {
+//! Filter used to compute the pixels of a scaled image.
+enum class ResamplingFilter {
+    //! Average of a box of source pixels. The original Image::Scaled filter, blocky when upscaling.
+    Box,
+    /*!
+        Exact average of the source area covered by each scaled pixel, without gaps or overlaps at fractional ratios.
+        Computed from summed-area rows with 64-bit accumulators, in constant time per pixel regardless of the ratio.
+        The choice for large downscales.
+    */
+    SummedAreaBox,
+    //! Separable linear interpolation, widened to a tent when downscaling.
+    Bilinear,
+    //! Separable Catmull-Rom cubic. Sharper than Bilinear, may slightly overshoot at edges.
+    Bicubic,
+    //! Separable Lanczos with 3 lobes. The sharpest, most expensive.
+    Lanczos3,
+};
+}
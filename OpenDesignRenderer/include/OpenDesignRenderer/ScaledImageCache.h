@@ -0,0 +1,112 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include <OpenDesignRenderer/ImageDimensions.h>
+#include <OpenDesignRenderer/PixelFormat.h>
+#include <OpenDesignRenderer/ResamplingFilter.h>
+
+
+// Forward declarations
+namespace odr {
+class Image;
+}
+
+namespace odr {
+/*!
+    \brief Bounded least-recently-used cache of scaled images, may be shared by several rendering engines.
+    \note Entries are keyed by the source image content identifier, the scaled dimensions, the pixel format and the filter,
+        so changing the source image never returns stale results. Entries of old content are evicted eventually,
+        Invalidate releases them right away. All methods are thread-safe.
+*/
+class ScaledImageCache {
+public:
+    //! Construct an empty cache holding at most byteBudget bytes of image data.
+    explicit ScaledImageCache(size_t byteBudget);
+
+    ScaledImageCache(const ScaledImageCache&) = delete;
+    ScaledImageCache& operator=(const ScaledImageCache&) = delete;
+
+    /*!
+        \brief Find the source image scaled to the dimensions with the filter and converted to the pixel format.
+        \return The cached image, or nullptr on a miss. The cached image is never modified.
+    */
+    std::shared_ptr<const Image> Find(
+        const Image& source,
+        const ImageDimensions& dimensions,
+        PixelFormat pixelFormat,
+        ResamplingFilter filter = ResamplingFilter::Box);
+    /*!
+        \brief Find the scaled image, compute and store it on a miss.
+        \return The scaled image, or nullptr if it could not be computed or does not fit the budget.
+    */
+    std::shared_ptr<const Image> FindOrCreate(
+        const Image& source,
+        const ImageDimensions& dimensions,
+        PixelFormat pixelFormat,
+        ResamplingFilter filter = ResamplingFilter::Box);
+    //! Store a scaled image of the source, evicting the least recently used entries. Ignored if larger than the budget.
+    void Insert(
+        const Image& source,
+        const ImageDimensions& dimensions,
+        PixelFormat pixelFormat,
+        ResamplingFilter filter,
+        const std::shared_ptr<const Image>& scaledImage);
+
+    //! Detect if an image of the dimensions fits the budget at all.
+    bool IsCacheable(const ImageDimensions& dimensions) const;
+
+    //! Release all scaled versions of the current content of the source image.
+    void Invalidate(const Image& source);
+    //! Release all entries. Keeps the hit and miss counters.
+    void Clear();
+
+    //! Maximum number of bytes of image data held.
+    size_t GetByteBudget() const;
+    //! Number of bytes of image data held.
+    size_t GetByteSize() const;
+    //! Number of cached images.
+    size_t GetEntryCount() const;
+    //! Number of lookups that found a cached image.
+    uint64_t GetHitCount() const;
+    //! Number of lookups that did not find a cached image.
+    uint64_t GetMissCount() const;
+
+private:
+    struct Key {
+        uint64_t sourceContentId;
+        ImageDimensions dimensions;
+        PixelFormat pixelFormat;
+        ResamplingFilter filter;
+
+        bool operator==(const Key& other) const;
+    };
+    struct KeyHash {
+        size_t operator()(const Key& key) const;
+    };
+    struct Entry {
+        Key key;
+        std::shared_ptr<const Image> image;
+        size_t byteSize;
+    };
+
+    //! Drop the least recently used entries until byteSize fits the budget. Expects the mutex to be locked.
+    void EvictToBudget();
+
+    const size_t byteBudget;
+
+    mutable std::mutex mutex;
+    //! Most recently used first.
+    std::list<Entry> entries;
+    std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> entriesByKey;
+    size_t byteSize = 0;
+    uint64_t hitCount = 0;
+    uint64_t missCount = 0;
+};
+}
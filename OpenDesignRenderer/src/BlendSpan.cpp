@@ -0,0 +1,137 @@
+#include "BlendSpan.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <OpenDesignRenderer/PixelColor.h>
+
+#include "CpuFeatures.h"
+
+namespace {
+    //! Read an RGBA pixel from a buffer.
+    inline odr::PixelColor LoadPixel(const unsigned char* pixel) {
+        return odr::PixelColor{ pixel[0], pixel[1], pixel[2], pixel[3] };
+    }
+    //! Write an RGBA pixel to a buffer.
+    inline void StorePixel(unsigned char* pixel, const odr::PixelColor& color) {
+        pixel[0] = color.r;
+        pixel[1] = color.g;
+        pixel[2] = color.b;
+        pixel[3] = color.a;
+    }
+
+    using odr::BlendMode;
+    using odr::InstructionSet;
+    using odr::PixelFormat;
+
+    const odr::BlendKernels BLEND_KERNELS_SCALAR{
+        PixelFormat::Straight, BlendMode::Float, InstructionSet::Scalar,
+        odr::BlendSpanScalar, odr::BlendColorSpanScalar };
+    const odr::BlendKernels BLEND_KERNELS_FIXED_POINT{
+        PixelFormat::Straight, BlendMode::FixedPoint, InstructionSet::Scalar,
+        odr::BlendSpanFixedPoint, odr::BlendColorSpanFixedPoint };
+    const odr::BlendKernels BLEND_KERNELS_PREMULTIPLIED_SCALAR{
+        PixelFormat::Premultiplied, BlendMode::FixedPoint, InstructionSet::Scalar,
+        odr::BlendSpanPremultipliedScalar, odr::BlendColorSpanPremultipliedScalar };
+#if defined(ODR_X86_SIMD)
+    const odr::BlendKernels BLEND_KERNELS_SSE2{
+        PixelFormat::Straight, BlendMode::Float, InstructionSet::Sse2,
+        odr::BlendSpanSse2, odr::BlendColorSpanSse2 };
+    const odr::BlendKernels BLEND_KERNELS_AVX2{
+        PixelFormat::Straight, BlendMode::Float, InstructionSet::Avx2,
+        odr::BlendSpanAvx2, odr::BlendColorSpanAvx2 };
+    const odr::BlendKernels BLEND_KERNELS_FIXED_POINT_SSE2{
+        PixelFormat::Straight, BlendMode::FixedPoint, InstructionSet::Sse2,
+        odr::BlendSpanFixedPointSse2, odr::BlendColorSpanFixedPointSse2 };
+    const odr::BlendKernels BLEND_KERNELS_FIXED_POINT_AVX2{
+        PixelFormat::Straight, BlendMode::FixedPoint, InstructionSet::Avx2,
+        odr::BlendSpanFixedPointAvx2, odr::BlendColorSpanFixedPointAvx2 };
+    const odr::BlendKernels BLEND_KERNELS_PREMULTIPLIED_SSE2{
+        PixelFormat::Premultiplied, BlendMode::FixedPoint, InstructionSet::Sse2,
+        odr::BlendSpanPremultipliedSse2, odr::BlendColorSpanPremultipliedSse2 };
+    const odr::BlendKernels BLEND_KERNELS_PREMULTIPLIED_AVX2{
+        PixelFormat::Premultiplied, BlendMode::FixedPoint, InstructionSet::Avx2,
+        odr::BlendSpanPremultipliedAvx2, odr::BlendColorSpanPremultipliedAvx2 };
+#endif
+}
+
+
+/*static*/ const odr::BlendKernels& odr::BlendKernels::Select(
+    PixelFormat pixelFormat,
+    BlendMode blendMode,
+    InstructionSet maxInstructionSet) {
+    const bool isPremultiplied = pixelFormat == PixelFormat::Premultiplied;
+    const bool isFixedPoint = blendMode == BlendMode::FixedPoint;
+
+#if defined(ODR_X86_SIMD)
+    if (maxInstructionSet >= InstructionSet::Avx2 && IsAvx2Supported()) {
+        return isPremultiplied ? BLEND_KERNELS_PREMULTIPLIED_AVX2
+            : isFixedPoint ? BLEND_KERNELS_FIXED_POINT_AVX2 : BLEND_KERNELS_AVX2;
+    }
+    if (maxInstructionSet >= InstructionSet::Sse2) {
+        return isPremultiplied ? BLEND_KERNELS_PREMULTIPLIED_SSE2
+            : isFixedPoint ? BLEND_KERNELS_FIXED_POINT_SSE2 : BLEND_KERNELS_SSE2;
+    }
+#else
+    (void)maxInstructionSet;
+#endif
+    return isPremultiplied ? BLEND_KERNELS_PREMULTIPLIED_SCALAR
+        : isFixedPoint ? BLEND_KERNELS_FIXED_POINT : BLEND_KERNELS_SCALAR;
+}
+
+void odr::FillColorSpan(unsigned char* dst, const PixelColor& color, size_t pixelCount) {
+    if (pixelCount == 0) {
+        return;
+    }
+
+    // A color of identical bytes (e.g. transparent, opaque white) is a plain memset
+    if (color.r == color.a && color.g == color.a && color.b == color.a) {
+        std::memset(dst, color.a, pixelCount * 4);
+        return;
+    }
+
+    // Otherwise the filled part is copied over the rest, doubling each time
+    std::memcpy(dst, &color, 4);
+    size_t filledPixelCount = 1;
+    while (filledPixelCount < pixelCount) {
+        const size_t copiedPixelCount = std::min(filledPixelCount, pixelCount - filledPixelCount);
+        std::memcpy(dst + filledPixelCount * 4, dst, copiedPixelCount * 4);
+        filledPixelCount += copiedPixelCount;
+    }
+}
+
+void odr::BlendSpanScalar(unsigned char* dst, const unsigned char* src, uint32_t pixelCount) {
+    for (uint32_t i = 0; i < pixelCount; i++, dst += 4, src += 4) {
+        StorePixel(dst, PixelColor::Blend(LoadPixel(dst), LoadPixel(src)));
+    }
+}
+
+void odr::BlendColorSpanScalar(unsigned char* dst, const PixelColor& color, uint32_t pixelCount) {
+    for (uint32_t i = 0; i < pixelCount; i++, dst += 4) {
+        StorePixel(dst, PixelColor::Blend(LoadPixel(dst), color));
+    }
+}
+
+void odr::BlendSpanFixedPoint(unsigned char* dst, const unsigned char* src, uint32_t pixelCount) {
+    for (uint32_t i = 0; i < pixelCount; i++, dst += 4, src += 4) {
+        StorePixel(dst, PixelColor::BlendFixedPoint(LoadPixel(dst), LoadPixel(src)));
+    }
+}
+
+void odr::BlendColorSpanFixedPoint(unsigned char* dst, const PixelColor& color, uint32_t pixelCount) {
+    for (uint32_t i = 0; i < pixelCount; i++, dst += 4) {
+        StorePixel(dst, PixelColor::BlendFixedPoint(LoadPixel(dst), color));
+    }
+}
+
+void odr::BlendSpanPremultipliedScalar(unsigned char* dst, const unsigned char* src, uint32_t pixelCount) {
+    for (uint32_t i = 0; i < pixelCount; i++, dst += 4, src += 4) {
+        StorePixel(dst, PixelColor::BlendPremultiplied(LoadPixel(dst), LoadPixel(src)));
+    }
+}
+
+void odr::BlendColorSpanPremultipliedScalar(unsigned char* dst, const PixelColor& color, uint32_t pixelCount) {
+    for (uint32_t i = 0; i < pixelCount; i++, dst += 4) {
+        StorePixel(dst, PixelColor::BlendPremultiplied(LoadPixel(dst), color));
+    }
+}
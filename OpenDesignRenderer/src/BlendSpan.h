@@ -0,0 +1,89 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <OpenDesignRenderer/BlendMode.h>
+#include <OpenDesignRenderer/InstructionSet.h>
+#include <OpenDesignRenderer/PixelFormat.h>
+
+// Forward declarations
+namespace odr {
+struct PixelColor;
+}
+
+namespace odr {
+/*!
+    \brief Blend a span of RGBA source pixels over a span of RGBA destination pixels, in place.
+    \param dst Destination pixels, overwritten with the blended result.
+    \param src Source (foreground) pixels.
+    \param pixelCount Number of pixels in both spans.
+*/
+using BlendSpanFunction = void (*)(unsigned char* dst, const unsigned char* src, uint32_t pixelCount);
+
+/*!
+    \brief Blend a constant color over a span of RGBA destination pixels, in place.
+    \param dst Destination pixels, overwritten with the blended result.
+    \param color Source (foreground) color.
+    \param pixelCount Number of pixels in the span.
+*/
+using BlendColorSpanFunction = void (*)(unsigned char* dst, const PixelColor& color, uint32_t pixelCount);
+
+//! Span blending kernels for one pixel format, implemented with one blend mode and instruction set.
+//! Kernels of the same pixel format and blend mode produce identical results.
+struct BlendKernels {
+    PixelFormat pixelFormat;
+    BlendMode blendMode;
+    InstructionSet instructionSet;
+    BlendSpanFunction blendSpan;
+    BlendColorSpanFunction blendColorSpan;
+
+    /*!
+        \brief Select the fastest kernels supported by the CPU, up to the specified instruction set.
+        \note The blend mode only applies to straight alpha, premultiplied alpha is always blended in integers.
+    */
+    static const BlendKernels& Select(PixelFormat pixelFormat, BlendMode blendMode, InstructionSet maxInstructionSet);
+};
+
+/*!
+    \brief Set a span of RGBA pixels to a constant color, already in the pixel format of the span.
+    \note The result of blending an opaque color with any kernel. Runs at memory bandwidth.
+*/
+void FillColorSpan(unsigned char* dst, const PixelColor& color, size_t pixelCount);
+
+//! Portable kernels, PixelColor::Blend for each pixel.
+void BlendSpanScalar(unsigned char* dst, const unsigned char* src, uint32_t pixelCount);
+void BlendColorSpanScalar(unsigned char* dst, const PixelColor& color, uint32_t pixelCount);
+
+//! Portable fixed-point kernels, PixelColor::BlendFixedPoint for each pixel.
+void BlendSpanFixedPoint(unsigned char* dst, const unsigned char* src, uint32_t pixelCount);
+void BlendColorSpanFixedPoint(unsigned char* dst, const PixelColor& color, uint32_t pixelCount);
+
+/*!
+    \brief Reciprocals of all blending weight sums in 0.32 fixed point, round(2^32 / weight), see PixelColor::BlendFixedPoint.
+    \note Indexed by weight sums up to 255 * 255. Only sums of at least 255 are used, their reciprocals fit in 24 bits.
+*/
+const uint32_t* BlendWeightReciprocals();
+
+//! Portable premultiplied alpha kernels, PixelColor::BlendPremultiplied for each pixel.
+void BlendSpanPremultipliedScalar(unsigned char* dst, const unsigned char* src, uint32_t pixelCount);
+void BlendColorSpanPremultipliedScalar(unsigned char* dst, const PixelColor& color, uint32_t pixelCount);
+
+#if defined(ODR_X86_SIMD)
+//! SSE2 kernels, 4 pixels per iteration.
+void BlendSpanSse2(unsigned char* dst, const unsigned char* src, uint32_t pixelCount);
+void BlendColorSpanSse2(unsigned char* dst, const PixelColor& color, uint32_t pixelCount);
+void BlendSpanPremultipliedSse2(unsigned char* dst, const unsigned char* src, uint32_t pixelCount);
+void BlendColorSpanPremultipliedSse2(unsigned char* dst, const PixelColor& color, uint32_t pixelCount);
+void BlendSpanFixedPointSse2(unsigned char* dst, const unsigned char* src, uint32_t pixelCount);
+void BlendColorSpanFixedPointSse2(unsigned char* dst, const PixelColor& color, uint32_t pixelCount);
+
+//! AVX2 kernels, 8 pixels per iteration. Only call them if IsAvx2Supported().
+void BlendSpanAvx2(unsigned char* dst, const unsigned char* src, uint32_t pixelCount);
+void BlendColorSpanAvx2(unsigned char* dst, const PixelColor& color, uint32_t pixelCount);
+void BlendSpanPremultipliedAvx2(unsigned char* dst, const unsigned char* src, uint32_t pixelCount);
+void BlendColorSpanPremultipliedAvx2(unsigned char* dst, const PixelColor& color, uint32_t pixelCount);
+void BlendSpanFixedPointAvx2(unsigned char* dst, const unsigned char* src, uint32_t pixelCount);
+void BlendColorSpanFixedPointAvx2(unsigned char* dst, const PixelColor& color, uint32_t pixelCount);
+#endif
+}
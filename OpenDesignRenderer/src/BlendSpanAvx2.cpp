@@ -0,0 +1,274 @@
+#include "BlendSpan.h"
+
+#if defined(ODR_X86_SIMD)
+
+#include <immintrin.h>
+
+#include <OpenDesignRenderer/PixelColor.h>
+
+// This file is compiled with AVX2 enabled, see CMakeLists.txt.
+// The float arithmetic mirrors PixelColor::Blend operation by operation, so the results are bit-identical.
+// The same holds for the integer arithmetic and PixelColor::BlendFixedPoint.
+namespace {
+    //! Convert channels in the range <0, 255> to <0.0, 1.0>.
+    inline __m256 To01(__m256i value) {
+        return _mm256_div_ps(_mm256_cvtepi32_ps(value), _mm256_set1_ps(255.0f));
+    }
+    //! Convert 4 channels in <0.0, 1.0> to <0, 255> in double precision.
+    inline __m128i To255Half(__m128 value) {
+        const __m256d scaled = _mm256_mul_pd(_mm256_cvtps_pd(value), _mm256_set1_pd(255.0));
+        return _mm256_cvttpd_epi32(_mm256_add_pd(scaled, _mm256_set1_pd(0.5)));
+    }
+    //! Convert channels in <0.0, 1.0> to <0, 255>. Rounds half away from zero like std::round.
+    inline __m256i To255(__m256 value) {
+        value = _mm256_min_ps(_mm256_max_ps(value, _mm256_setzero_ps()), _mm256_set1_ps(1.0f));
+
+        // value * 255 is exact in double precision
+        const __m128i lo = To255Half(_mm256_castps256_ps128(value));
+        const __m128i hi = To255Half(_mm256_extractf128_ps(value, 1));
+
+        return _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+    }
+    //! Pick a where the mask is set, b elsewhere.
+    inline __m256i Select(__m256i mask, __m256i a, __m256i b) {
+        return _mm256_blendv_epi8(b, a, mask);
+    }
+    //! Extract a channel of 8 RGBA pixels into 32-bit lanes.
+    inline __m256i Channel(__m256i pixels, int shift) {
+        return _mm256_and_si256(_mm256_srli_epi32(pixels, shift), _mm256_set1_epi32(0xFF));
+    }
+    //! Pack 32-bit channel lanes back to RGBA pixels.
+    inline __m256i Pack(__m256i r, __m256i g, __m256i b, __m256i a) {
+        return _mm256_or_si256(
+            _mm256_or_si256(r, _mm256_slli_epi32(g, 8)),
+            _mm256_or_si256(_mm256_slli_epi32(b, 16), _mm256_slli_epi32(a, 24)));
+    }
+
+    //! Blend 8 foreground pixels over 8 background pixels.
+    inline __m256i Blend8(__m256i bg, __m256i fg) {
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i bgA = _mm256_srli_epi32(bg, 24);
+        const __m256i fgA = _mm256_srli_epi32(fg, 24);
+
+        const __m256i fgIsTransparent = _mm256_cmpeq_epi32(fgA, zero);
+        const __m256i bgIsTransparent = _mm256_cmpeq_epi32(bgA, zero);
+        const __m256i fgWins = _mm256_or_si256(_mm256_cmpeq_epi32(fgA, _mm256_set1_epi32(0xFF)), bgIsTransparent);
+        const __m256i bothTransparent = _mm256_and_si256(fgIsTransparent, bgIsTransparent);
+
+        // Common case of opaque or transparent foreground pixels, no arithmetic needed
+        const __m256i isTrivial = _mm256_or_si256(fgWins, fgIsTransparent);
+        if (_mm256_movemask_epi8(isTrivial) == -1 && _mm256_testz_si256(bothTransparent, bothTransparent)) {
+            return Select(fgIsTransparent, bg, fg);
+        }
+
+        const __m256 bgr01 = To01(Channel(bg, 0));
+        const __m256 bgg01 = To01(Channel(bg, 8));
+        const __m256 bgb01 = To01(Channel(bg, 16));
+        const __m256 fgr01 = To01(Channel(fg, 0));
+        const __m256 fgg01 = To01(Channel(fg, 8));
+        const __m256 fgb01 = To01(Channel(fg, 16));
+
+        const __m256 bga01 = To01(bgA);
+        const __m256 fga01 = To01(fgA);
+        const __m256 fga01inv = _mm256_sub_ps(_mm256_set1_ps(1.0f), fga01);
+
+        const __m256 resa01 = _mm256_add_ps(fga01, _mm256_mul_ps(fga01inv, bga01));
+        const __m256 bga01xfga01inv = _mm256_mul_ps(bga01, fga01inv);
+
+        const __m256i blended = Pack(
+            To255(_mm256_div_ps(_mm256_add_ps(_mm256_mul_ps(fgr01, fga01), _mm256_mul_ps(bgr01, bga01xfga01inv)), resa01)),
+            To255(_mm256_div_ps(_mm256_add_ps(_mm256_mul_ps(fgg01, fga01), _mm256_mul_ps(bgg01, bga01xfga01inv)), resa01)),
+            To255(_mm256_div_ps(_mm256_add_ps(_mm256_mul_ps(fgb01, fga01), _mm256_mul_ps(bgb01, bga01xfga01inv)), resa01)),
+            To255(resa01));
+
+        // Both pixels transparent - average the colors
+        const __m256 half = _mm256_set1_ps(0.5f);
+        const __m256i averaged = Pack(
+            To255(_mm256_mul_ps(_mm256_add_ps(bgr01, fgr01), half)),
+            To255(_mm256_mul_ps(_mm256_add_ps(bgg01, fgg01), half)),
+            To255(_mm256_mul_ps(_mm256_add_ps(bgb01, fgb01), half)),
+            zero);
+
+        __m256i result = Select(fgWins, fg, blended);
+        result = Select(fgIsTransparent, bg, result);
+        return Select(bothTransparent, averaged, result);
+    }
+
+    //! Compute round(value / 255) in 16-bit lanes, exact for value in <0, 255*255>.
+    inline __m256i Div255(__m256i value) {
+        value = _mm256_add_epi16(value, _mm256_set1_epi16(128));
+        return _mm256_srli_epi16(_mm256_add_epi16(value, _mm256_srli_epi16(value, 8)), 8);
+    }
+    //! Scale background pixels in 16-bit lanes by 255 - alpha of the matching foreground pixels.
+    inline __m256i ScaleByInverseAlpha(__m256i bg16, __m256i fgInv16) {
+        const __m256i alphaInv = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(fgInv16, 0xFF), 0xFF);
+        return Div255(_mm256_mullo_epi16(bg16, alphaInv));
+    }
+
+    //! Blend 8 premultiplied foreground pixels over 8 premultiplied background pixels.
+    inline __m256i BlendPremultiplied8(__m256i bg, __m256i fg) {
+        const __m256i alphaMask = _mm256_set1_epi32(static_cast<int>(0xFF000000u));
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(_mm256_and_si256(fg, alphaMask), alphaMask)) == -1) {
+            return fg;
+        }
+
+        // 255 - channel for every byte. Unpacking and packing stays within 128-bit lanes, the order is kept.
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i fgInv = _mm256_xor_si256(fg, _mm256_set1_epi32(-1));
+
+        const __m256i bgLo = ScaleByInverseAlpha(_mm256_unpacklo_epi8(bg, zero), _mm256_unpacklo_epi8(fgInv, zero));
+        const __m256i bgHi = ScaleByInverseAlpha(_mm256_unpackhi_epi8(bg, zero), _mm256_unpackhi_epi8(fgInv, zero));
+
+        return _mm256_adds_epu8(fg, _mm256_packus_epi16(bgLo, bgHi));
+    }
+
+    //! Compute (value * reciprocal + 2^31) >> 32 in 32-bit lanes, the products must fit in 64 bits.
+    inline __m256i MulReciprocal(__m256i value, __m256i reciprocal) {
+        const __m256i half = _mm256_set1_epi64x(int64_t(1) << 31);
+        const __m256i even = _mm256_add_epi64(_mm256_mul_epu32(value, reciprocal), half);
+        const __m256i odd = _mm256_add_epi64(_mm256_mul_epu32(_mm256_srli_epi64(value, 32), _mm256_srli_epi64(reciprocal, 32)), half);
+        return _mm256_blend_epi32(_mm256_srli_epi64(even, 32), odd, 0xAA);
+    }
+
+    //! Blend 8 foreground pixels over 8 background pixels in fixed point.
+    inline __m256i BlendFixedPoint8(__m256i bg, __m256i fg) {
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i bgA = _mm256_srli_epi32(bg, 24);
+        const __m256i fgA = _mm256_srli_epi32(fg, 24);
+
+        const __m256i fgIsTransparent = _mm256_cmpeq_epi32(fgA, zero);
+        const __m256i bgIsTransparent = _mm256_cmpeq_epi32(bgA, zero);
+        const __m256i fgWins = _mm256_or_si256(_mm256_cmpeq_epi32(fgA, _mm256_set1_epi32(0xFF)), bgIsTransparent);
+        const __m256i bothTransparent = _mm256_and_si256(fgIsTransparent, bgIsTransparent);
+
+        // Both pixels transparent - average the colors, rounding up. The alpha average is 0.
+        const __m256i averaged = _mm256_avg_epu8(bg, fg);
+
+        const __m256i isTrivial = _mm256_or_si256(fgWins, fgIsTransparent);
+        if (_mm256_movemask_epi8(isTrivial) == -1) {
+            return Select(bothTransparent, averaged, Select(fgIsTransparent, bg, fg));
+        }
+
+        const __m256i channelMask = _mm256_set1_epi32(0xFF);
+        const __m256i fgWeight = _mm256_mullo_epi32(fgA, channelMask);
+        const __m256i bgWeight = _mm256_mullo_epi32(bgA, _mm256_sub_epi32(channelMask, fgA));
+        const __m256i weightSum = _mm256_add_epi32(fgWeight, bgWeight);
+        const __m256i reciprocal = _mm256_i32gather_epi32(reinterpret_cast<const int*>(odr::BlendWeightReciprocals()), weightSum, 4);
+
+        const auto blendChannel = [&](int shift) {
+            const __m256i weighted = _mm256_add_epi32(
+                _mm256_mullo_epi32(Channel(fg, shift), fgWeight), _mm256_mullo_epi32(Channel(bg, shift), bgWeight));
+            return _mm256_and_si256(MulReciprocal(weighted, reciprocal), channelMask);
+        };
+
+        // (weightSum + 127) / 255 as a multiplication by 2^23 / 255, exact for sums up to 255 * 255
+        const __m256i alpha = _mm256_srli_epi32(
+            _mm256_mullo_epi32(_mm256_add_epi32(weightSum, _mm256_set1_epi32(127)), _mm256_set1_epi32(0x8081)), 23);
+        const __m256i blended = Pack(blendChannel(0), blendChannel(8), blendChannel(16), alpha);
+
+        __m256i result = Select(fgWins, fg, blended);
+        result = Select(fgIsTransparent, bg, result);
+        return Select(bothTransparent, averaged, result);
+    }
+
+    //! Pack a color to a 32-bit RGBA lane.
+    inline int PackColor(const odr::PixelColor& color) {
+        const uint32_t packed = color.r | (color.g << 8) | (color.b << 16) | (static_cast<uint32_t>(color.a) << 24);
+        return static_cast<int>(packed);
+    }
+}
+
+
+void odr::BlendSpanAvx2(unsigned char* dst, const unsigned char* src, uint32_t pixelCount) {
+    uint32_t i = 0;
+
+    for (; i + 8 <= pixelCount; i += 8) {
+        __m256i* dstPixels = reinterpret_cast<__m256i*>(dst + i * 4);
+        const __m256i bg = _mm256_loadu_si256(dstPixels);
+        const __m256i fg = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 4));
+
+        _mm256_storeu_si256(dstPixels, Blend8(bg, fg));
+    }
+
+    BlendSpanSse2(dst + i * 4, src + i * 4, pixelCount - i);
+}
+
+void odr::BlendColorSpanAvx2(unsigned char* dst, const PixelColor& color, uint32_t pixelCount) {
+    const __m256i fg = _mm256_set1_epi32(PackColor(color));
+    uint32_t i = 0;
+
+    if (color.a == 0xFF) {
+        for (; i + 8 <= pixelCount; i += 8) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4), fg);
+        }
+    }
+    else {
+        for (; i + 8 <= pixelCount; i += 8) {
+            __m256i* dstPixels = reinterpret_cast<__m256i*>(dst + i * 4);
+            _mm256_storeu_si256(dstPixels, Blend8(_mm256_loadu_si256(dstPixels), fg));
+        }
+    }
+
+    BlendColorSpanSse2(dst + i * 4, color, pixelCount - i);
+}
+
+void odr::BlendSpanFixedPointAvx2(unsigned char* dst, const unsigned char* src, uint32_t pixelCount) {
+    uint32_t i = 0;
+
+    for (; i + 8 <= pixelCount; i += 8) {
+        __m256i* dstPixels = reinterpret_cast<__m256i*>(dst + i * 4);
+        const __m256i bg = _mm256_loadu_si256(dstPixels);
+        const __m256i fg = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 4));
+
+        _mm256_storeu_si256(dstPixels, BlendFixedPoint8(bg, fg));
+    }
+
+    BlendSpanFixedPointSse2(dst + i * 4, src + i * 4, pixelCount - i);
+}
+
+void odr::BlendColorSpanFixedPointAvx2(unsigned char* dst, const PixelColor& color, uint32_t pixelCount) {
+    const __m256i fg = _mm256_set1_epi32(PackColor(color));
+    uint32_t i = 0;
+
+    if (color.a == 0xFF) {
+        for (; i + 8 <= pixelCount; i += 8) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4), fg);
+        }
+    }
+    else {
+        for (; i + 8 <= pixelCount; i += 8) {
+            __m256i* dstPixels = reinterpret_cast<__m256i*>(dst + i * 4);
+            _mm256_storeu_si256(dstPixels, BlendFixedPoint8(_mm256_loadu_si256(dstPixels), fg));
+        }
+    }
+
+    BlendColorSpanFixedPointSse2(dst + i * 4, color, pixelCount - i);
+}
+
+void odr::BlendSpanPremultipliedAvx2(unsigned char* dst, const unsigned char* src, uint32_t pixelCount) {
+    uint32_t i = 0;
+
+    for (; i + 8 <= pixelCount; i += 8) {
+        __m256i* dstPixels = reinterpret_cast<__m256i*>(dst + i * 4);
+        const __m256i bg = _mm256_loadu_si256(dstPixels);
+        const __m256i fg = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 4));
+
+        _mm256_storeu_si256(dstPixels, BlendPremultiplied8(bg, fg));
+    }
+
+    BlendSpanPremultipliedSse2(dst + i * 4, src + i * 4, pixelCount - i);
+}
+
+void odr::BlendColorSpanPremultipliedAvx2(unsigned char* dst, const PixelColor& color, uint32_t pixelCount) {
+    const __m256i fg = _mm256_set1_epi32(PackColor(color));
+    uint32_t i = 0;
+
+    for (; i + 8 <= pixelCount; i += 8) {
+        __m256i* dstPixels = reinterpret_cast<__m256i*>(dst + i * 4);
+        _mm256_storeu_si256(dstPixels, BlendPremultiplied8(_mm256_loadu_si256(dstPixels), fg));
+    }
+
+    BlendColorSpanPremultipliedSse2(dst + i * 4, color, pixelCount - i);
+}
+
+#endif
@@ -0,0 +1,279 @@
+#include "BlendSpan.h"
+
+#if defined(ODR_X86_SIMD)
+
+#include <emmintrin.h>
+
+#include <OpenDesignRenderer/PixelColor.h>
+
+// The float arithmetic mirrors PixelColor::Blend operation by operation, so the results are bit-identical.
+// The same holds for the integer arithmetic and PixelColor::BlendFixedPoint.
+namespace {
+    //! Convert channels in the range <0, 255> to <0.0, 1.0>.
+    inline __m128 To01(__m128i value) {
+        return _mm_div_ps(_mm_cvtepi32_ps(value), _mm_set1_ps(255.0f));
+    }
+    //! Convert channels in <0.0, 1.0> to <0, 255>. Rounds half away from zero like std::round.
+    inline __m128i To255(__m128 value) {
+        value = _mm_min_ps(_mm_max_ps(value, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+
+        // value * 255 is exact in double precision
+        const __m128d scale = _mm_set1_pd(255.0);
+        const __m128d half = _mm_set1_pd(0.5);
+        const __m128d lo = _mm_add_pd(_mm_mul_pd(_mm_cvtps_pd(value), scale), half);
+        const __m128d hi = _mm_add_pd(_mm_mul_pd(_mm_cvtps_pd(_mm_movehl_ps(value, value)), scale), half);
+
+        return _mm_unpacklo_epi64(_mm_cvttpd_epi32(lo), _mm_cvttpd_epi32(hi));
+    }
+    //! Pick a where the mask is set, b elsewhere.
+    inline __m128i Select(__m128i mask, __m128i a, __m128i b) {
+        return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+    }
+    //! Extract a channel of 4 RGBA pixels into 32-bit lanes.
+    inline __m128i Channel(__m128i pixels, int shift) {
+        return _mm_and_si128(_mm_srli_epi32(pixels, shift), _mm_set1_epi32(0xFF));
+    }
+    //! Pack 32-bit channel lanes back to RGBA pixels.
+    inline __m128i Pack(__m128i r, __m128i g, __m128i b, __m128i a) {
+        return _mm_or_si128(
+            _mm_or_si128(r, _mm_slli_epi32(g, 8)),
+            _mm_or_si128(_mm_slli_epi32(b, 16), _mm_slli_epi32(a, 24)));
+    }
+
+    //! Blend 4 foreground pixels over 4 background pixels.
+    inline __m128i Blend4(__m128i bg, __m128i fg) {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i bgA = _mm_srli_epi32(bg, 24);
+        const __m128i fgA = _mm_srli_epi32(fg, 24);
+
+        const __m128i fgIsTransparent = _mm_cmpeq_epi32(fgA, zero);
+        const __m128i bgIsTransparent = _mm_cmpeq_epi32(bgA, zero);
+        const __m128i fgWins = _mm_or_si128(_mm_cmpeq_epi32(fgA, _mm_set1_epi32(0xFF)), bgIsTransparent);
+        const __m128i bothTransparent = _mm_and_si128(fgIsTransparent, bgIsTransparent);
+
+        // Common case of opaque or transparent foreground pixels, no arithmetic needed
+        const __m128i isTrivial = _mm_or_si128(fgWins, fgIsTransparent);
+        if (_mm_movemask_epi8(isTrivial) == 0xFFFF && _mm_movemask_epi8(bothTransparent) == 0) {
+            return Select(fgIsTransparent, bg, fg);
+        }
+
+        const __m128 bgr01 = To01(Channel(bg, 0));
+        const __m128 bgg01 = To01(Channel(bg, 8));
+        const __m128 bgb01 = To01(Channel(bg, 16));
+        const __m128 fgr01 = To01(Channel(fg, 0));
+        const __m128 fgg01 = To01(Channel(fg, 8));
+        const __m128 fgb01 = To01(Channel(fg, 16));
+
+        const __m128 bga01 = To01(bgA);
+        const __m128 fga01 = To01(fgA);
+        const __m128 fga01inv = _mm_sub_ps(_mm_set1_ps(1.0f), fga01);
+
+        const __m128 resa01 = _mm_add_ps(fga01, _mm_mul_ps(fga01inv, bga01));
+        const __m128 bga01xfga01inv = _mm_mul_ps(bga01, fga01inv);
+
+        const __m128i blended = Pack(
+            To255(_mm_div_ps(_mm_add_ps(_mm_mul_ps(fgr01, fga01), _mm_mul_ps(bgr01, bga01xfga01inv)), resa01)),
+            To255(_mm_div_ps(_mm_add_ps(_mm_mul_ps(fgg01, fga01), _mm_mul_ps(bgg01, bga01xfga01inv)), resa01)),
+            To255(_mm_div_ps(_mm_add_ps(_mm_mul_ps(fgb01, fga01), _mm_mul_ps(bgb01, bga01xfga01inv)), resa01)),
+            To255(resa01));
+
+        // Both pixels transparent - average the colors
+        const __m128 half = _mm_set1_ps(0.5f);
+        const __m128i averaged = Pack(
+            To255(_mm_mul_ps(_mm_add_ps(bgr01, fgr01), half)),
+            To255(_mm_mul_ps(_mm_add_ps(bgg01, fgg01), half)),
+            To255(_mm_mul_ps(_mm_add_ps(bgb01, fgb01), half)),
+            zero);
+
+        __m128i result = Select(fgWins, fg, blended);
+        result = Select(fgIsTransparent, bg, result);
+        return Select(bothTransparent, averaged, result);
+    }
+
+    //! Compute round(value / 255) in 16-bit lanes, exact for value in <0, 255*255>.
+    inline __m128i Div255(__m128i value) {
+        value = _mm_add_epi16(value, _mm_set1_epi16(128));
+        return _mm_srli_epi16(_mm_add_epi16(value, _mm_srli_epi16(value, 8)), 8);
+    }
+    //! Scale 2 background pixels in 16-bit lanes by 255 - alpha of the matching foreground pixels.
+    inline __m128i ScaleByInverseAlpha(__m128i bg16, __m128i fgInv16) {
+        const __m128i alphaInv = _mm_shufflehi_epi16(_mm_shufflelo_epi16(fgInv16, 0xFF), 0xFF);
+        return Div255(_mm_mullo_epi16(bg16, alphaInv));
+    }
+
+    //! Blend 4 premultiplied foreground pixels over 4 premultiplied background pixels.
+    inline __m128i BlendPremultiplied4(__m128i bg, __m128i fg) {
+        const __m128i alphaMask = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(fg, alphaMask), alphaMask)) == 0xFFFF) {
+            return fg;
+        }
+
+        // 255 - channel for every byte
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i fgInv = _mm_xor_si128(fg, _mm_set1_epi32(-1));
+
+        const __m128i bgLo = ScaleByInverseAlpha(_mm_unpacklo_epi8(bg, zero), _mm_unpacklo_epi8(fgInv, zero));
+        const __m128i bgHi = ScaleByInverseAlpha(_mm_unpackhi_epi8(bg, zero), _mm_unpackhi_epi8(fgInv, zero));
+
+        return _mm_adds_epu8(fg, _mm_packus_epi16(bgLo, bgHi));
+    }
+
+    //! Multiply 32-bit lanes holding values below 2^16. The products are exact.
+    inline __m128i MulU16(__m128i a, __m128i b) {
+        return _mm_or_si128(_mm_mullo_epi16(a, b), _mm_slli_epi32(_mm_mulhi_epu16(a, b), 16));
+    }
+    //! Compute (value * reciprocal + 2^31) >> 32 in 32-bit lanes, the products must fit in 64 bits.
+    inline __m128i MulReciprocal(__m128i value, __m128i reciprocal) {
+        const __m128i half = _mm_set1_epi64x(int64_t(1) << 31);
+        const __m128i even = _mm_add_epi64(_mm_mul_epu32(value, reciprocal), half);
+        const __m128i odd = _mm_add_epi64(_mm_mul_epu32(_mm_srli_epi64(value, 32), _mm_srli_epi64(reciprocal, 32)), half);
+        return _mm_or_si128(_mm_srli_epi64(even, 32), _mm_and_si128(odd, _mm_set1_epi64x(static_cast<int64_t>(0xFFFFFFFF00000000ull))));
+    }
+
+    //! Blend 4 foreground pixels over 4 background pixels in fixed point.
+    inline __m128i BlendFixedPoint4(__m128i bg, __m128i fg) {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i bgA = _mm_srli_epi32(bg, 24);
+        const __m128i fgA = _mm_srli_epi32(fg, 24);
+
+        const __m128i fgIsTransparent = _mm_cmpeq_epi32(fgA, zero);
+        const __m128i bgIsTransparent = _mm_cmpeq_epi32(bgA, zero);
+        const __m128i fgWins = _mm_or_si128(_mm_cmpeq_epi32(fgA, _mm_set1_epi32(0xFF)), bgIsTransparent);
+        const __m128i bothTransparent = _mm_and_si128(fgIsTransparent, bgIsTransparent);
+
+        // Both pixels transparent - average the colors, rounding up. The alpha average is 0.
+        const __m128i averaged = _mm_avg_epu8(bg, fg);
+
+        const __m128i isTrivial = _mm_or_si128(fgWins, fgIsTransparent);
+        if (_mm_movemask_epi8(isTrivial) == 0xFFFF) {
+            return Select(bothTransparent, averaged, Select(fgIsTransparent, bg, fg));
+        }
+
+        const __m128i channelMask = _mm_set1_epi32(0xFF);
+        const __m128i fgWeight = MulU16(fgA, channelMask);
+        const __m128i bgWeight = MulU16(bgA, _mm_sub_epi32(channelMask, fgA));
+        const __m128i weightSum = _mm_add_epi32(fgWeight, bgWeight);
+
+        // No gather in SSE2, the weight sums are looked up one by one
+        alignas(16) uint32_t weightSums[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(weightSums), weightSum);
+        const uint32_t* reciprocals = odr::BlendWeightReciprocals();
+        const __m128i reciprocal = _mm_setr_epi32(
+            static_cast<int>(reciprocals[weightSums[0]]), static_cast<int>(reciprocals[weightSums[1]]),
+            static_cast<int>(reciprocals[weightSums[2]]), static_cast<int>(reciprocals[weightSums[3]]));
+
+        const auto blendChannel = [&](int shift) {
+            const __m128i weighted = _mm_add_epi32(MulU16(Channel(fg, shift), fgWeight), MulU16(Channel(bg, shift), bgWeight));
+            return _mm_and_si128(MulReciprocal(weighted, reciprocal), channelMask);
+        };
+
+        // (weightSum + 127) / 255 as a multiplication by 2^23 / 255, exact for sums up to 255 * 255
+        const __m128i alpha = _mm_srli_epi32(MulU16(_mm_add_epi32(weightSum, _mm_set1_epi32(127)), _mm_set1_epi32(0x8081)), 23);
+        const __m128i blended = Pack(blendChannel(0), blendChannel(8), blendChannel(16), alpha);
+
+        __m128i result = Select(fgWins, fg, blended);
+        result = Select(fgIsTransparent, bg, result);
+        return Select(bothTransparent, averaged, result);
+    }
+
+    //! Pack a color to a 32-bit RGBA lane.
+    inline int PackColor(const odr::PixelColor& color) {
+        const uint32_t packed = color.r | (color.g << 8) | (color.b << 16) | (static_cast<uint32_t>(color.a) << 24);
+        return static_cast<int>(packed);
+    }
+}
+
+
+void odr::BlendSpanSse2(unsigned char* dst, const unsigned char* src, uint32_t pixelCount) {
+    uint32_t i = 0;
+
+    for (; i + 4 <= pixelCount; i += 4) {
+        __m128i* dstPixels = reinterpret_cast<__m128i*>(dst + i * 4);
+        const __m128i bg = _mm_loadu_si128(dstPixels);
+        const __m128i fg = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+
+        _mm_storeu_si128(dstPixels, Blend4(bg, fg));
+    }
+
+    BlendSpanScalar(dst + i * 4, src + i * 4, pixelCount - i);
+}
+
+void odr::BlendColorSpanSse2(unsigned char* dst, const PixelColor& color, uint32_t pixelCount) {
+    const __m128i fg = _mm_set1_epi32(PackColor(color));
+    uint32_t i = 0;
+
+    if (color.a == 0xFF) {
+        for (; i + 4 <= pixelCount; i += 4) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), fg);
+        }
+    }
+    else {
+        for (; i + 4 <= pixelCount; i += 4) {
+            __m128i* dstPixels = reinterpret_cast<__m128i*>(dst + i * 4);
+            _mm_storeu_si128(dstPixels, Blend4(_mm_loadu_si128(dstPixels), fg));
+        }
+    }
+
+    BlendColorSpanScalar(dst + i * 4, color, pixelCount - i);
+}
+
+void odr::BlendSpanFixedPointSse2(unsigned char* dst, const unsigned char* src, uint32_t pixelCount) {
+    uint32_t i = 0;
+
+    for (; i + 4 <= pixelCount; i += 4) {
+        __m128i* dstPixels = reinterpret_cast<__m128i*>(dst + i * 4);
+        const __m128i bg = _mm_loadu_si128(dstPixels);
+        const __m128i fg = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+
+        _mm_storeu_si128(dstPixels, BlendFixedPoint4(bg, fg));
+    }
+
+    BlendSpanFixedPoint(dst + i * 4, src + i * 4, pixelCount - i);
+}
+
+void odr::BlendColorSpanFixedPointSse2(unsigned char* dst, const PixelColor& color, uint32_t pixelCount) {
+    const __m128i fg = _mm_set1_epi32(PackColor(color));
+    uint32_t i = 0;
+
+    if (color.a == 0xFF) {
+        for (; i + 4 <= pixelCount; i += 4) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), fg);
+        }
+    }
+    else {
+        for (; i + 4 <= pixelCount; i += 4) {
+            __m128i* dstPixels = reinterpret_cast<__m128i*>(dst + i * 4);
+            _mm_storeu_si128(dstPixels, BlendFixedPoint4(_mm_loadu_si128(dstPixels), fg));
+        }
+    }
+
+    BlendColorSpanFixedPoint(dst + i * 4, color, pixelCount - i);
+}
+
+void odr::BlendSpanPremultipliedSse2(unsigned char* dst, const unsigned char* src, uint32_t pixelCount) {
+    uint32_t i = 0;
+
+    for (; i + 4 <= pixelCount; i += 4) {
+        __m128i* dstPixels = reinterpret_cast<__m128i*>(dst + i * 4);
+        const __m128i bg = _mm_loadu_si128(dstPixels);
+        const __m128i fg = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+
+        _mm_storeu_si128(dstPixels, BlendPremultiplied4(bg, fg));
+    }
+
+    BlendSpanPremultipliedScalar(dst + i * 4, src + i * 4, pixelCount - i);
+}
+
+void odr::BlendColorSpanPremultipliedSse2(unsigned char* dst, const PixelColor& color, uint32_t pixelCount) {
+    const __m128i fg = _mm_set1_epi32(PackColor(color));
+    uint32_t i = 0;
+
+    for (; i + 4 <= pixelCount; i += 4) {
+        __m128i* dstPixels = reinterpret_cast<__m128i*>(dst + i * 4);
+        _mm_storeu_si128(dstPixels, BlendPremultiplied4(_mm_loadu_si128(dstPixels), fg));
+    }
+
+    BlendColorSpanPremultipliedScalar(dst + i * 4, color, pixelCount - i);
+}
+
+#endif
@@ -0,0 +1,273 @@
+#include "Compositing.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include <OpenDesignRenderer/Image.h>
+#include <OpenDesignRenderer/ImageContentInfo.h>
+#include <OpenDesignRenderer/ImageView.h>
+#include <OpenDesignRenderer/PixelColor.h>
+
+#include "BlendSpan.h"
+#include "ImageResampler.h"
+#include "PixelFormatConversion.h"
+
+namespace {
+    //! Rows of a scaled image computed at once by CompositeScaledImage.
+    constexpr uint32_t RESAMPLED_BAND_HEIGHT = 32;
+
+    //! Columns <beg, end) of a row of a rectangle band drawn with one color, in target coordinates.
+    struct BandSegment {
+        int64_t beg;
+        int64_t end;
+        odr::PixelColor color;
+    };
+
+    //! Rows <top, bottom) of a rectangle made of the same segments - the top or bottom stroke, or the sides and interior.
+    struct RectangleBand {
+        uint32_t top;
+        uint32_t bottom;
+        BandSegment segments[3];
+        uint32_t segmentCount;
+    };
+
+    //! Draw a constant color over a segment of a row. Opaque colors replace the pixels, transparent premultiplied ones keep them.
+    inline void DrawColorSegment(const odr::BlendKernels& kernels, unsigned char* row, const BandSegment& segment) {
+        if (segment.beg >= segment.end) {
+            return;
+        }
+
+        unsigned char* pixels = row + segment.beg * 4;
+        const uint32_t pixelCount = static_cast<uint32_t>(segment.end - segment.beg);
+
+        if (segment.color.a == 255) {
+            odr::FillColorSpan(pixels, segment.color, pixelCount);
+        } else if (segment.color.a != 0 || kernels.pixelFormat != odr::PixelFormat::Premultiplied) {
+            // Straight blending of a transparent color over a transparent pixel changes its color, see PixelColor::Blend
+            kernels.blendColorSpan(pixels, segment.color, pixelCount);
+        }
+    }
+
+    //! Draw all rows of a band. Rows of opaque bands are all the same, the first one is copied to the others.
+    void DrawRectangleBand(const odr::BlendKernels& kernels, odr::Image& target, const RectangleBand& band) {
+        if (band.top >= band.bottom) {
+            return;
+        }
+
+        bool isOpaque = true;
+        for (uint32_t i = 0; i < band.segmentCount; i++) {
+            isOpaque &= band.segments[i].color.a == 255;
+        }
+
+        // The segments are adjacent and ordered
+        const int64_t left = band.segments[0].beg;
+        const size_t rowSize = static_cast<size_t>(band.segments[band.segmentCount - 1].end - left) * 4;
+        const unsigned char* firstRow = nullptr;
+
+        for (uint32_t y = band.top; y < band.bottom; y++) {
+            unsigned char* row = target.GetRowData(y);
+
+            if (isOpaque && firstRow != nullptr) {
+                std::memcpy(row + left * 4, firstRow + left * 4, rowSize);
+                continue;
+            }
+
+            for (uint32_t i = 0; i < band.segmentCount; i++) {
+                DrawColorSegment(kernels, row, band.segments[i]);
+            }
+            firstRow = row;
+        }
+    }
+}
+
+
+bool odr::CompositeImage(
+    const BlendKernels& kernels,
+    Image& target,
+    const PixelRectangle& clip,
+    const ImageView& image,
+    const PixelCoordinatesUnbounded& imagePosition,
+    bool isImageOpaque) {
+    const PixelRectangle area = PixelRectangle::Clipped(imagePosition, image.GetDimensions(), target.GetDimensions())
+        .Intersected(clip);
+    if (area.IsEmpty()) {
+        return true;
+    }
+
+    if (!image.IsInitialized() || image.GetPixelFormat() != kernels.pixelFormat) {
+        return false;
+    }
+
+    const uint32_t imageLeft = static_cast<uint32_t>(area.position.left - imagePosition.left);
+    const uint32_t imageTop = static_cast<uint32_t>(area.position.top - imagePosition.top);
+
+    // Blending an opaque pixel yields the pixel exactly
+    for (uint32_t y = 0; y < area.dimensions.height; y++) {
+        unsigned char* targetRow = target.GetRowData(area.position.top + y) + area.position.left * 4;
+        const unsigned char* imageRow = image.GetRowData(imageTop + y) + imageLeft * 4;
+
+        if (isImageOpaque) {
+            std::memcpy(targetRow, imageRow, static_cast<size_t>(area.dimensions.width) * 4);
+        } else {
+            kernels.blendSpan(targetRow, imageRow, area.dimensions.width);
+        }
+    }
+
+    return true;
+}
+
+bool odr::CompositeScaledImage(
+    const BlendKernels& kernels,
+    Image& target,
+    const PixelRectangle& clip,
+    const ImageResampler& resampler,
+    const PixelCoordinatesUnbounded& imagePosition,
+    bool isImageOpaque) {
+    const PixelRectangle area = PixelRectangle::Clipped(imagePosition, resampler.GetDimensions(), target.GetDimensions())
+        .Intersected(clip);
+    if (area.IsEmpty()) {
+        return true;
+    }
+
+    const ImageView& image = resampler.GetSource();
+    if (!image.IsInitialized()) {
+        return false;
+    }
+
+    if (resampler.IsIdentity() && image.GetPixelFormat() == kernels.pixelFormat) {
+        return CompositeImage(kernels, target, clip, resampler.GetSource(), imagePosition, isImageOpaque);
+    }
+
+    const uint32_t imageLeft = static_cast<uint32_t>(area.position.left - imagePosition.left);
+    const uint32_t imageTop = static_cast<uint32_t>(area.position.top - imagePosition.top);
+
+    // A band of rows of the visible part of the scaled image, separable filters share the source rows within a band
+    const uint32_t bandHeight = std::min(area.dimensions.height, RESAMPLED_BAND_HEIGHT);
+    const size_t bandRowStride = static_cast<size_t>(area.dimensions.width) * 4;
+    std::vector<unsigned char> band(bandRowStride * bandHeight);
+
+    for (uint32_t bandTop = 0; bandTop < area.dimensions.height; bandTop += bandHeight) {
+        const uint32_t bandRowCount = std::min(bandHeight, area.dimensions.height - bandTop);
+        const PixelRectangle bandArea{ { imageLeft, imageTop + bandTop }, { area.dimensions.width, bandRowCount } };
+        resampler.ResampleArea(bandArea, band.data(), bandRowStride);
+
+        for (uint32_t y = 0; y < bandRowCount; y++) {
+            unsigned char* bandRow = band.data() + y * bandRowStride;
+            ConvertPixelFormatSpan(bandRow, area.dimensions.width, image.GetPixelFormat(), kernels.pixelFormat);
+
+            unsigned char* targetRow = target.GetRowData(area.position.top + bandTop + y) + area.position.left * 4;
+            kernels.blendSpan(targetRow, bandRow, area.dimensions.width);
+        }
+    }
+
+    return true;
+}
+
+odr::PixelRectangle odr::ClipToContent(
+    const PixelRectangle& area,
+    const ImageContentInfo& contentInfo,
+    const PixelCoordinatesUnbounded& imagePosition,
+    PixelFormat targetPixelFormat) {
+    if (targetPixelFormat != PixelFormat::Premultiplied) {
+        return area;
+    }
+
+    const PixelRectangle& bounds = contentInfo.contentBounds;
+
+    // Clip in 64 bits, the shifted bounds may not fit the unbounded coordinates
+    const int64_t left = std::max<int64_t>(static_cast<int64_t>(imagePosition.left) + bounds.position.left, area.position.left);
+    const int64_t top = std::max<int64_t>(static_cast<int64_t>(imagePosition.top) + bounds.position.top, area.position.top);
+    const int64_t right = std::min<int64_t>(static_cast<int64_t>(imagePosition.left) + bounds.Right(), area.Right());
+    const int64_t bottom = std::min<int64_t>(static_cast<int64_t>(imagePosition.top) + bounds.Bottom(), area.Bottom());
+
+    if (bounds.IsEmpty() || left >= right || top >= bottom) {
+        return PIXEL_RECTANGLE_EMPTY;
+    }
+
+    return PixelRectangle{
+        { static_cast<uint32_t>(left), static_cast<uint32_t>(top) },
+        { static_cast<uint32_t>(right - left), static_cast<uint32_t>(bottom - top) } };
+}
+
+void odr::CompositeRectangle(
+    const BlendKernels& kernels,
+    Image& target,
+    const PixelRectangle& clip,
+    const PixelCoordinatesUnbounded& rectanglePosition,
+    const ImageDimensions& rectangleDimensions,
+    const PixelColor& fillColor_,
+    uint32_t innerStrokeWidth,
+    const PixelColor& strokeColor_) {
+    const PixelRectangle area = PixelRectangle::Clipped(rectanglePosition, rectangleDimensions, target.GetDimensions())
+        .Intersected(clip);
+    if (area.IsEmpty()) {
+        return;
+    }
+
+    const bool isPremultiplied = kernels.pixelFormat == PixelFormat::Premultiplied;
+    const PixelColor fillColor = isPremultiplied ? PixelColor::Premultiplied(fillColor_) : fillColor_;
+    const PixelColor strokeColor = isPremultiplied ? PixelColor::Premultiplied(strokeColor_) : strokeColor_;
+
+    // Interior (fill) columns and rows in rectangle coordinates. Empty when the stroke covers everything.
+    const uint32_t innerLeft = std::min(innerStrokeWidth, rectangleDimensions.width);
+    const uint32_t innerRight = rectangleDimensions.width > 2 * static_cast<uint64_t>(innerStrokeWidth)
+        ? rectangleDimensions.width - innerStrokeWidth
+        : innerLeft;
+    const uint32_t innerTop = std::min(innerStrokeWidth, rectangleDimensions.height);
+    const uint32_t innerBottom = rectangleDimensions.height > 2 * static_cast<uint64_t>(innerStrokeWidth)
+        ? rectangleDimensions.height - innerStrokeWidth
+        : innerTop;
+
+    // Interior rows and columns in target coordinates, clipped to the area
+    const auto clipRow = [&](int64_t row) {
+        return static_cast<uint32_t>(std::min<int64_t>(std::max<int64_t>(row, area.position.top), area.Bottom()));
+    };
+    const auto clipColumn = [&](int64_t column) {
+        return std::min<int64_t>(std::max<int64_t>(column, area.position.left), area.Right());
+    };
+    const uint32_t interiorTop = clipRow(static_cast<int64_t>(rectanglePosition.top) + innerTop);
+    const uint32_t interiorBottom = clipRow(static_cast<int64_t>(rectanglePosition.top) + innerBottom);
+    const int64_t interiorLeft = clipColumn(static_cast<int64_t>(rectanglePosition.left) + innerLeft);
+    const int64_t interiorRight = clipColumn(static_cast<int64_t>(rectanglePosition.left) + innerRight);
+
+    const BandSegment strokeSegment{ area.position.left, area.Right(), strokeColor };
+    const RectangleBand bands[] = {
+        { area.position.top, interiorTop, { strokeSegment }, 1 },
+        { interiorTop, interiorBottom, {
+            { area.position.left, interiorLeft, strokeColor },
+            { interiorLeft, interiorRight, fillColor },
+            { interiorRight, area.Right(), strokeColor } }, 3 },
+        { interiorBottom, area.Bottom(), { strokeSegment }, 1 },
+    };
+
+    for (const RectangleBand& band : bands) {
+        DrawRectangleBand(kernels, target, band);
+    }
+}
+
+void odr::MultiplyOpacity(Image& image, unsigned char opacity) {
+    if (opacity == 255 || !image.IsInitialized()) {
+        return;
+    }
+
+    // Straight colors keep their values, premultiplied ones are scaled with the alpha
+    const uint32_t firstChannel = image.GetPixelFormat() == PixelFormat::Premultiplied ? 0 : 3;
+    const size_t rowSize = static_cast<size_t>(image.GetDimensions().width) * 4;
+
+    for (uint32_t y = 0; y < image.GetDimensions().height; y++) {
+        unsigned char* row = image.GetRowData(y);
+        for (size_t i = 0; i < rowSize; i += 4) {
+            for (uint32_t channel = firstChannel; channel < 4; channel++) {
+                // value * opacity / 255, rounded
+                const uint32_t product = static_cast<uint32_t>(row[i + channel]) * opacity + 128u;
+                row[i + channel] = static_cast<unsigned char>((product + (product >> 8)) >> 8);
+            }
+        }
+    }
+    image.MarkContentChanged();
+}
+
+void odr::ClearArea(Image& target, const PixelRectangle& area) {
+    target.FillRect(area, COLOR_TRANSPARENT);
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <OpenDesignRenderer/ImageDimensions.h>
+#include <OpenDesignRenderer/PixelCoordinates.h>
+#include <OpenDesignRenderer/PixelFormat.h>
+#include <OpenDesignRenderer/PixelRectangle.h>
+#include <OpenDesignRenderer/ResamplingFilter.h>
+
+// Forward declarations
+namespace odr {
+class Image;
+class ImageResampler;
+class ImageView;
+struct BlendKernels;
+struct ImageContentInfo;
+struct PixelColor;
+}
+
+namespace odr {
+/*!
+    \brief Composite an image over the target image. Only pixels inside the clip rectangle are touched.
+    \param kernels The span blending kernels to use.
+    \param target The image being drawn to.
+    \param clip The area of the target that may be modified.
+    \param image The image or view to be drawn, already in its final dimensions and in the pixel format of the kernels.
+    \param imagePosition Position of the image's top left corner in the target.
+    \param isImageOpaque All pixels of the image are fully opaque, its rows are copied instead of blended.
+    \return False if the image could not be drawn.
+*/
+bool CompositeImage(
+    const BlendKernels& kernels,
+    Image& target,
+    const PixelRectangle& clip,
+    const ImageView& image,
+    const PixelCoordinatesUnbounded& imagePosition,
+    bool isImageOpaque);
+
+/*!
+    \brief Scale an image and composite it over the target image in one pass. Only pixels inside the clip rectangle are touched.
+    \note Only the visible part of the scaled image is computed, in bands of rows, and it is never stored whole.
+        The result is identical to compositing Image::Scaled converted to the pixel format of the kernels.
+    \param kernels The span blending kernels to use.
+    \param target The image being drawn to.
+    \param clip The area of the target that may be modified.
+    \param resampler The scaling of the image or view to be drawn, from any dimensions and pixel format.
+    \param imagePosition Position of the scaled image's top left corner in the target.
+    \param isImageOpaque All pixels of the source are fully opaque, unscaled rows are copied instead of blended.
+    \return False if the image could not be drawn.
+*/
+bool CompositeScaledImage(
+    const BlendKernels& kernels,
+    Image& target,
+    const PixelRectangle& clip,
+    const ImageResampler& resampler,
+    const PixelCoordinatesUnbounded& imagePosition,
+    bool isImageOpaque);
+
+/*!
+    \brief The part of an area of the target changed by drawing an unscaled image - below its non-transparent pixels.
+    \note Blending transparent pixels leaves premultiplied targets unchanged. Straight blending of a transparent pixel
+        over a transparent one changes its color, see PixelColor::Blend, straight targets get the whole area.
+    \param area The area the image is drawn to.
+    \param contentInfo Content info of the image, see Image::GetContentInfo.
+    \param imagePosition Position of the image's top left corner in the target.
+    \param targetPixelFormat Pixel format of the target.
+    \return Empty rectangle if drawing the image changes no pixel of the area.
+*/
+PixelRectangle ClipToContent(
+    const PixelRectangle& area,
+    const ImageContentInfo& contentInfo,
+    const PixelCoordinatesUnbounded& imagePosition,
+    PixelFormat targetPixelFormat);
+
+/*!
+    \brief Composite a rectangle with an inner stroke over the target image. Only pixels inside the clip rectangle are touched.
+    \param kernels The span blending kernels to use.
+    \param target The image being drawn to.
+    \param clip The area of the target that may be modified.
+    \param rectanglePosition Position of the rectangle's top left corner in the target.
+    \param rectangleDimensions The dimensions of the rectangle.
+    \param fillColor The fill color of the rectangle, straight alpha.
+    \param innerStrokeWidth Stroke width, the stroke is rendered inside the rectangle.
+    \param strokeColor Stroke color, straight alpha.
+*/
+void CompositeRectangle(
+    const BlendKernels& kernels,
+    Image& target,
+    const PixelRectangle& clip,
+    const PixelCoordinatesUnbounded& rectanglePosition,
+    const ImageDimensions& rectangleDimensions,
+    const PixelColor& fillColor,
+    uint32_t innerStrokeWidth,
+    const PixelColor& strokeColor);
+
+/*!
+    \brief Multiply the alpha of all pixels of the image by the opacity, and the colors of premultiplied pixels.
+    \note Compositing the result equals compositing the image with the opacity, e.g. of a layer group.
+    \param image The image being changed, in any pixel format.
+    \param opacity The opacity, 255 leaves the image unchanged.
+*/
+void MultiplyOpacity(Image& image, unsigned char opacity);
+
+/*!
+    \brief Set all pixels of an area of the target image to transparent.
+    \param target The image being cleared.
+    \param area The area to clear, must lie inside the target.
+*/
+void ClearArea(Image& target, const PixelRectangle& area);
+}
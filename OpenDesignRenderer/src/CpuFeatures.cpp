@@ -0,0 +1,41 @@
+#include "CpuFeatures.h"
+
+#if defined(ODR_X86_SIMD) && defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+namespace {
+    //! Query the CPU, the result never changes during the process lifetime.
+    bool DetectAvx2() {
+#if defined(ODR_X86_SIMD) && defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7) {
+            return false;
+        }
+
+        // The OS must save the YMM registers (OSXSAVE + XCR0 bits 1 and 2)
+        __cpuid(info, 1);
+        const bool isOsxsave = (info[2] & (1 << 27)) != 0;
+        const bool isAvx = (info[2] & (1 << 28)) != 0;
+        if (!isOsxsave || !isAvx || (_xgetbv(0) & 0x6) != 0x6) {
+            return false;
+        }
+
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+#elif defined(ODR_X86_SIMD)
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+#else
+        return false;
+#endif
+    }
+}
+
+
+bool odr::IsAvx2Supported() {
+    static const bool isSupported = DetectAvx2();
+    return isSupported;
+}
@@ -0,0 +1,6 @@
+#pragma once
+
+namespace odr {
+//! Detect if the CPU and the operating system support AVX2 instructions.
+bool IsAvx2Supported();
+}
@@ -0,0 +1,47 @@
+#include "DiffSpan.h"
+
+#include <algorithm>
+
+#include "CpuFeatures.h"
+
+
+odr::DiffSpanFunction odr::SelectDiffSpan(InstructionSet maxInstructionSet) {
+#if defined(ODR_X86_SIMD)
+    if (maxInstructionSet >= InstructionSet::Avx2 && IsAvx2Supported()) {
+        return DiffSpanAvx2;
+    }
+    if (maxInstructionSet >= InstructionSet::Sse2) {
+        return DiffSpanSse2;
+    }
+#else
+    (void)maxInstructionSet;
+#endif
+    return DiffSpanScalar;
+}
+
+void odr::DiffSpanScalar(
+    const unsigned char* a,
+    const unsigned char* b,
+    unsigned char* diff,
+    uint32_t pixelCount,
+    uint8_t tolerance,
+    DiffStatistics& statistics) {
+    for (uint32_t i = 0; i < pixelCount; i++, a += 4, b += 4) {
+        bool isDifferent = false;
+
+        for (uint32_t channel = 0; channel < 4; channel++) {
+            const uint8_t error = a[channel] >= b[channel] ? a[channel] - b[channel] : b[channel] - a[channel];
+
+            statistics.errorSum += error;
+            statistics.squaredErrorSum += static_cast<uint32_t>(error) * error;
+            statistics.maxChannelError = std::max(statistics.maxChannelError, error);
+            isDifferent |= error > tolerance;
+
+            if (diff != nullptr) {
+                *diff++ = error;
+            }
+        }
+
+        statistics.differentPixelCount += isDifferent ? 1 : 0;
+    }
+}
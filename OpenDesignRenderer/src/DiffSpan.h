@@ -0,0 +1,49 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <OpenDesignRenderer/InstructionSet.h>
+
+namespace odr {
+//! Channel difference sums of compared spans, accumulated by the diff kernels.
+struct DiffStatistics {
+    //! Sum of the absolute channel differences.
+    uint64_t errorSum = 0;
+    //! Sum of the squared channel differences.
+    uint64_t squaredErrorSum = 0;
+    //! Number of pixels with a channel differing by more than the tolerance.
+    uint64_t differentPixelCount = 0;
+    //! Largest channel difference.
+    uint8_t maxChannelError = 0;
+};
+
+/*!
+    \brief Compare two spans of RGBA pixels channel by channel and accumulate the differences.
+    \param a First pixels.
+    \param b Second pixels.
+    \param diff Receives the absolute channel differences, may be nullptr.
+    \param pixelCount Number of pixels in all spans.
+    \param tolerance Largest channel difference of pixels not counted as different.
+    \param statistics Accumulates the differences.
+*/
+using DiffSpanFunction = void (*)(
+    const unsigned char* a,
+    const unsigned char* b,
+    unsigned char* diff,
+    uint32_t pixelCount,
+    uint8_t tolerance,
+    DiffStatistics& statistics);
+
+//! Select the fastest diff kernel supported by the CPU, up to the specified instruction set. All give identical results.
+DiffSpanFunction SelectDiffSpan(InstructionSet maxInstructionSet);
+
+//! Portable kernel, one channel at a time.
+void DiffSpanScalar(const unsigned char* a, const unsigned char* b, unsigned char* diff, uint32_t pixelCount, uint8_t tolerance, DiffStatistics& statistics);
+
+#if defined(ODR_X86_SIMD)
+//! SSE2 kernel, 4 pixels per iteration.
+void DiffSpanSse2(const unsigned char* a, const unsigned char* b, unsigned char* diff, uint32_t pixelCount, uint8_t tolerance, DiffStatistics& statistics);
+//! AVX2 kernel, 8 pixels per iteration. Only call it if IsAvx2Supported().
+void DiffSpanAvx2(const unsigned char* a, const unsigned char* b, unsigned char* diff, uint32_t pixelCount, uint8_t tolerance, DiffStatistics& statistics);
+#endif
+}
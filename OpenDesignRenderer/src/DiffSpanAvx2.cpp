@@ -0,0 +1,93 @@
+#include "DiffSpan.h"
+
+#if defined(ODR_X86_SIMD)
+
+#include <immintrin.h>
+
+// This file is compiled with AVX2 enabled, see CMakeLists.txt.
+namespace {
+    //! Iterations between flushes of the 32-bit squared error lanes, each adds at most 2 * 2 * 255^2 to a lane.
+    constexpr uint32_t SQUARED_FLUSH_INTERVAL = 8192;
+
+    //! Sum of the 32-bit lanes.
+    inline uint64_t SumLanes32(__m256i value) {
+        alignas(32) uint32_t lanes[8];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), value);
+
+        uint64_t sum = 0;
+        for (const uint32_t lane : lanes) {
+            sum += lane;
+        }
+        return sum;
+    }
+}
+
+
+void odr::DiffSpanAvx2(
+    const unsigned char* a,
+    const unsigned char* b,
+    unsigned char* diff,
+    uint32_t pixelCount,
+    uint8_t tolerance,
+    DiffStatistics& statistics) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i tolerances = _mm256_set1_epi8(static_cast<char>(tolerance));
+
+    __m256i errorSums = zero;
+    __m256i squaredErrorSums = zero;
+    __m256i maxErrors = zero;
+    // Per lane count of pixels within the tolerance, decremented by the all-ones compare masks
+    __m256i negatedEqualCounts = zero;
+
+    const uint32_t vectorPixelCount = pixelCount & ~7u;
+
+    for (uint32_t i = 0; i < vectorPixelCount; i += 8) {
+        const __m256i pixelsA = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i * 4));
+        const __m256i pixelsB = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i * 4));
+        const __m256i errors = _mm256_or_si256(_mm256_subs_epu8(pixelsA, pixelsB), _mm256_subs_epu8(pixelsB, pixelsA));
+
+        if (diff != nullptr) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(diff + i * 4), errors);
+        }
+
+        errorSums = _mm256_add_epi64(errorSums, _mm256_sad_epu8(errors, zero));
+        maxErrors = _mm256_max_epu8(maxErrors, errors);
+
+        const __m256i errorsLo = _mm256_unpacklo_epi8(errors, zero);
+        const __m256i errorsHi = _mm256_unpackhi_epi8(errors, zero);
+        squaredErrorSums = _mm256_add_epi32(squaredErrorSums, _mm256_add_epi32(_mm256_madd_epi16(errorsLo, errorsLo), _mm256_madd_epi16(errorsHi, errorsHi)));
+
+        // A pixel is equal when no channel exceeds the tolerance
+        const __m256i isEqual = _mm256_cmpeq_epi32(_mm256_subs_epu8(errors, tolerances), zero);
+        negatedEqualCounts = _mm256_add_epi32(negatedEqualCounts, isEqual);
+
+        if ((i / 8 + 1) % SQUARED_FLUSH_INTERVAL == 0) {
+            statistics.squaredErrorSum += SumLanes32(squaredErrorSums);
+            squaredErrorSums = zero;
+        }
+    }
+
+    alignas(32) uint64_t errorSumLanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(errorSumLanes), errorSums);
+    statistics.errorSum += errorSumLanes[0] + errorSumLanes[1] + errorSumLanes[2] + errorSumLanes[3];
+    statistics.squaredErrorSum += SumLanes32(squaredErrorSums);
+
+    const uint64_t equalPixelCount = SumLanes32(_mm256_sub_epi32(zero, negatedEqualCounts));
+    statistics.differentPixelCount += vectorPixelCount - equalPixelCount;
+
+    alignas(32) uint8_t maxErrorLanes[32];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(maxErrorLanes), maxErrors);
+    for (const uint8_t maxError : maxErrorLanes) {
+        statistics.maxChannelError = maxError > statistics.maxChannelError ? maxError : statistics.maxChannelError;
+    }
+
+    DiffSpanScalar(
+        a + vectorPixelCount * 4,
+        b + vectorPixelCount * 4,
+        diff != nullptr ? diff + vectorPixelCount * 4 : nullptr,
+        pixelCount - vectorPixelCount,
+        tolerance,
+        statistics);
+}
+
+#endif
@@ -0,0 +1,87 @@
+#include "DiffSpan.h"
+
+#if defined(ODR_X86_SIMD)
+
+#include <emmintrin.h>
+
+namespace {
+    //! Iterations between flushes of the 32-bit squared error lanes, each adds at most 2 * 2 * 255^2 to a lane.
+    constexpr uint32_t SQUARED_FLUSH_INTERVAL = 8192;
+
+    //! Sum of the 32-bit lanes.
+    inline uint64_t SumLanes32(__m128i value) {
+        alignas(16) uint32_t lanes[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes), value);
+        return static_cast<uint64_t>(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+    }
+}
+
+
+void odr::DiffSpanSse2(
+    const unsigned char* a,
+    const unsigned char* b,
+    unsigned char* diff,
+    uint32_t pixelCount,
+    uint8_t tolerance,
+    DiffStatistics& statistics) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i tolerances = _mm_set1_epi8(static_cast<char>(tolerance));
+
+    __m128i errorSums = zero;
+    __m128i squaredErrorSums = zero;
+    __m128i maxErrors = zero;
+    // Per lane count of pixels within the tolerance, decremented by the all-ones compare masks
+    __m128i negatedEqualCounts = zero;
+
+    const uint32_t vectorPixelCount = pixelCount & ~3u;
+
+    for (uint32_t i = 0; i < vectorPixelCount; i += 4) {
+        const __m128i pixelsA = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i * 4));
+        const __m128i pixelsB = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i * 4));
+        const __m128i errors = _mm_or_si128(_mm_subs_epu8(pixelsA, pixelsB), _mm_subs_epu8(pixelsB, pixelsA));
+
+        if (diff != nullptr) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(diff + i * 4), errors);
+        }
+
+        errorSums = _mm_add_epi64(errorSums, _mm_sad_epu8(errors, zero));
+        maxErrors = _mm_max_epu8(maxErrors, errors);
+
+        const __m128i errorsLo = _mm_unpacklo_epi8(errors, zero);
+        const __m128i errorsHi = _mm_unpackhi_epi8(errors, zero);
+        squaredErrorSums = _mm_add_epi32(squaredErrorSums, _mm_add_epi32(_mm_madd_epi16(errorsLo, errorsLo), _mm_madd_epi16(errorsHi, errorsHi)));
+
+        // A pixel is equal when no channel exceeds the tolerance
+        const __m128i isEqual = _mm_cmpeq_epi32(_mm_subs_epu8(errors, tolerances), zero);
+        negatedEqualCounts = _mm_add_epi32(negatedEqualCounts, isEqual);
+
+        if ((i / 4 + 1) % SQUARED_FLUSH_INTERVAL == 0) {
+            statistics.squaredErrorSum += SumLanes32(squaredErrorSums);
+            squaredErrorSums = zero;
+        }
+    }
+
+    alignas(16) uint64_t errorSumLanes[2];
+    _mm_store_si128(reinterpret_cast<__m128i*>(errorSumLanes), errorSums);
+    statistics.errorSum += errorSumLanes[0] + errorSumLanes[1];
+    statistics.squaredErrorSum += SumLanes32(squaredErrorSums);
+
+    const uint64_t equalPixelCount = SumLanes32(_mm_sub_epi32(zero, negatedEqualCounts));
+    statistics.differentPixelCount += vectorPixelCount - equalPixelCount;
+
+    alignas(16) uint8_t maxErrorLanes[16];
+    _mm_store_si128(reinterpret_cast<__m128i*>(maxErrorLanes), maxErrors);
+    for (const uint8_t maxError : maxErrorLanes) {
+        statistics.maxChannelError = maxError > statistics.maxChannelError ? maxError : statistics.maxChannelError;
+    }
+
+    DiffSpanScalar(
+        a + vectorPixelCount * 4,
+        b + vectorPixelCount * 4,
+        diff != nullptr ? diff + vectorPixelCount * 4 : nullptr,
+        pixelCount - vectorPixelCount,
+        tolerance,
+        statistics);
+}
+
+#endif
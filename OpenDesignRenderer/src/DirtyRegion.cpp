@@ -0,0 +1,62 @@
+#include "DirtyRegion.h"
+
+#include <stddef.h>
+
+namespace {
+    //! Beyond this many rectangles, tracking them costs more than recompositing their bounding box.
+    constexpr size_t MAX_RECTANGLE_COUNT = 32;
+}
+
+
+void odr::DirtyRegion::Add(const PixelRectangle& rectangle) {
+    if (rectangle.IsEmpty()) {
+        return;
+    }
+
+    // Absorb every overlapping rectangle, the union may overlap rectangles that the original did not
+    PixelRectangle united = rectangle;
+    bool isUnited = true;
+    while (isUnited) {
+        isUnited = false;
+
+        for (size_t i = 0; i < rectangles.size(); i++) {
+            if (rectangles[i].Intersected(united).IsEmpty()) {
+                continue;
+            }
+
+            united = united.United(rectangles[i]);
+            rectangles[i] = rectangles.back();
+            rectangles.pop_back();
+            isUnited = true;
+            break;
+        }
+    }
+
+    rectangles.push_back(united);
+
+    if (rectangles.size() > MAX_RECTANGLE_COUNT) {
+        PixelRectangle bounds = PIXEL_RECTANGLE_EMPTY;
+        for (const PixelRectangle& r : rectangles) {
+            bounds = bounds.United(r);
+        }
+        rectangles.assign(1, bounds);
+    }
+}
+
+void odr::DirtyRegion::Add(const DirtyRegion& other) {
+    for (const PixelRectangle& rectangle : other.rectangles) {
+        Add(rectangle);
+    }
+}
+
+void odr::DirtyRegion::Clear() {
+    rectangles.clear();
+}
+
+bool odr::DirtyRegion::IsEmpty() const {
+    return rectangles.empty();
+}
+
+const std::vector<odr::PixelRectangle>& odr::DirtyRegion::GetRectangles() const {
+    return rectangles;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <vector>
+
+#include <OpenDesignRenderer/PixelRectangle.h>
+
+namespace odr {
+/*!
+    \brief Set of changed frame buffer areas.
+    \note Kept as non-overlapping rectangles: overlapping rectangles are replaced by their union, so every
+        pixel is recomposited at most once. Too many rectangles collapse into their bounding box.
+*/
+class DirtyRegion {
+public:
+    //! Add a changed area. Empty rectangles are ignored.
+    void Add(const PixelRectangle& rectangle);
+    //! Add all areas of another region.
+    void Add(const DirtyRegion& other);
+    //! Remove all areas.
+    void Clear();
+
+    //! Detect if nothing changed.
+    bool IsEmpty() const;
+    //! The non-overlapping changed areas.
+    const std::vector<PixelRectangle>& GetRectangles() const;
+
+private:
+    std::vector<PixelRectangle> rectangles;
+};
+}
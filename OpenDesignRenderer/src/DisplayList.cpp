@@ -0,0 +1,348 @@
+#include "DisplayList.h"
+
+#include <algorithm>
+#include <limits>
+
+#include <OpenDesignRenderer/Image.h>
+#include <OpenDesignRenderer/ImageContentInfo.h>
+
+#include "Compositing.h"
+#include "DirtyRegion.h"
+
+namespace {
+    //! Detect if the whole rectangle is painted with one color and provide it.
+    bool GetUniformColor(
+        const odr::ImageDimensions& rectangleDimensions,
+        const odr::PixelColor& fillColor,
+        uint32_t innerStrokeWidth,
+        const odr::PixelColor& strokeColor,
+        odr::PixelColor& color) {
+        if (innerStrokeWidth == 0 || fillColor == strokeColor) {
+            color = fillColor;
+            return true;
+        }
+
+        // The stroke covers the whole rectangle, see CompositeRectangle
+        const uint64_t strokesWidth = 2 * static_cast<uint64_t>(innerStrokeWidth);
+        if (strokesWidth >= rectangleDimensions.width || strokesWidth >= rectangleDimensions.height) {
+            color = strokeColor;
+            return true;
+        }
+
+        return false;
+    }
+
+    //! Part of a rectangle painted by its fill color only, clipped to the frame buffer area.
+    odr::PixelRectangle InteriorArea(
+        const odr::PixelCoordinatesUnbounded& rectanglePosition,
+        const odr::ImageDimensions& rectangleDimensions,
+        uint32_t innerStrokeWidth,
+        const odr::PixelRectangle& area) {
+        const uint64_t strokesWidth = 2 * static_cast<uint64_t>(innerStrokeWidth);
+        if (strokesWidth >= rectangleDimensions.width || strokesWidth >= rectangleDimensions.height) {
+            return odr::PIXEL_RECTANGLE_EMPTY;
+        }
+
+        // Clip in 64 bits, the shifted position may not fit the unbounded coordinates
+        const int64_t left = std::max<int64_t>(static_cast<int64_t>(rectanglePosition.left) + innerStrokeWidth, area.position.left);
+        const int64_t top = std::max<int64_t>(static_cast<int64_t>(rectanglePosition.top) + innerStrokeWidth, area.position.top);
+        const int64_t right = std::min<int64_t>(
+            static_cast<int64_t>(rectanglePosition.left) + rectangleDimensions.width - innerStrokeWidth, area.Right());
+        const int64_t bottom = std::min<int64_t>(
+            static_cast<int64_t>(rectanglePosition.top) + rectangleDimensions.height - innerStrokeWidth, area.Bottom());
+
+        if (left >= right || top >= bottom) {
+            return odr::PIXEL_RECTANGLE_EMPTY;
+        }
+
+        return odr::PixelRectangle{
+            { static_cast<uint32_t>(left), static_cast<uint32_t>(top) },
+            { static_cast<uint32_t>(right - left), static_cast<uint32_t>(bottom - top) } };
+    }
+
+    //! Detect if two commands draw the same pixels.
+    bool IsSameDrawing(const odr::DrawCommand& commandA, const odr::DrawCommand& commandB) {
+        if (
+            commandA.type != commandB.type ||
+            commandA.area != commandB.area ||
+            commandA.position.left != commandB.position.left ||
+            commandA.position.top != commandB.position.top ||
+            !(commandA.dimensions == commandB.dimensions)) {
+            return false;
+        }
+
+        switch (commandA.type) {
+        case odr::DrawCommand::Type::Image:
+            return commandA.image == commandB.image || *commandA.image == *commandB.image;
+        case odr::DrawCommand::Type::Rectangle:
+            return
+                commandA.fillColor == commandB.fillColor &&
+                commandA.innerStrokeWidth == commandB.innerStrokeWidth &&
+                commandA.strokeColor == commandB.strokeColor;
+        }
+
+        return false;
+    }
+
+    //! Number of pixels in a rectangle.
+    uint64_t PixelCount(const odr::PixelRectangle& rectangle) {
+        return static_cast<uint64_t>(rectangle.dimensions.width) * rectangle.dimensions.height;
+    }
+}
+
+
+bool odr::RecordedImageSource::operator==(const RecordedImageSource& other) const {
+    return
+        contentId == other.contentId &&
+        scaledDimensions == other.scaledDimensions &&
+        filter == other.filter &&
+        position.left == other.position.left &&
+        position.top == other.position.top &&
+        area == other.area;
+}
+
+
+odr::DisplayList::DisplayList(bool isOcclusionCullingEnabled_) :
+    isOcclusionCullingEnabled(isOcclusionCullingEnabled_) {
+}
+
+
+void odr::DisplayList::AddImage(
+    const std::shared_ptr<const Image>& image,
+    const PixelCoordinatesUnbounded& imagePosition,
+    const PixelRectangle& area_,
+    const RecordedImageSource& imageSource) {
+    // The content info is computed once here on the recording thread and cached with the image. It is final, see above.
+    const ImageContentInfo contentInfo = image->GetContentInfo();
+    const PixelRectangle area = ClipToContent(area_, contentInfo, imagePosition, image->GetPixelFormat());
+    if (area.IsEmpty()) {
+        return;
+    }
+
+    DrawCommand command{};
+    command.type = DrawCommand::Type::Image;
+    command.area = area;
+    command.position = imagePosition;
+    command.dimensions = image->GetDimensions();
+    command.opaqueArea = contentInfo.isOpaque ? area : PIXEL_RECTANGLE_EMPTY;
+    command.image = image;
+    command.isImageOpaque = contentInfo.isOpaque;
+    command.imageSource = imageSource;
+
+    commands.push_back(command);
+    bounds = bounds.United(area);
+}
+
+std::shared_ptr<const odr::Image> odr::DisplayList::FindRecordedImage(size_t commandIndex, const RecordedImageSource& imageSource) const {
+    if (imageSource.contentId == 0 || commandIndex >= commands.size()) {
+        return nullptr;
+    }
+
+    const DrawCommand& command = commands[commandIndex];
+    if (command.type != DrawCommand::Type::Image || !(command.imageSource == imageSource)) {
+        return nullptr;
+    }
+
+    return command.image;
+}
+
+void odr::DisplayList::AddRectangle(
+    const PixelCoordinatesUnbounded& rectanglePosition,
+    const ImageDimensions& rectangleDimensions,
+    const PixelRectangle& area,
+    const PixelColor& fillColor,
+    uint32_t innerStrokeWidth,
+    const PixelColor& strokeColor) {
+    if (area.IsEmpty()) {
+        return;
+    }
+
+    PixelColor uniformColor;
+    const bool isUniform = GetUniformColor(rectangleDimensions, fillColor, innerStrokeWidth, strokeColor, uniformColor);
+    if (isUniform && TryMergeRectangle(rectanglePosition, rectangleDimensions, area, uniformColor)) {
+        return;
+    }
+
+    DrawCommand command{};
+    command.type = DrawCommand::Type::Rectangle;
+    command.area = area;
+    command.position = rectanglePosition;
+    command.dimensions = rectangleDimensions;
+    command.fillColor = isUniform ? uniformColor : fillColor;
+    command.innerStrokeWidth = isUniform ? 0 : innerStrokeWidth;
+    command.strokeColor = isUniform ? uniformColor : strokeColor;
+
+    if (isUniform) {
+        command.opaqueArea = uniformColor.a == 0xFF ? area : PIXEL_RECTANGLE_EMPTY;
+    }
+    else if (fillColor.a == 0xFF) {
+        command.opaqueArea = strokeColor.a == 0xFF
+            ? area
+            : InteriorArea(rectanglePosition, rectangleDimensions, innerStrokeWidth, area);
+    }
+
+    commands.push_back(command);
+    bounds = bounds.United(area);
+}
+
+void odr::DisplayList::Clear() {
+    commands.clear();
+    bounds = PIXEL_RECTANGLE_EMPTY;
+}
+
+bool odr::DisplayList::IsEmpty() const {
+    return commands.empty();
+}
+
+size_t odr::DisplayList::GetCommandCount() const {
+    return commands.size();
+}
+
+const odr::PixelRectangle& odr::DisplayList::GetBounds() const {
+    return bounds;
+}
+
+void odr::DisplayList::AddChangedAreas(const DisplayList& previous, DirtyRegion& changedRegion) const {
+    const size_t commonCount = std::min(commands.size(), previous.commands.size());
+
+    for (size_t i = 0; i < commonCount; i++) {
+        if (!IsSameDrawing(commands[i], previous.commands[i])) {
+            changedRegion.Add(previous.commands[i].area);
+            changedRegion.Add(commands[i].area);
+        }
+    }
+
+    for (size_t i = commonCount; i < previous.commands.size(); i++) {
+        changedRegion.Add(previous.commands[i].area);
+    }
+    for (size_t i = commonCount; i < commands.size(); i++) {
+        changedRegion.Add(commands[i].area);
+    }
+}
+
+bool odr::DisplayList::Execute(
+    const BlendKernels& kernels,
+    Image& target,
+    const PixelRectangle& clip,
+    uint64_t& culledPixelCount) const {
+    const std::vector<PixelRectangle> visibleAreas = ComputeVisibleAreas(clip);
+    bool isExecuted = true;
+
+    for (size_t i = 0; i < commands.size(); i++) {
+        const DrawCommand& command = commands[i];
+        const PixelRectangle& visibleArea = visibleAreas[i];
+
+        culledPixelCount += PixelCount(command.area.Intersected(clip)) - PixelCount(visibleArea);
+        if (visibleArea.IsEmpty()) {
+            continue;
+        }
+
+        switch (command.type) {
+        case DrawCommand::Type::Image:
+            isExecuted &= CompositeImage(kernels, target, visibleArea, *command.image, command.position, command.isImageOpaque);
+            break;
+        case DrawCommand::Type::Rectangle:
+            CompositeRectangle(
+                kernels,
+                target,
+                visibleArea,
+                command.position,
+                command.dimensions,
+                command.fillColor,
+                command.innerStrokeWidth,
+                command.strokeColor);
+            break;
+        }
+    }
+
+    return isExecuted;
+}
+
+std::vector<odr::PixelRectangle> odr::DisplayList::ComputeVisibleAreas(const PixelRectangle& clip) const {
+    std::vector<PixelRectangle> visibleAreas(commands.size(), PIXEL_RECTANGLE_EMPTY);
+    // Opaque parts of the later commands inside the clip rectangle
+    std::vector<PixelRectangle> occluders;
+
+    // Back to front, an opaque pixel hides everything drawn before it. Blending an opaque color yields the color exactly.
+    for (size_t i = commands.size(); i-- > 0;) {
+        const DrawCommand& command = commands[i];
+
+        PixelRectangle visibleArea = command.area.Intersected(clip);
+        for (const PixelRectangle& occluder : occluders) {
+            if (visibleArea.IsEmpty()) {
+                break;
+            }
+            visibleArea = visibleArea.Subtracted(occluder);
+        }
+        visibleAreas[i] = visibleArea;
+
+        if (!isOcclusionCullingEnabled) {
+            continue;
+        }
+
+        const PixelRectangle occluder = command.opaqueArea.Intersected(clip);
+        if (!occluder.IsEmpty()) {
+            occluders.push_back(occluder);
+        }
+    }
+
+    return visibleAreas;
+}
+
+bool odr::DisplayList::TryMergeRectangle(
+    const PixelCoordinatesUnbounded& rectanglePosition,
+    const ImageDimensions& rectangleDimensions,
+    const PixelRectangle& area,
+    const PixelColor& color) {
+    if (commands.empty()) {
+        return false;
+    }
+
+    // Only the last command, merging across other commands would change the drawing order
+    DrawCommand& last = commands.back();
+    if (last.type != DrawCommand::Type::Rectangle || last.innerStrokeWidth != 0 || !(last.fillColor == color)) {
+        return false;
+    }
+
+    const int64_t lastRight = static_cast<int64_t>(last.position.left) + last.dimensions.width;
+    const int64_t lastBottom = static_cast<int64_t>(last.position.top) + last.dimensions.height;
+    const int64_t right = static_cast<int64_t>(rectanglePosition.left) + rectangleDimensions.width;
+    const int64_t bottom = static_cast<int64_t>(rectanglePosition.top) + rectangleDimensions.height;
+    constexpr int64_t MAX_DIMENSION = std::numeric_limits<uint32_t>::max();
+
+    const bool isSameRows =
+        last.position.top == rectanglePosition.top &&
+        last.dimensions.height == rectangleDimensions.height;
+    const bool isSameColumns =
+        last.position.left == rectanglePosition.left &&
+        last.dimensions.width == rectangleDimensions.width;
+
+    PixelCoordinatesUnbounded mergedPosition = last.position;
+    ImageDimensions mergedDimensions = last.dimensions;
+
+    if (isSameRows && (lastRight == rectanglePosition.left || right == last.position.left)) {
+        if (static_cast<int64_t>(last.dimensions.width) + rectangleDimensions.width > MAX_DIMENSION) {
+            return false;
+        }
+        mergedPosition.left = std::min(last.position.left, rectanglePosition.left);
+        mergedDimensions.width += rectangleDimensions.width;
+    }
+    else if (isSameColumns && (lastBottom == rectanglePosition.top || bottom == last.position.top)) {
+        if (static_cast<int64_t>(last.dimensions.height) + rectangleDimensions.height > MAX_DIMENSION) {
+            return false;
+        }
+        mergedPosition.top = std::min(last.position.top, rectanglePosition.top);
+        mergedDimensions.height += rectangleDimensions.height;
+    }
+    else {
+        return false;
+    }
+
+    last.position = mergedPosition;
+    last.dimensions = mergedDimensions;
+    last.area = last.area.United(area);
+    last.opaqueArea = color.a == 0xFF ? last.area : PIXEL_RECTANGLE_EMPTY;
+    bounds = bounds.United(area);
+
+    return true;
+}
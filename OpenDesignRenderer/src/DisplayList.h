@@ -0,0 +1,148 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <memory>
+#include <vector>
+
+#include <OpenDesignRenderer/ImageDimensions.h>
+#include <OpenDesignRenderer/PixelColor.h>
+#include <OpenDesignRenderer/PixelCoordinates.h>
+#include <OpenDesignRenderer/PixelRectangle.h>
+#include <OpenDesignRenderer/ResamplingFilter.h>
+
+// Forward declarations
+namespace odr {
+class DirtyRegion;
+class Image;
+struct BlendKernels;
+}
+
+namespace odr {
+//! The drawing an image command was recorded from, to reuse the recorded image when it is recorded again unchanged.
+struct RecordedImageSource {
+    //! Content identifier of the source image, see Image::GetContentId. Zero for sources without one, never reused.
+    uint64_t contentId;
+    //! The dimensions the source was scaled to.
+    ImageDimensions scaledDimensions;
+    //! The filter the source was scaled with.
+    ResamplingFilter filter;
+    //! Unclipped position of the scaled source.
+    PixelCoordinatesUnbounded position;
+    //! The recorded part of the target.
+    PixelRectangle area;
+
+    bool operator==(const RecordedImageSource& other) const;
+};
+
+//! One recorded draw call.
+struct DrawCommand {
+    enum class Type {
+        Image,
+        Rectangle,
+    };
+
+    Type type;
+    //! The part of the target the command touches, never empty.
+    PixelRectangle area;
+    //! Unclipped position of the image or rectangle.
+    PixelCoordinatesUnbounded position;
+    //! Unclipped dimensions of the image or rectangle.
+    ImageDimensions dimensions;
+    //! The part of the area the command paints fully opaque, hiding everything drawn before. May be empty.
+    PixelRectangle opaqueArea;
+
+    //! Image already scaled to the dimensions and in the target pixel format. Image commands only.
+    std::shared_ptr<const Image> image;
+    //! All pixels of the image are fully opaque, it is copied instead of blended. Image commands only.
+    bool isImageOpaque;
+    //! What the image was recorded from. Image commands only.
+    RecordedImageSource imageSource;
+
+    //! Rectangle fill, straight alpha. Rectangle commands only.
+    PixelColor fillColor;
+    //! Rectangle inner stroke width. Rectangle commands only.
+    uint32_t innerStrokeWidth;
+    //! Rectangle stroke color, straight alpha. Rectangle commands only.
+    PixelColor strokeColor;
+};
+
+/*!
+    \brief Recorded draw commands, executed later in recording order.
+    \note Commands are clipped when recorded, fully clipped commands are dropped. Consecutive single-color
+        rectangles that share an edge are merged, blending them once gives the same pixels as blending twice
+        since they do not overlap.
+*/
+class DisplayList {
+public:
+    /*!
+        \brief Construct an empty display list.
+        \param isOcclusionCullingEnabled Skip the parts of commands hidden below later fully opaque commands.
+    */
+    explicit DisplayList(bool isOcclusionCullingEnabled);
+
+    /*!
+        \brief Record an image. The image must be final: scaled to the dimensions and in the target pixel format.
+        \note The area is clipped to the pixels the image changes, see ClipToContent. Images changing none are dropped.
+    */
+    void AddImage(
+        const std::shared_ptr<const Image>& image,
+        const PixelCoordinatesUnbounded& imagePosition,
+        const PixelRectangle& area,
+        const RecordedImageSource& imageSource);
+    /*!
+        \brief Find the image recorded from the same source by the command at the index, e.g. of the retained scene.
+        \note Lets an unchanged scene be recorded without resampling, scanning and comparing its images again.
+        \return nullptr if the command is not an image recorded from the source, or the source has no content identifier.
+    */
+    std::shared_ptr<const Image> FindRecordedImage(size_t commandIndex, const RecordedImageSource& imageSource) const;
+
+    //! Record a rectangle with an inner stroke, see CompositeRectangle.
+    void AddRectangle(
+        const PixelCoordinatesUnbounded& rectanglePosition,
+        const ImageDimensions& rectangleDimensions,
+        const PixelRectangle& area,
+        const PixelColor& fillColor,
+        uint32_t innerStrokeWidth,
+        const PixelColor& strokeColor);
+
+    //! Drop all commands.
+    void Clear();
+
+    //! Detect if there is nothing to execute.
+    bool IsEmpty() const;
+    //! Number of recorded commands, after merging.
+    size_t GetCommandCount() const;
+    //! Smallest rectangle containing the areas of all commands.
+    const PixelRectangle& GetBounds() const;
+
+    /*!
+        \brief Collect the areas where this list draws differently than the previous one.
+        \note Commands are compared pairwise in order. A changed command dirties both its old and new area.
+    */
+    void AddChangedAreas(const DisplayList& previous, DirtyRegion& changedRegion) const;
+
+    /*!
+        \brief Execute the commands in recording order, only pixels inside the clip rectangle are touched.
+        \note Safe to call concurrently for non-overlapping clip rectangles.
+        \param culledPixelCount Increased by the number of pixels not blended because later opaque commands cover them.
+        \return False if any of the commands could not be executed.
+    */
+    bool Execute(const BlendKernels& kernels, Image& target, const PixelRectangle& clip, uint64_t& culledPixelCount) const;
+
+private:
+    //! Try to extend the last command by the rectangle instead of recording a new one.
+    bool TryMergeRectangle(
+        const PixelCoordinatesUnbounded& rectanglePosition,
+        const ImageDimensions& rectangleDimensions,
+        const PixelRectangle& area,
+        const PixelColor& color);
+
+    //! Parts of the commands visible in the clip rectangle, in command order.
+    std::vector<PixelRectangle> ComputeVisibleAreas(const PixelRectangle& clip) const;
+
+    bool isOcclusionCullingEnabled;
+    std::vector<DrawCommand> commands;
+    PixelRectangle bounds = PIXEL_RECTANGLE_EMPTY;
+};
+}
@@ -0,0 +1,44 @@
+#include "FileMapping.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+unsigned char* odr::MapFile(const std::string& filepath, size_t& size) {
+    const int file = open(filepath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (file < 0) {
+        return nullptr;
+    }
+
+    struct stat fileStatus;
+    if (fstat(file, &fileStatus) != 0 || fileStatus.st_size <= 0) {
+        close(file);
+        return nullptr;
+    }
+
+    // The mapping keeps its own reference to the file
+    void* data = mmap(nullptr, static_cast<size_t>(fileStatus.st_size), PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0);
+    close(file);
+    if (data == MAP_FAILED) {
+        return nullptr;
+    }
+
+    size = static_cast<size_t>(fileStatus.st_size);
+    return static_cast<unsigned char*>(data);
+}
+
+void odr::UnmapFile(unsigned char* data, size_t size) {
+    if (data != nullptr) {
+        munmap(data, size);
+    }
+}
+#else
+unsigned char* odr::MapFile(const std::string&, size_t&) {
+    return nullptr;
+}
+
+void odr::UnmapFile(unsigned char*, size_t) {
+}
+#endif
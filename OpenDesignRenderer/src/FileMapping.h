@@ -0,0 +1,18 @@
+#pragma once
+
+#include <stddef.h>
+
+#include <string>
+
+namespace odr {
+/*!
+    \brief Map a whole file into memory as a private copy-on-write mapping.
+    \note Reading the mapping shares the page cache with every other mapping of the file. A page is copied
+        privately on its first write, the file itself is never modified.
+    \param size Receives the size of the file and of the mapping in bytes.
+    \return The mapped file, nullptr on failure, for empty files and on platforms without memory mapping.
+*/
+unsigned char* MapFile(const std::string& filepath, size_t& size);
+//! Release a mapping returned by MapFile.
+void UnmapFile(unsigned char* data, size_t size);
+}
@@ -0,0 +1,224 @@
+#include "FileWriter.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define ODR_POSIX_FILES
+#endif
+
+namespace {
+    //! Largest amount of data passed to one write call.
+    constexpr size_t MAX_WRITE_SIZE = size_t{ 1 } << 30;
+    //! Alignment of the memory, offsets and sizes of direct writes.
+    constexpr size_t DIRECT_BLOCK_SIZE = 4096;
+    //! Size of the aligned buffer of direct writes.
+    constexpr size_t DIRECT_BUFFER_SIZE = 256 * DIRECT_BLOCK_SIZE;
+}
+
+#ifdef ODR_POSIX_FILES
+
+odr::FileWriter::FileWriter() {
+}
+
+odr::FileWriter::~FileWriter() {
+    if (file >= 0) {
+        close(file);
+    }
+    free(directBuffer);
+}
+
+bool odr::FileWriter::Open(const std::string& filepath, const ImageSaveSettings& settings) {
+    if (file >= 0) {
+        return false;
+    }
+
+    const int flags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+#ifdef O_DIRECT
+    if (settings.isDirect) {
+        void* buffer = nullptr;
+        if (posix_memalign(&buffer, DIRECT_BLOCK_SIZE, DIRECT_BUFFER_SIZE) == 0) {
+            file = open(filepath.c_str(), flags | O_DIRECT, 0644);
+            // File systems without direct IO (e.g. tmpfs) refuse the flag
+            if (file >= 0) {
+                directBuffer = static_cast<unsigned char*>(buffer);
+            } else {
+                free(buffer);
+            }
+        }
+    }
+#endif
+    if (file < 0) {
+        file = open(filepath.c_str(), flags, 0644);
+    }
+
+    isSynced = settings.isSynced;
+    isFailed = file < 0;
+    return !isFailed;
+}
+
+bool odr::FileWriter::Write(const void* data, size_t size) {
+    if (file < 0 || isFailed) {
+        return false;
+    }
+
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    if (directBuffer == nullptr) {
+        isFailed = !WriteFully(bytes, size);
+        return !isFailed;
+    }
+
+    while (size > 0 && !isFailed) {
+        const size_t copiedSize = std::min(size, DIRECT_BUFFER_SIZE - directBufferUsed);
+        std::memcpy(directBuffer + directBufferUsed, bytes, copiedSize);
+        directBufferUsed += copiedSize;
+        bytes += copiedSize;
+        size -= copiedSize;
+
+        if (directBufferUsed == DIRECT_BUFFER_SIZE) {
+            isFailed = !FlushDirectBuffer();
+        }
+    }
+
+    return !isFailed;
+}
+
+bool odr::FileWriter::Close() {
+    if (file < 0) {
+        return false;
+    }
+
+    if (directBuffer != nullptr && !isFailed) {
+        isFailed = !FlushDirectBuffer();
+
+        // The tail is shorter than a block, finish it with cached writes
+#ifdef O_DIRECT
+        if (!isFailed && directBufferUsed > 0) {
+            const int flags = fcntl(file, F_GETFL);
+            isFailed =
+                flags == -1 ||
+                fcntl(file, F_SETFL, flags & ~O_DIRECT) == -1 ||
+                !WriteFully(directBuffer, directBufferUsed);
+        }
+#endif
+        directBufferUsed = 0;
+    }
+
+    if (isSynced && !isFailed) {
+        isFailed = fsync(file) != 0;
+    }
+
+    isFailed = close(file) != 0 || isFailed;
+    file = -1;
+
+    return !isFailed;
+}
+
+bool odr::FileWriter::WriteFully(const unsigned char* data, size_t size) {
+    while (size > 0) {
+        const ssize_t writtenSize = write(file, data, std::min(size, MAX_WRITE_SIZE));
+        if (writtenSize < 0 && errno == EINTR) {
+            continue;
+        }
+        // Nothing written without an error would loop forever, e.g. on a full device
+        if (writtenSize <= 0) {
+            return false;
+        }
+
+        data += writtenSize;
+        size -= static_cast<size_t>(writtenSize);
+    }
+
+    return true;
+}
+
+bool odr::FileWriter::FlushDirectBuffer() {
+    const size_t blockBytes = directBufferUsed - directBufferUsed % DIRECT_BLOCK_SIZE;
+    if (blockBytes == 0) {
+        return true;
+    }
+
+    if (!WriteFully(directBuffer, blockBytes)) {
+        return false;
+    }
+
+    std::memmove(directBuffer, directBuffer + blockBytes, directBufferUsed - blockBytes);
+    directBufferUsed -= blockBytes;
+    return true;
+}
+
+#elif defined(_WIN32)
+
+// Direct writes are not supported
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+
+odr::FileWriter::FileWriter() {
+}
+
+odr::FileWriter::~FileWriter() {
+    if (file >= 0) {
+        _close(file);
+    }
+}
+
+bool odr::FileWriter::Open(const std::string& filepath, const ImageSaveSettings& settings) {
+    if (file >= 0) {
+        return false;
+    }
+
+    file = _open(filepath.c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _S_IREAD | _S_IWRITE);
+    isSynced = settings.isSynced;
+    isFailed = file < 0;
+    return !isFailed;
+}
+
+bool odr::FileWriter::Write(const void* data, size_t size) {
+    if (file < 0 || isFailed) {
+        return false;
+    }
+
+    isFailed = !WriteFully(static_cast<const unsigned char*>(data), size);
+    return !isFailed;
+}
+
+bool odr::FileWriter::Close() {
+    if (file < 0) {
+        return false;
+    }
+
+    if (isSynced && !isFailed) {
+        isFailed = _commit(file) != 0;
+    }
+
+    isFailed = _close(file) != 0 || isFailed;
+    file = -1;
+
+    return !isFailed;
+}
+
+bool odr::FileWriter::WriteFully(const unsigned char* data, size_t size) {
+    while (size > 0) {
+        const int writtenSize = _write(file, data, static_cast<unsigned int>(std::min(size, MAX_WRITE_SIZE)));
+        if (writtenSize <= 0) {
+            return false;
+        }
+
+        data += writtenSize;
+        size -= static_cast<size_t>(writtenSize);
+    }
+
+    return true;
+}
+
+bool odr::FileWriter::FlushDirectBuffer() {
+    return true;
+}
+
+#endif
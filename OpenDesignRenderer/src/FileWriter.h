@@ -0,0 +1,44 @@
+#pragma once
+
+#include <stddef.h>
+
+#include <string>
+
+#include <OpenDesignRenderer/ImageSaveSettings.h>
+
+namespace odr {
+/*!
+    \brief Sequential writer of a new file, without buffering the whole content.
+    \note Data is written straight from the passed memory in large chunks. Direct writes go through an aligned
+        buffer of a fixed size, as the passed memory and sizes are not aligned to the device blocks.
+*/
+class FileWriter {
+public:
+    FileWriter();
+    //! Close the file if still open, the result is lost.
+    ~FileWriter();
+
+    FileWriter(const FileWriter&) = delete;
+    FileWriter& operator=(const FileWriter&) = delete;
+
+    //! Create or truncate a file for writing.
+    bool Open(const std::string& filepath, const ImageSaveSettings& settings);
+    //! Append data to the file.
+    bool Write(const void* data, size_t size);
+    //! Write out the buffered data, flush the file to the device when requested and close it. Reports all errors.
+    bool Close();
+
+private:
+    //! Write all of the data with the current file flags. Fails if a write makes no progress.
+    bool WriteFully(const unsigned char* data, size_t size);
+    //! Write out the whole blocks of the direct buffer, keep the remainder at its start.
+    bool FlushDirectBuffer();
+
+    int file = -1;
+    bool isSynced = false;
+    bool isFailed = false;
+    //! Aligned buffer of direct writes, nullptr for cached writes.
+    unsigned char* directBuffer = nullptr;
+    size_t directBufferUsed = 0;
+};
+}
@@ -1,23 +1,180 @@
 #include <OpenDesignRenderer/Image.h>
 
+#include <algorithm>
+#include <atomic>
 #include <fstream>
 #include <sstream>
+#include <vector>
 #include <cmath>
+#include <cstring>
+#include <limits>
+#include <mutex>
 
+#include <OpenDesignRenderer/ImageView.h>
 #include <OpenDesignRenderer/PixelColor.h>
 
+#include "BlendSpan.h"
+#include "DiffSpan.h"
+#include "ImageResampler.h"
+#include "MipmapPyramid.h"
+#include "PixelBuffer.h"
+#include "PixelFormatConversion.h"
+#include "PixelHash.h"
 #include "RgbaBitmap.h"
 
+namespace {
+    //! Source of unique image content identifiers.
+    uint64_t NextContentId() {
+        static std::atomic<uint64_t> lastContentId(0);
+        return ++lastContentId;
+    }
+
+    /*!
+        \brief Straight alpha pixels of a row of a view, padded with transparent pixels to the width.
+        \note Returns the viewed row itself when it needs no conversion, the row buffer otherwise.
+    */
+    const unsigned char* StraightRow(const odr::ImageView& view, uint32_t top, uint32_t width, std::vector<unsigned char>& rowBuffer) {
+        const odr::ImageDimensions& dimensions = view.GetDimensions();
+        if (view.GetPixelFormat() == odr::PixelFormat::Straight && dimensions.width == width && top < dimensions.height) {
+            return view.GetRowData(top);
+        }
+
+        rowBuffer.assign(static_cast<size_t>(width) * 4, 0);
+        if (top < dimensions.height) {
+            std::memcpy(rowBuffer.data(), view.GetRowData(top), static_cast<size_t>(dimensions.width) * 4);
+            odr::ConvertPixelFormatSpan(rowBuffer.data(), dimensions.width, view.GetPixelFormat(), odr::PixelFormat::Straight);
+        }
+        return rowBuffer.data();
+    }
+
+    //! Distinguishes the hashes of premultiplied images from straight ones with the same bytes.
+    constexpr uint64_t PREMULTIPLIED_HASH_SEED = 0xA0761D6478BD642Full;
+
+    //! Alpha of a pixel word, read in memory order regardless of the byte order of the platform.
+    inline uint8_t WordAlpha(uint32_t word) {
+        unsigned char bytes[4];
+        std::memcpy(bytes, &word, 4);
+        return bytes[3];
+    }
+
+    //! Scan the pixels once for opacity, uniformity and the bounds of the non-transparent pixels.
+    odr::ImageContentInfo ScanContent(const odr::Image& image) {
+        odr::ImageContentInfo info;
+        if (!image.IsInitialized()) {
+            return info;
+        }
+
+        const odr::ImageDimensions& dimensions = image.GetDimensions();
+
+        uint32_t firstWord;
+        std::memcpy(&firstWord, image.GetRowData(0), 4);
+
+        // Bitwise AND and OR of all pixels give the alpha of the most transparent and the most opaque ones
+        uint32_t andWords = 0xFFFFFFFFu;
+        uint32_t orWords = 0;
+        uint32_t differentBits = 0;
+        uint32_t left = dimensions.width;
+        uint32_t right = 0;
+        uint32_t top = dimensions.height;
+        uint32_t bottom = 0;
+
+        for (uint32_t y = 0; y < dimensions.height; y++) {
+            const unsigned char* row = image.GetRowData(y);
+
+            uint32_t rowAndWords = 0xFFFFFFFFu;
+            uint32_t rowOrWords = 0;
+            uint32_t rowDifferentBits = 0;
+            for (uint32_t x = 0; x < dimensions.width; x++) {
+                uint32_t word;
+                std::memcpy(&word, row + x * 4, 4);
+                rowAndWords &= word;
+                rowOrWords |= word;
+                rowDifferentBits |= word ^ firstWord;
+            }
+            andWords &= rowAndWords;
+            orWords |= rowOrWords;
+            differentBits |= rowDifferentBits;
+
+            if (WordAlpha(rowOrWords) == 0) {
+                continue;
+            }
+
+            // Only the columns outside of the bounds so far can widen them
+            top = std::min(top, y);
+            bottom = y + 1;
+            uint32_t x = 0;
+            while (x < left && row[x * 4 + 3] == 0) {
+                x++;
+            }
+            left = std::min(left, x);
+            x = dimensions.width;
+            while (x > right && row[(x - 1) * 4 + 3] == 0) {
+                x--;
+            }
+            right = std::max(right, x);
+        }
+
+        info.isOpaque = WordAlpha(andWords) == 255;
+        info.isTransparent = WordAlpha(orWords) == 0;
+        info.isUniform = differentBits == 0;
+        if (info.isUniform) {
+            const unsigned char* pixel = image.GetRowData(0);
+            const odr::PixelColor color{ pixel[0], pixel[1], pixel[2], pixel[3] };
+            info.uniformColor = image.GetPixelFormat() == odr::PixelFormat::Premultiplied
+                ? odr::PixelColor::Unpremultiplied(color)
+                : color;
+        }
+        if (!info.isTransparent) {
+            info.contentBounds = odr::PixelRectangle{ { left, top }, { right - left, bottom - top } };
+        }
+
+        return info;
+    }
+}
 
 odr::Image::Image() :
     dimensions(IMAGE_DIMENSIONS_EMPTY),
-    imageBuffer(nullptr) {
+    imageBuffer(nullptr),
+    contentId(NextContentId()) {
 }
 
 odr::Image::~Image() {
-    if (imageBuffer != nullptr) {
-        free(imageBuffer);
+    SetPixelBuffer(nullptr);
+}
+
+odr::Image::Image(Image&& other) noexcept :
+    dimensions(other.dimensions),
+    pixelFormat(other.pixelFormat),
+    pixelBuffer(std::move(other.pixelBuffer)),
+    imageBuffer(other.imageBuffer),
+    contentId(other.contentId),
+    isMipmapsEnabled(other.isMipmapsEnabled),
+    mipmaps(std::atomic_exchange(&other.mipmaps, std::shared_ptr<const MipmapPyramid>())),
+    contentHash(std::atomic_exchange(&other.contentHash, std::shared_ptr<const CachedContentHash>())),
+    contentInfo(std::atomic_exchange(&other.contentInfo, std::shared_ptr<const CachedContentInfo>())) {
+    other.Clear();
+}
+
+odr::Image& odr::Image::operator=(Image&& other) noexcept {
+    if (this == &other) {
+        return *this;
     }
+
+    // The ownership of the other image's buffer moves with it
+    SetPixelBuffer(nullptr);
+    dimensions = other.dimensions;
+    pixelFormat = other.pixelFormat;
+    pixelBuffer = std::move(other.pixelBuffer);
+    imageBuffer = other.imageBuffer;
+    contentId = other.contentId;
+    isMipmapsEnabled = other.isMipmapsEnabled;
+    std::atomic_store(&mipmaps, std::atomic_exchange(&other.mipmaps, std::shared_ptr<const MipmapPyramid>()));
+    std::atomic_store(&contentHash, std::atomic_exchange(&other.contentHash, std::shared_ptr<const CachedContentHash>()));
+    std::atomic_store(&contentInfo, std::atomic_exchange(&other.contentInfo, std::shared_ptr<const CachedContentInfo>()));
+
+    other.Clear();
+
+    return *this;
 }
 
 bool odr::Image::IsInitialized() const {
@@ -29,56 +186,114 @@ bool odr::Image::IsInitialized() const {
 
 void odr::Image::Clear() {
     dimensions = IMAGE_DIMENSIONS_EMPTY;
+    pixelFormat = PixelFormat::Straight;
+    contentId = NextContentId();
+    DiscardMipmaps();
+    std::atomic_store(&contentHash, std::shared_ptr<const CachedContentHash>());
+    std::atomic_store(&contentInfo, std::shared_ptr<const CachedContentInfo>());
+
+    SetPixelBuffer(nullptr);
+    imageBuffer = nullptr;
+}
+
+bool odr::Image::Allocate(const ImageDimensions& dimensions_, PixelFormat pixelFormat_) {
+    // Only the buffers not shared with other images can be overwritten
+    const bool isBufferReusable =
+        pixelBuffer &&
+        !pixelBuffer->IsShared() &&
+        !pixelBuffer->IsFileMapped() &&
+        dimensions.DataSize() == dimensions_.DataSize();
+
+    if (isBufferReusable) {
+        contentId = NextContentId();
+        DiscardMipmaps();
+    } else {
+        Clear();
 
-    if (imageBuffer != nullptr) {
-        free(imageBuffer);
-        imageBuffer = nullptr;
+        if (dimensions_.DataSize() > 0) {
+            SetPixelBuffer(PixelBuffer::Allocate(dimensions_.DataSize()));
+            if (!pixelBuffer) {
+                return false;
+            }
+            imageBuffer = pixelBuffer->GetData();
+        }
     }
+
+    dimensions = dimensions_;
+    pixelFormat = pixelFormat_;
+    return true;
 }
 
-bool odr::Image::Initialize(const ImageDimensions& dimensions_, const PixelColor& color) {
-    Clear();
+bool odr::Image::DetachData() {
+    if (!pixelBuffer || !pixelBuffer->IsShared()) {
+        return true;
+    }
 
-    imageBuffer = (unsigned char*)malloc(dimensions_.DataSize());
-    if (imageBuffer == nullptr) {
-        Clear();
+    std::shared_ptr<PixelBuffer> privateBuffer = PixelBuffer::Allocate(dimensions.DataSize());
+    if (!privateBuffer) {
         return false;
     }
 
-    dimensions = dimensions_;
+    memcpy(privateBuffer->GetData(), imageBuffer, dimensions.DataSize());
+    SetPixelBuffer(std::move(privateBuffer));
+    imageBuffer = pixelBuffer->GetData();
+    return true;
+}
 
-    for (uint32_t top = 0; top < dimensions.height; top++) {
-        for (uint32_t left = 0; left < dimensions.width; left++) {
-            const PixelCoordinates PixelCoordinates{ left, top };
-            const bool isSet = SetColor(color, PixelCoordinates);
+void odr::Image::SetPixelBuffer(std::shared_ptr<PixelBuffer> newPixelBuffer) {
+    // Added first, a buffer set again is never seen without owners
+    if (newPixelBuffer) {
+        newPixelBuffer->AddOwner();
+    }
+    if (pixelBuffer) {
+        pixelBuffer->RemoveOwner();
+    }
+    pixelBuffer = std::move(newPixelBuffer);
+}
 
-            if (!isSet) {
-                Clear();
-                return false;
-            }
-        }
+bool odr::Image::Initialize(const ImageDimensions& dimensions_, const PixelColor& color, PixelFormat pixelFormat_) {
+    if (!Allocate(dimensions_, pixelFormat_)) {
+        return false;
     }
 
+    const PixelColor storedColor = pixelFormat == PixelFormat::Premultiplied
+        ? PixelColor::Premultiplied(color)
+        : color;
+
+    FillColorSpan(imageBuffer, storedColor, dimensions.Size());
+
     return true;
 }
 
 bool odr::Image::CloneFrom(const Image& otherImage) {
+    if (&otherImage == this) {
+        return true;
+    }
+
     Clear();
 
+    // The data is shared until one of the images changes
     dimensions = otherImage.GetDimensions();
-
-    imageBuffer = (unsigned char*)malloc(dimensions.DataSize());
-    if (imageBuffer == nullptr) {
-        Clear();
-        return false;
+    pixelFormat = otherImage.GetPixelFormat();
+    SetPixelBuffer(otherImage.pixelBuffer);
+    imageBuffer = otherImage.imageBuffer;
+
+    // The same content has the same hash
+    const std::shared_ptr<const CachedContentHash> otherContentHash = std::atomic_load(&otherImage.contentHash);
+    if (otherContentHash && otherContentHash->contentId == otherImage.contentId) {
+        std::atomic_store(&contentHash, std::make_shared<const CachedContentHash>(CachedContentHash{ contentId, otherContentHash->hash }));
+    }
+    const std::shared_ptr<const CachedContentInfo> otherContentInfo = std::atomic_load(&otherImage.contentInfo);
+    if (otherContentInfo && otherContentInfo->contentId == otherImage.contentId) {
+        std::atomic_store(&contentInfo, std::make_shared<const CachedContentInfo>(CachedContentInfo{ contentId, otherContentInfo->info }));
     }
-
-    memcpy(imageBuffer, otherImage.imageBuffer, dimensions.DataSize());
 
     return true;
 }
 
-bool odr::Image::Load(const std::string& filepath) {
+bool odr::Image::Load(const std::string& filepath, PixelFormat pixelFormat_) {
+    Clear();
+
     std::ifstream file(filepath, std::ios::in | std::ios::binary);
 
     if (!file.is_open()) {
@@ -89,90 +304,298 @@ bool odr::Image::Load(const std::string& filepath) {
     ss << file.rdbuf();
 
     const std::string& str = ss.str();
-    const char* sscstr = str.c_str();
-    const unsigned char* usstr = reinterpret_cast<const unsigned char*>(const_cast<char*>(sscstr));
+    const unsigned char* fileData = reinterpret_cast<const unsigned char*>(str.data());
+
+    ImageDimensions fileDimensions = IMAGE_DIMENSIONS_EMPTY;
+    const unsigned char* pixelData = RgbaBitmap::DecodeHeader(
+        fileData,
+        static_cast<uint32_t>(std::min<size_t>(str.size(), UINT32_MAX)),
+        &fileDimensions.width,
+        &fileDimensions.height);
+    if (pixelData == nullptr || !Allocate(fileDimensions, PixelFormat::Straight) || !IsInitialized()) {
+        Clear();
+        return false;
+    }
 
-    imageBuffer = RgbaBitmap::DecodeFromFileData(usstr, str.size(), &dimensions.width, &dimensions.height);
+    memcpy(imageBuffer, pixelData, dimensions.DataSize());
 
-    return
-        dimensions.width > 0 &&
-        dimensions.height > 0 &&
-        imageBuffer != nullptr;
+    return ConvertToPixelFormat(pixelFormat_);
 }
 
-bool odr::Image::Save(const std::string& filePath) const {
-    if (!IsInitialized()) {
-        return false;
+bool odr::Image::LoadMapped(const std::string& filepath, PixelFormat pixelFormat_) {
+    Clear();
+
+    std::shared_ptr<PixelBuffer> mappedFile = PixelBuffer::MapFile(filepath);
+    if (!mappedFile) {
+        return Load(filepath, pixelFormat_);
     }
 
-    const unsigned char* encodedData = RgbaBitmap::EndcodeToFileData(imageBuffer, dimensions.width, dimensions.height);
-    if (encodedData == nullptr) {
+    const unsigned char* pixelData = RgbaBitmap::DecodeHeader(
+        mappedFile->GetData(),
+        static_cast<uint32_t>(std::min<size_t>(mappedFile->GetSize(), UINT32_MAX)),
+        &dimensions.width,
+        &dimensions.height);
+    if (pixelData == nullptr) {
+        Clear();
         return false;
     }
 
-    std::ofstream file(filePath, std::ios::out | std::ios::binary);
-    if (!file.is_open()) {
+    // The mapping is private and writable, the pointer only lost its constness in DecodeHeader
+    SetPixelBuffer(std::move(mappedFile));
+    imageBuffer = pixelBuffer->GetData() + (pixelData - pixelBuffer->GetData());
+
+    if (!IsInitialized()) {
+        Clear();
         return false;
     }
 
-    const uint32_t outputSize = 12 + dimensions.DataSize();
-    const char* encd = reinterpret_cast<char*>(const_cast<unsigned char*>(encodedData));
-    file.write(encd, outputSize);
+    return ConvertToPixelFormat(pixelFormat_);
+}
+
+bool odr::Image::IsFileMapped() const {
+    return pixelBuffer && pixelBuffer->IsFileMapped();
+}
 
-    return true;
+bool odr::Image::IsDataShared() const {
+    return pixelBuffer && pixelBuffer->IsShared();
+}
+
+bool odr::Image::Save(const std::string& filePath, const ImageSaveSettings& settings) const {
+    return ImageView(*this).Save(filePath, settings);
 }
 
 const odr::ImageDimensions& odr::Image::GetDimensions() const {
     return dimensions;
 }
 
+odr::PixelFormat odr::Image::GetPixelFormat() const {
+    return pixelFormat;
+}
+
+bool odr::Image::ConvertToPixelFormat(PixelFormat newPixelFormat) {
+    if (newPixelFormat == pixelFormat) {
+        return true;
+    }
+
+    if (!IsInitialized() || !DetachData()) {
+        return false;
+    }
+
+    ConvertPixelFormatSpan(imageBuffer, dimensions.Size(), pixelFormat, newPixelFormat);
+    pixelFormat = newPixelFormat;
+    contentId = NextContentId();
+
+    return true;
+}
+
+uint64_t odr::Image::GetContentId() const {
+    return contentId;
+}
+
+odr::ImageHash odr::Image::GetContentHash(InstructionSet maxInstructionSet) const {
+    std::shared_ptr<const CachedContentHash> computedContentHash = std::atomic_load(&contentHash);
+    if (computedContentHash && computedContentHash->contentId == contentId) {
+        return computedContentHash->hash;
+    }
+
+    // Threads hashing the same content at once compute the same hash, no lock is needed
+    const uint64_t seed =
+        (static_cast<uint64_t>(dimensions.width) | (static_cast<uint64_t>(dimensions.height) << 32)) ^
+        (pixelFormat == PixelFormat::Premultiplied ? PREMULTIPLIED_HASH_SEED : 0);
+    const ImageHash hash = HashBytes(imageBuffer, IsInitialized() ? dimensions.DataSize() : 0, seed, maxInstructionSet);
+
+    std::atomic_store(&contentHash, std::make_shared<const CachedContentHash>(CachedContentHash{ contentId, hash }));
+    return hash;
+}
+
+odr::ImageContentInfo odr::Image::GetContentInfo() const {
+    std::shared_ptr<const CachedContentInfo> computedContentInfo = std::atomic_load(&contentInfo);
+    if (computedContentInfo && computedContentInfo->contentId == contentId) {
+        return computedContentInfo->info;
+    }
+
+    // Like the hash, concurrent scans of the same content give the same info
+    const ImageContentInfo info = ScanContent(*this);
+
+    std::atomic_store(&contentInfo, std::make_shared<const CachedContentInfo>(CachedContentInfo{ contentId, info }));
+    return info;
+}
+
+void odr::Image::MarkContentChanged() {
+    contentId = NextContentId();
+}
+
 odr::PixelColor odr::Image::GetColor(const PixelCoordinates& coords) const {
     if (coords.left >= dimensions.width || coords.top >= dimensions.height) {
         return COLOR_TRANSPARENT;
     }
 
-    const uint32_t imageBufferPos = (coords.left + coords.top * dimensions.width) * 4;
+    const size_t imageBufferPos = coords.top * GetRowStride() + static_cast<size_t>(coords.left) * 4;
 
     const unsigned char r = imageBuffer[imageBufferPos + 0];
     const unsigned char g = imageBuffer[imageBufferPos + 1];
     const unsigned char b = imageBuffer[imageBufferPos + 2];
     const unsigned char a = imageBuffer[imageBufferPos + 3];
 
+    if (pixelFormat == PixelFormat::Premultiplied) {
+        return PixelColor::Unpremultiplied(PixelColor{ r, g, b, a });
+    }
+
     return PixelColor{ r, g, b, a };
 }
 
 bool odr::Image::SetColor(const PixelColor& color, const PixelCoordinates& coords) {
-    if (coords.left >= dimensions.width || coords.top >= dimensions.height) {
+    if (coords.left >= dimensions.width || coords.top >= dimensions.height || !DetachData()) {
+        return false;
+    }
+
+    const size_t imageBufferPos = coords.top * GetRowStride() + static_cast<size_t>(coords.left) * 4;
+
+    const PixelColor storedColor = pixelFormat == PixelFormat::Premultiplied
+        ? PixelColor::Premultiplied(color)
+        : color;
+
+    imageBuffer[imageBufferPos + 0] = storedColor.r;
+    imageBuffer[imageBufferPos + 1] = storedColor.g;
+    imageBuffer[imageBufferPos + 2] = storedColor.b;
+    imageBuffer[imageBufferPos + 3] = storedColor.a;
+    contentId = NextContentId();
+
+    return true;
+}
+
+bool odr::Image::Fill(const PixelColor& color) {
+    if (!IsInitialized() || !DetachData()) {
+        return false;
+    }
+
+    const PixelColor storedColor = pixelFormat == PixelFormat::Premultiplied
+        ? PixelColor::Premultiplied(color)
+        : color;
+
+    FillColorSpan(imageBuffer, storedColor, dimensions.Size());
+    contentId = NextContentId();
+
+    return true;
+}
+
+bool odr::Image::FillRect(const PixelRectangle& rectangle, const PixelColor& color) {
+    const PixelRectangle area = rectangle.Intersected(PixelRectangle{ { 0, 0 }, dimensions });
+    if (area.IsEmpty()) {
+        return true;
+    }
+
+    if (!DetachData()) {
         return false;
     }
 
-    const uint32_t imageBufferPos = (coords.left + coords.top * dimensions.width) * 4;
+    const PixelColor storedColor = pixelFormat == PixelFormat::Premultiplied
+        ? PixelColor::Premultiplied(color)
+        : color;
+
+    // The first row is filled, the others copied from it
+    const size_t rowSize = static_cast<size_t>(area.dimensions.width) * 4;
+    const unsigned char* firstRow = imageBuffer + area.position.top * GetRowStride() + area.position.left * 4;
+    FillColorSpan(imageBuffer + area.position.top * GetRowStride() + area.position.left * 4, storedColor, area.dimensions.width);
 
-    imageBuffer[imageBufferPos + 0] = color.r;
-    imageBuffer[imageBufferPos + 1] = color.g;
-    imageBuffer[imageBufferPos + 2] = color.b;
-    imageBuffer[imageBufferPos + 3] = color.a;
+    for (uint32_t y = area.position.top + 1; y < area.Bottom(); y++) {
+        std::memcpy(imageBuffer + y * GetRowStride() + area.position.left * 4, firstRow, rowSize);
+    }
+    contentId = NextContentId();
 
     return true;
 }
 
+bool odr::Image::CopyRect(const Image& source, const PixelRectangle& sourceRectangle, const PixelCoordinates& targetPosition) {
+    if (!source.IsInitialized()) {
+        return false;
+    }
+
+    // Clipped to the source and the target, the target area keeps its offset from the source area
+    const PixelRectangle sourceBoundedArea = sourceRectangle.Intersected(PixelRectangle{ { 0, 0 }, source.GetDimensions() });
+    const int64_t offsetX = static_cast<int64_t>(targetPosition.left) - sourceRectangle.position.left;
+    const int64_t offsetY = static_cast<int64_t>(targetPosition.top) - sourceRectangle.position.top;
+
+    const int64_t targetLeft = std::max<int64_t>(sourceBoundedArea.position.left + offsetX, 0);
+    const int64_t targetTop = std::max<int64_t>(sourceBoundedArea.position.top + offsetY, 0);
+    const int64_t targetRight = std::min<int64_t>(sourceBoundedArea.Right() + offsetX, dimensions.width);
+    const int64_t targetBottom = std::min<int64_t>(sourceBoundedArea.Bottom() + offsetY, dimensions.height);
+    if (targetLeft >= targetRight || targetTop >= targetBottom) {
+        return true;
+    }
+
+    const PixelRectangle targetArea{
+        { static_cast<uint32_t>(targetLeft), static_cast<uint32_t>(targetTop) },
+        { static_cast<uint32_t>(targetRight - targetLeft), static_cast<uint32_t>(targetBottom - targetTop) } };
+    const PixelCoordinates sourcePosition{ static_cast<uint32_t>(targetLeft - offsetX), static_cast<uint32_t>(targetTop - offsetY) };
+
+    if (!DetachData()) {
+        return false;
+    }
+
+    // Rows of overlapping areas of the same image are copied away from the overlap
+    const size_t rowSize = static_cast<size_t>(targetArea.dimensions.width) * 4;
+    const bool isBottomUp = &source == this && targetArea.position.top > sourcePosition.top;
+    for (uint32_t row = 0; row < targetArea.dimensions.height; row++) {
+        const uint32_t y = isBottomUp ? targetArea.dimensions.height - 1 - row : row;
+        unsigned char* targetPixels = imageBuffer + (targetArea.position.top + y) * GetRowStride() + targetArea.position.left * 4;
+        const unsigned char* sourcePixels = source.imageBuffer + (sourcePosition.top + y) * source.GetRowStride() + sourcePosition.left * 4;
+
+        std::memmove(targetPixels, sourcePixels, rowSize);
+        ConvertPixelFormatSpan(targetPixels, targetArea.dimensions.width, source.GetPixelFormat(), pixelFormat);
+    }
+    contentId = NextContentId();
+
+    return true;
+}
+
+size_t odr::Image::GetRowStride() const {
+    return static_cast<size_t>(dimensions.width) * 4;
+}
+
+const unsigned char* odr::Image::GetRowData(uint32_t top) const {
+    if (top >= dimensions.height || imageBuffer == nullptr) {
+        return nullptr;
+    }
+
+    return imageBuffer + top * GetRowStride();
+}
+
+unsigned char* odr::Image::GetRowData(uint32_t top) {
+    if (top >= dimensions.height || imageBuffer == nullptr || !DetachData()) {
+        return nullptr;
+    }
+
+    return imageBuffer + top * GetRowStride();
+}
+
 bool odr::Image::operator==(const Image& other) const {
     if (IsInitialized() != other.IsInitialized()) {
         return false;
     }
 
-    if (dimensions != other.GetDimensions()) {
+    if (dimensions != other.GetDimensions() || pixelFormat != other.GetPixelFormat()) {
+        return false;
+    }
+
+    // Hashes computed before tell different content apart without reading it
+    const std::shared_ptr<const CachedContentHash> thisContentHash = std::atomic_load(&contentHash);
+    const std::shared_ptr<const CachedContentHash> otherContentHash = std::atomic_load(&other.contentHash);
+    const bool isHashKnown =
+        thisContentHash && thisContentHash->contentId == contentId &&
+        otherContentHash && otherContentHash->contentId == other.contentId;
+    if (isHashKnown && thisContentHash->hash != otherContentHash->hash) {
         return false;
     }
 
-    if (memcmp(imageBuffer, other.imageBuffer, dimensions.DataSize()) != 0) {
+    if (imageBuffer != other.imageBuffer && memcmp(imageBuffer, other.imageBuffer, dimensions.DataSize()) != 0) {
         return false;
     }
 
     return true;
 }
 
-odr::Image odr::Image::Scaled(const ImageDimensions& newDimensions) const {
+odr::Image odr::Image::Scaled(const ImageDimensions& newDimensions, ResamplingFilter filter) const {
     Image scaledImage;
 
     if (dimensions == newDimensions) {
@@ -180,99 +603,107 @@ odr::Image odr::Image::Scaled(const ImageDimensions& newDimensions) const {
         return scaledImage;
     }
 
-    const bool isInitialized = scaledImage.Initialize(newDimensions, COLOR_TRANSPARENT);
-    if (!isInitialized) {
+    if (!IsInitialized()) {
         return scaledImage;
     }
 
-    const float scalingFactorX = static_cast<float>(newDimensions.width) / static_cast<float>(dimensions.width);
-    const float scalingFactorY = static_cast<float>(newDimensions.height) / static_cast<float>(dimensions.height);
-
-    const uint32_t boxWidth = static_cast<uint32_t>(std::ceil(1.0f / scalingFactorX));
-    const uint32_t boxHeight = static_cast<uint32_t>(std::ceil(1.0f / scalingFactorY));
-    const uint32_t boxSize = boxWidth * boxHeight;
-    const float boxSizeF = static_cast<float>(boxSize);
-
-    // Compute new colors for each pixel in the new image
-    for (uint32_t top = 0; top < newDimensions.height; top++) {
-        for (uint32_t left = 0; left < newDimensions.width; left++) {
-            const float oldXF = static_cast<float>(left) / scalingFactorX;
-            const float oldYF = static_cast<float>(top) / scalingFactorY;
-
-            // Box sampling
-            const uint32_t xBeg = static_cast<uint32_t>(oldXF);
-            const uint32_t yBeg = static_cast<uint32_t>(oldYF);
-            const uint32_t xEnd = std::min(xBeg + boxWidth, dimensions.width);
-            const uint32_t yEnd = std::min(yBeg + boxHeight, dimensions.height);
-
-            float rSum = 0.0f;
-            float gSum = 0.0f;
-            float bSum = 0.0f;
-            float aSum = 0.0f;
-
-            for (uint32_t y = yBeg; y < yEnd; y++) {
-                for (uint32_t x = xBeg; x < xEnd; x++) {
-                    const PixelColor color = GetColor(PixelCoordinates{ x, y });
-                    const float alphaF = static_cast<float>(color.a) / 255.0;
-                    rSum += static_cast<float>(color.r) * alphaF;
-                    gSum += static_cast<float>(color.g) * alphaF;
-                    bSum += static_cast<float>(color.b) * alphaF;
-                    aSum += color.a;
-                }
-            }
+    const ImageResampler resampler(*this, newDimensions, filter);
+    resampler.Resample(PixelRectangle{ { 0, 0 }, newDimensions }, scaledImage);
 
-            const PixelColor newPixelColor = PixelColor{
-                static_cast<unsigned char>(std::round(rSum / boxSizeF)),
-                static_cast<unsigned char>(std::round(gSum / boxSizeF)),
-                static_cast<unsigned char>(std::round(bSum / boxSizeF)),
-                static_cast<unsigned char>(std::round(aSum / boxSizeF)),
-            };
-
-            const PixelCoordinates newPixelCoordinates{ left, top };
-            const bool isSet = scaledImage.SetColor(newPixelColor, newPixelCoordinates);
-            if (!isSet) {
-                return scaledImage;
-            }
-        }
+    return scaledImage;
+}
+
+void odr::Image::SetMipmapsEnabled(bool isEnabled) {
+    isMipmapsEnabled = isEnabled;
+    if (!isMipmapsEnabled) {
+        DiscardMipmaps();
     }
+}
 
-    return scaledImage;
+bool odr::Image::IsMipmapsEnabled() const {
+    return isMipmapsEnabled;
+}
+
+void odr::Image::DiscardMipmaps() const {
+    std::atomic_store(&mipmaps, std::shared_ptr<const MipmapPyramid>());
 }
 
-/*static*/ odr::Image odr::Image::AbsoluteDiff(const Image& imageA, const Image& imageB) {
+size_t odr::Image::GetMipmapByteSize() const {
+    const std::shared_ptr<const MipmapPyramid> builtMipmaps = std::atomic_load(&mipmaps);
+    return builtMipmaps ? builtMipmaps->GetByteSize() : 0;
+}
+
+std::shared_ptr<const odr::MipmapPyramid> odr::Image::GetMipmaps() const {
+    std::shared_ptr<const MipmapPyramid> builtMipmaps = std::atomic_load(&mipmaps);
+    if (builtMipmaps && builtMipmaps->GetSourceContentId() == contentId) {
+        return builtMipmaps;
+    }
+
+    const std::lock_guard<std::mutex> lock(mipmapBuildMutex);
+    builtMipmaps = std::atomic_load(&mipmaps);
+    if (!builtMipmaps || builtMipmaps->GetSourceContentId() != contentId) {
+        builtMipmaps = std::make_shared<const MipmapPyramid>(*this);
+        std::atomic_store(&mipmaps, builtMipmaps);
+    }
+    return builtMipmaps;
+}
+
+/*static*/ odr::Image odr::Image::AbsoluteDiff(const ImageView& imageA, const ImageView& imageB) {
     Image diffImage;
+    Compare(imageA, imageB, ImageComparisonSettings(), &diffImage);
+    return diffImage;
+}
 
-    const ImageDimensions imageADims = imageA.GetDimensions();
-    const ImageDimensions imageBDims = imageB.GetDimensions();
-    const ImageDimensions diffImageDimensions{
-        std::max(imageADims.width, imageBDims.width),
-        std::max(imageADims.height, imageBDims.height)};
+/*static*/ odr::ImageComparison odr::Image::Compare(
+    const ImageView& imageA,
+    const ImageView& imageB,
+    const ImageComparisonSettings& settings,
+    Image* diffImage) {
+    ImageComparison comparison;
 
-    const bool isInitialized = diffImage.Initialize(diffImageDimensions, COLOR_TRANSPARENT);
-    if (!isInitialized) {
-        return diffImage;
+    const ImageDimensions dimensions{
+        std::max(imageA.GetDimensions().width, imageB.GetDimensions().width),
+        std::max(imageA.GetDimensions().height, imageB.GetDimensions().height) };
+
+    if (diffImage != nullptr && !diffImage->Initialize(dimensions, COLOR_TRANSPARENT)) {
+        diffImage->Clear();
     }
 
-    for (uint32_t top = 0; top < diffImageDimensions.height; top++) {
-        for (uint32_t left = 0; left < diffImageDimensions.width; left++) {
-            const PixelCoordinates coords{ left, top };
+    const DiffSpanFunction diffSpan = SelectDiffSpan(settings.maxInstructionSet);
+    DiffStatistics statistics;
+    std::vector<unsigned char> rowBufferA;
+    std::vector<unsigned char> rowBufferB;
+    uint32_t comparedRowCount = 0;
 
-            const bool isPixelInImageA = top < imageADims.width && top < imageADims.height;
-            const bool isPixelInImageB = top < imageBDims.width && top < imageBDims.height;
+    for (uint32_t top = 0; top < dimensions.height; top++) {
+        const unsigned char* rowA = StraightRow(imageA, top, dimensions.width, rowBufferA);
+        const unsigned char* rowB = StraightRow(imageB, top, dimensions.width, rowBufferB);
+        unsigned char* diffRow = diffImage != nullptr ? diffImage->GetRowData(top) : nullptr;
 
-            if (!isPixelInImageA) {
-                diffImage.SetColor(imageB.GetColor(coords), coords);
-            } else if (!isPixelInImageB) {
-                diffImage.SetColor(imageA.GetColor(coords), coords);
-            } else {
-                const PixelColor pixelColorA = imageA.GetColor(coords);
-                const PixelColor pixelColorB = imageB.GetColor(coords);
-                const PixelColor pixelColorDiff = PixelColor::AbsoluteDiff(pixelColorA, pixelColorB);
+        diffSpan(rowA, rowB, diffRow, dimensions.width, settings.tolerance, statistics);
+        comparedRowCount++;
 
-                diffImage.SetColor(pixelColorDiff, coords);
-            }
+        if (statistics.differentPixelCount > settings.maxDifferentPixelCount) {
+            break;
         }
     }
 
-    return diffImage;
+    if (diffImage != nullptr && diffImage->IsInitialized()) {
+        diffImage->MarkContentChanged();
+    }
+
+    comparison.pixelCount = static_cast<uint64_t>(comparedRowCount) * dimensions.width;
+    comparison.differentPixelCount = statistics.differentPixelCount;
+    comparison.maxChannelError = statistics.maxChannelError;
+    comparison.isComplete = comparedRowCount == dimensions.height;
+
+    const double channelCount = static_cast<double>(comparison.pixelCount) * 4.0;
+    const double meanSquaredError = channelCount > 0.0 ? static_cast<double>(statistics.squaredErrorSum) / channelCount : 0.0;
+    comparison.meanError = channelCount > 0.0 ? static_cast<double>(statistics.errorSum) / channelCount : 0.0;
+    comparison.rmsError = std::sqrt(meanSquaredError);
+    comparison.psnr = meanSquaredError > 0.0
+        ? 10.0 * std::log10(255.0 * 255.0 / meanSquaredError)
+        : std::numeric_limits<double>::infinity();
+
+    return comparison;
 }
@@ -0,0 +1,116 @@
+#include <OpenDesignRenderer/ImageAllocator.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <utility>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+namespace {
+    //! Innermost ImageAllocatorScope of the thread.
+    thread_local odr::ImageAllocatorScope* currentScope = nullptr;
+}
+
+odr::ImageAllocator::ImageAllocator() :
+    liveByteSize(0),
+    peakLiveByteSize(0),
+    allocationCount(0),
+    reusedAllocationCount(0) {
+}
+
+odr::ImageAllocator::~ImageAllocator() = default;
+
+void* odr::ImageAllocator::Allocate(size_t size) {
+    void* data = AllocateFromSystem(size);
+    if (data != nullptr) {
+        CountAllocation(size, false);
+    }
+    return data;
+}
+
+void odr::ImageAllocator::Deallocate(void* data, size_t size) {
+    if (data != nullptr) {
+        CountDeallocation(size);
+        DeallocateToSystem(data);
+    }
+}
+
+size_t odr::ImageAllocator::GetLiveByteSize() const {
+    return liveByteSize;
+}
+
+size_t odr::ImageAllocator::GetPeakLiveByteSize() const {
+    return peakLiveByteSize;
+}
+
+uint64_t odr::ImageAllocator::GetAllocationCount() const {
+    return allocationCount;
+}
+
+uint64_t odr::ImageAllocator::GetReusedAllocationCount() const {
+    return reusedAllocationCount;
+}
+
+double odr::ImageAllocator::GetReuseRate() const {
+    const uint64_t count = allocationCount;
+    return count > 0 ? static_cast<double>(reusedAllocationCount) / static_cast<double>(count) : 0.0;
+}
+
+/*static*/ std::shared_ptr<odr::ImageAllocator> odr::ImageAllocator::GetCurrent() {
+    return currentScope != nullptr ? currentScope->allocator : GetDefault();
+}
+
+/*static*/ const std::shared_ptr<odr::ImageAllocator>& odr::ImageAllocator::GetDefault() {
+    static const std::shared_ptr<ImageAllocator> defaultAllocator = std::make_shared<ImageAllocator>();
+    return defaultAllocator;
+}
+
+/*static*/ void* odr::ImageAllocator::AllocateFromSystem(size_t size) {
+    // Aligned allocation sizes must be multiples of the alignment
+    const size_t alignedSize = (std::max<size_t>(size, 1) + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+#ifdef _WIN32
+    return _aligned_malloc(alignedSize, ALIGNMENT);
+#else
+    return std::aligned_alloc(ALIGNMENT, alignedSize);
+#endif
+}
+
+/*static*/ void odr::ImageAllocator::DeallocateToSystem(void* data) {
+#ifdef _WIN32
+    _aligned_free(data);
+#else
+    std::free(data);
+#endif
+}
+
+void odr::ImageAllocator::CountAllocation(size_t size, bool isReused) {
+    const size_t newLiveByteSize = liveByteSize += size;
+
+    size_t peak = peakLiveByteSize;
+    while (newLiveByteSize > peak && !peakLiveByteSize.compare_exchange_weak(peak, newLiveByteSize)) {
+    }
+
+    allocationCount++;
+    if (isReused) {
+        reusedAllocationCount++;
+    }
+}
+
+void odr::ImageAllocator::CountDeallocation(size_t size) {
+    liveByteSize -= size;
+}
+
+odr::ImageAllocatorScope::ImageAllocatorScope(std::shared_ptr<ImageAllocator> allocator_) :
+    allocator(std::move(allocator_)),
+    outerScope(currentScope) {
+    if (!allocator) {
+        allocator = ImageAllocator::GetDefault();
+    }
+    currentScope = this;
+}
+
+odr::ImageAllocatorScope::~ImageAllocatorScope() {
+    currentScope = outerScope;
+}
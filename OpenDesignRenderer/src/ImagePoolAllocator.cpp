@@ -0,0 +1,85 @@
+#include <OpenDesignRenderer/ImagePoolAllocator.h>
+
+#include <algorithm>
+
+odr::ImagePoolAllocator::ImagePoolAllocator(size_t maxCachedByteSize_) :
+    maxCachedByteSize(maxCachedByteSize_) {
+}
+
+odr::ImagePoolAllocator::~ImagePoolAllocator() {
+    ReleaseCached();
+}
+
+void* odr::ImagePoolAllocator::Allocate(size_t size) {
+    const size_t sizeClass = GetSizeClass(size);
+
+    {
+        const std::lock_guard<std::mutex> lock(mutex);
+        const auto cachedBuffersIt = cachedBuffers.find(sizeClass);
+        if (cachedBuffersIt != cachedBuffers.end() && !cachedBuffersIt->second.empty()) {
+            void* data = cachedBuffersIt->second.back();
+            cachedBuffersIt->second.pop_back();
+            cachedByteSize -= sizeClass;
+
+            CountAllocation(sizeClass, true);
+            return data;
+        }
+    }
+
+    void* data = AllocateFromSystem(sizeClass);
+    if (data != nullptr) {
+        CountAllocation(sizeClass, false);
+    }
+    return data;
+}
+
+void odr::ImagePoolAllocator::Deallocate(void* data, size_t size) {
+    if (data == nullptr) {
+        return;
+    }
+
+    const size_t sizeClass = GetSizeClass(size);
+    CountDeallocation(sizeClass);
+
+    {
+        const std::lock_guard<std::mutex> lock(mutex);
+        if (cachedByteSize + sizeClass <= maxCachedByteSize) {
+            cachedBuffers[sizeClass].push_back(data);
+            cachedByteSize += sizeClass;
+            return;
+        }
+    }
+
+    DeallocateToSystem(data);
+}
+
+size_t odr::ImagePoolAllocator::GetCachedByteSize() const {
+    const std::lock_guard<std::mutex> lock(mutex);
+    return cachedByteSize;
+}
+
+void odr::ImagePoolAllocator::ReleaseCached() {
+    std::unordered_map<size_t, std::vector<void*>> releasedBuffers;
+    {
+        const std::lock_guard<std::mutex> lock(mutex);
+        releasedBuffers.swap(cachedBuffers);
+        cachedByteSize = 0;
+    }
+
+    for (const auto& sizeClassBuffers : releasedBuffers) {
+        for (void* data : sizeClassBuffers.second) {
+            DeallocateToSystem(data);
+        }
+    }
+}
+
+/*static*/ size_t odr::ImagePoolAllocator::GetSizeClass(size_t size) {
+    // Four classes between powers of two, multiples of the alignment
+    size_t powerOfTwo = ALIGNMENT;
+    while (powerOfTwo * 2 <= size && powerOfTwo * 2 > powerOfTwo) {
+        powerOfTwo *= 2;
+    }
+
+    const size_t step = std::max<size_t>(powerOfTwo / 4, ALIGNMENT);
+    return (std::max<size_t>(size, 1) + step - 1) / step * step;
+}
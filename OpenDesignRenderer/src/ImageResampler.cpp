@@ -0,0 +1,491 @@
+#include "ImageResampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include <OpenDesignRenderer/Image.h>
+#include <OpenDesignRenderer/PixelColor.h>
+
+#include "MipmapPyramid.h"
+
+namespace {
+    //! Rows of an area resampled at once by the separable filters, bounds their temporary filtered source rows.
+    //! The same height as the bands of CompositeScaledImage, so drawing resamples each band in one go.
+    constexpr uint32_t SEPARABLE_BAND_HEIGHT = 32;
+
+    //! Half width of the filter kernel in source pixels, when not downscaling.
+    double FilterRadius(odr::ResamplingFilter filter) {
+        switch (filter) {
+        case odr::ResamplingFilter::Bilinear:
+            return 1.0;
+        case odr::ResamplingFilter::Bicubic:
+            return 2.0;
+        case odr::ResamplingFilter::Lanczos3:
+            return 3.0;
+        case odr::ResamplingFilter::Box:
+        case odr::ResamplingFilter::SummedAreaBox:
+            break;
+        }
+        return 0.5;
+    }
+
+    //! Normalized sinc function.
+    double Sinc(double x) {
+        if (x == 0.0) {
+            return 1.0;
+        }
+        const double px = M_PI * x;
+        return std::sin(px) / px;
+    }
+
+    //! Filter kernel value at a distance from the sample center, in source pixels.
+    double FilterWeight(odr::ResamplingFilter filter, double x) {
+        x = std::abs(x);
+
+        switch (filter) {
+        case odr::ResamplingFilter::Bilinear:
+            return x < 1.0 ? 1.0 - x : 0.0;
+        case odr::ResamplingFilter::Bicubic:
+            // Catmull-Rom, a = -0.5
+            if (x < 1.0) {
+                return (1.5 * x - 2.5) * x * x + 1.0;
+            }
+            if (x < 2.0) {
+                return ((-0.5 * x + 2.5) * x - 4.0) * x + 2.0;
+            }
+            return 0.0;
+        case odr::ResamplingFilter::Lanczos3:
+            return x < 3.0 ? Sinc(x) * Sinc(x / 3.0) : 0.0;
+        case odr::ResamplingFilter::Box:
+        case odr::ResamplingFilter::SummedAreaBox:
+            break;
+        }
+        return x <= 0.5 ? 1.0 : 0.0;
+    }
+
+    //! Weights of the source pixels contributing to a range of scaled pixels, along one axis.
+    struct Contributions {
+        //! Number of weights per scaled pixel, the same for all of them.
+        uint32_t tapCount = 0;
+        //! First contributing source pixel of each scaled pixel.
+        std::vector<uint32_t> firsts;
+        //! tapCount weights of each scaled pixel, zero padded.
+        std::vector<float> weights;
+    };
+
+    //! Compute the contributions for scaled pixels <first, first + count).
+    Contributions ComputeContributions(
+        odr::ResamplingFilter filter,
+        uint32_t sourceSize,
+        uint32_t scaledSize,
+        uint32_t first,
+        uint32_t count) {
+        const double scale = static_cast<double>(scaledSize) / static_cast<double>(sourceSize);
+        // Downscaling widens the kernel to cover all source pixels, upscaling interpolates
+        const double filterScale = std::max(1.0 / scale, 1.0);
+        const double support = FilterRadius(filter) * filterScale;
+
+        Contributions contributions;
+        contributions.tapCount = static_cast<uint32_t>(std::min<double>(std::ceil(2.0 * support) + 1.0, sourceSize));
+        contributions.firsts.resize(count);
+        contributions.weights.assign(static_cast<size_t>(count) * contributions.tapCount, 0.0f);
+
+        std::vector<double> weights(contributions.tapCount);
+
+        for (uint32_t i = 0; i < count; i++) {
+            const double center = (static_cast<double>(first + i) + 0.5) / scale;
+
+            const int64_t beg = std::max<int64_t>(static_cast<int64_t>(std::floor(center - support)), 0);
+            const int64_t end = std::min<int64_t>(static_cast<int64_t>(std::ceil(center + support)), sourceSize);
+            // Same window size for every pixel, shifted inside the source
+            const uint32_t windowFirst = static_cast<uint32_t>(std::min<int64_t>(beg, sourceSize - contributions.tapCount));
+
+            double weightSum = 0.0;
+            for (uint32_t tap = 0; tap < contributions.tapCount; tap++) {
+                const int64_t sourcePixel = static_cast<int64_t>(windowFirst) + tap;
+                weights[tap] = sourcePixel >= beg && sourcePixel < end
+                    ? FilterWeight(filter, (static_cast<double>(sourcePixel) + 0.5 - center) / filterScale)
+                    : 0.0;
+                weightSum += weights[tap];
+            }
+
+            contributions.firsts[i] = windowFirst;
+            float* pixelWeights = contributions.weights.data() + static_cast<size_t>(i) * contributions.tapCount;
+
+            if (weightSum == 0.0) {
+                // Degenerate kernel, use the nearest source pixel
+                const int64_t nearest = std::min<int64_t>(static_cast<int64_t>(center), sourceSize - 1);
+                pixelWeights[nearest - windowFirst] = 1.0f;
+                continue;
+            }
+
+            for (uint32_t tap = 0; tap < contributions.tapCount; tap++) {
+                pixelWeights[tap] = static_cast<float>(weights[tap] / weightSum);
+            }
+        }
+
+        return contributions;
+    }
+
+    //! Source pixels <beg, end) covered by a scaled pixel along one axis, never empty.
+    struct SourceRange {
+        uint32_t beg;
+        uint32_t end;
+    };
+
+    //! Compute the source ranges of scaled pixels <first, first + count).
+    std::vector<SourceRange> ComputeSourceRanges(uint32_t sourceSize, uint32_t scaledSize, uint32_t first, uint32_t count) {
+        std::vector<SourceRange> ranges(count);
+
+        for (uint32_t i = 0; i < count; i++) {
+            const uint64_t scaledPixel = first + i;
+            const uint64_t beg = scaledPixel * sourceSize / scaledSize;
+            const uint64_t end = ((scaledPixel + 1) * sourceSize + scaledSize - 1) / scaledSize;
+            ranges[i] = SourceRange{ static_cast<uint32_t>(beg), static_cast<uint32_t>(std::max(end, beg + 1)) };
+        }
+
+        return ranges;
+    }
+
+    //! Round and clamp a filtered channel value.
+    unsigned char ToChannel(float value, float maxValue) {
+        return static_cast<unsigned char>(std::min(std::max(std::round(value), 0.0f), maxValue));
+    }
+}
+
+
+odr::ImageResampler::ImageResampler(
+    const Image& image,
+    const ImageDimensions& newDimensions_,
+    ResamplingFilter filter_,
+    bool isMipmapAllowed) :
+    mipmaps(FindMipmaps(image, newDimensions_, isMipmapAllowed)),
+    source(mipmaps && mipmaps->FindLevel(newDimensions_) ? *mipmaps->FindLevel(newDimensions_) : image),
+    newDimensions(newDimensions_),
+    filter(filter_) {
+    PrepareBoxFilter();
+}
+
+odr::ImageResampler::ImageResampler(
+    const ImageView& view,
+    const ImageDimensions& newDimensions_,
+    ResamplingFilter filter_) :
+    source(view),
+    newDimensions(newDimensions_),
+    filter(filter_) {
+    PrepareBoxFilter();
+}
+
+odr::ImageResampler::~ImageResampler() = default;
+
+/*static*/ std::shared_ptr<const odr::MipmapPyramid> odr::ImageResampler::FindMipmaps(
+    const Image& image,
+    const ImageDimensions& newDimensions,
+    bool isMipmapAllowed) {
+    const ImageDimensions& dimensions = image.GetDimensions();
+    const bool isHalvedOrSmaller = newDimensions.width <= dimensions.width / 2 && newDimensions.height <= dimensions.height / 2;
+
+    if (!isMipmapAllowed || !image.IsMipmapsEnabled() || !image.IsInitialized() || !isHalvedOrSmaller) {
+        return nullptr;
+    }
+    return image.GetMipmaps();
+}
+
+void odr::ImageResampler::PrepareBoxFilter() {
+    if (IsIdentity() || filter != ResamplingFilter::Box) {
+        return;
+    }
+
+    const ImageDimensions& dimensions = source.GetDimensions();
+
+    scalingFactorX = static_cast<float>(newDimensions.width) / static_cast<float>(dimensions.width);
+    scalingFactorY = static_cast<float>(newDimensions.height) / static_cast<float>(dimensions.height);
+
+    boxWidth = static_cast<uint32_t>(std::ceil(1.0f / scalingFactorX));
+    boxHeight = static_cast<uint32_t>(std::ceil(1.0f / scalingFactorY));
+}
+
+const odr::ImageView& odr::ImageResampler::GetSource() const {
+    return source;
+}
+
+const odr::ImageDimensions& odr::ImageResampler::GetDimensions() const {
+    return newDimensions;
+}
+
+bool odr::ImageResampler::IsIdentity() const {
+    return source.GetDimensions() == newDimensions;
+}
+
+void odr::ImageResampler::ResampleArea(const PixelRectangle& area, unsigned char* pixels, size_t rowStride) const {
+    if (area.IsEmpty()) {
+        return;
+    }
+
+    if (IsIdentity()) {
+        for (uint32_t y = 0; y < area.dimensions.height; y++) {
+            std::memcpy(
+                pixels + y * rowStride,
+                source.GetRowData(area.position.top + y) + area.position.left * 4,
+                area.dimensions.width * 4);
+        }
+        return;
+    }
+
+    if (filter == ResamplingFilter::SummedAreaBox) {
+        ResampleSummedAreaBox(area, pixels, rowStride);
+        return;
+    }
+
+    if (filter != ResamplingFilter::Box) {
+        ResampleSeparableArea(area, pixels, rowStride);
+        return;
+    }
+
+    for (uint32_t y = 0; y < area.dimensions.height; y++) {
+        ResampleBoxRow(area.position.top + y, area.position.left, area.dimensions.width, pixels + y * rowStride);
+    }
+}
+
+bool odr::ImageResampler::Resample(const PixelRectangle& area, Image& result) const {
+    if (!result.Initialize(area.dimensions, COLOR_TRANSPARENT, source.GetPixelFormat())) {
+        return false;
+    }
+
+    ResampleArea(area, result.GetRowData(0), static_cast<size_t>(area.dimensions.width) * 4);
+    return true;
+}
+
+void odr::ImageResampler::ResampleBoxRow(uint32_t top, uint32_t left, uint32_t pixelCount, unsigned char* pixels) const {
+    const ImageDimensions& dimensions = source.GetDimensions();
+    const bool isPremultiplied = source.GetPixelFormat() == PixelFormat::Premultiplied;
+
+    const float boxSizeF = static_cast<float>(boxWidth * boxHeight);
+
+    const float oldYF = static_cast<float>(top) / scalingFactorY;
+    const uint32_t yBeg = static_cast<uint32_t>(oldYF);
+    const uint32_t yEnd = std::min(yBeg + boxHeight, dimensions.height);
+
+    for (uint32_t column = left; column < left + pixelCount; column++, pixels += 4) {
+        const float oldXF = static_cast<float>(column) / scalingFactorX;
+
+        // Box sampling
+        const uint32_t xBeg = static_cast<uint32_t>(oldXF);
+        const uint32_t xEnd = std::min(xBeg + boxWidth, dimensions.width);
+
+        // Premultiplied colors are averaged directly, over the pixels actually inside the image
+        if (isPremultiplied) {
+            uint32_t sums[4] = { 0, 0, 0, 0 };
+
+            for (uint32_t y = yBeg; y < yEnd; y++) {
+                const unsigned char* pixel = source.GetRowData(y) + xBeg * 4;
+                for (uint32_t x = xBeg; x < xEnd; x++, pixel += 4) {
+                    sums[0] += pixel[0];
+                    sums[1] += pixel[1];
+                    sums[2] += pixel[2];
+                    sums[3] += pixel[3];
+                }
+            }
+
+            const uint32_t pixelCountInBox = std::max((xEnd - xBeg) * (yEnd - yBeg), 1u);
+            for (uint32_t channel = 0; channel < 4; channel++) {
+                pixels[channel] = static_cast<unsigned char>((sums[channel] + pixelCountInBox / 2) / pixelCountInBox);
+            }
+
+            continue;
+        }
+
+        float rSum = 0.0f;
+        float gSum = 0.0f;
+        float bSum = 0.0f;
+        float aSum = 0.0f;
+
+        for (uint32_t y = yBeg; y < yEnd; y++) {
+            const unsigned char* pixel = source.GetRowData(y) + xBeg * 4;
+            for (uint32_t x = xBeg; x < xEnd; x++, pixel += 4) {
+                const float alphaF = static_cast<float>(pixel[3]) / 255.0;
+                rSum += static_cast<float>(pixel[0]) * alphaF;
+                gSum += static_cast<float>(pixel[1]) * alphaF;
+                bSum += static_cast<float>(pixel[2]) * alphaF;
+                aSum += pixel[3];
+            }
+        }
+
+        pixels[0] = static_cast<unsigned char>(std::round(rSum / boxSizeF));
+        pixels[1] = static_cast<unsigned char>(std::round(gSum / boxSizeF));
+        pixels[2] = static_cast<unsigned char>(std::round(bSum / boxSizeF));
+        pixels[3] = static_cast<unsigned char>(std::round(aSum / boxSizeF));
+    }
+}
+
+void odr::ImageResampler::ResampleSummedAreaBox(const PixelRectangle& area, unsigned char* pixels, size_t rowStride) const {
+    const ImageDimensions& dimensions = source.GetDimensions();
+    const bool isPremultiplied = source.GetPixelFormat() == PixelFormat::Premultiplied;
+    const uint32_t width = area.dimensions.width;
+
+    const std::vector<SourceRange> columns = ComputeSourceRanges(dimensions.width, newDimensions.width, area.position.left, width);
+    const std::vector<SourceRange> rows = ComputeSourceRanges(dimensions.height, newDimensions.height, area.position.top, area.dimensions.height);
+
+    // Source columns touched by the area, the ranges only move forward
+    const uint32_t sourceLeft = columns.front().beg;
+    const uint32_t sourceWidth = columns.back().end - sourceLeft;
+
+    // Premultiplied channel sums of every source column over the window rows <windowTop, windowBottom)
+    std::vector<uint64_t> columnSums(static_cast<size_t>(sourceWidth) * 4, 0);
+    // Prefix sums of columnSums, one row of the summed-area table of the window
+    std::vector<uint64_t> areaSums((static_cast<size_t>(sourceWidth) + 1) * 4, 0);
+
+    const auto accumulateRow = [&](uint32_t sourceY, bool isAdded) {
+        const unsigned char* sourcePixel = source.GetRowData(sourceY) + sourceLeft * 4;
+        uint64_t* columnSum = columnSums.data();
+
+        for (uint32_t x = 0; x < sourceWidth; x++, sourcePixel += 4, columnSum += 4) {
+            const uint64_t alpha = sourcePixel[3];
+            const uint64_t channels[4] = {
+                isPremultiplied ? sourcePixel[0] : sourcePixel[0] * alpha,
+                isPremultiplied ? sourcePixel[1] : sourcePixel[1] * alpha,
+                isPremultiplied ? sourcePixel[2] : sourcePixel[2] * alpha,
+                alpha,
+            };
+
+            for (uint32_t channel = 0; channel < 4; channel++) {
+                // Unsigned wrap-around, only rows added before are subtracted
+                columnSum[channel] = isAdded ? columnSum[channel] + channels[channel] : columnSum[channel] - channels[channel];
+            }
+        }
+    };
+
+    uint32_t windowTop = rows.front().beg;
+    uint32_t windowBottom = windowTop;
+
+    for (uint32_t y = 0; y < area.dimensions.height; y++) {
+        // Slide the window, every source row is added and removed at most once
+        for (; windowBottom < rows[y].end; windowBottom++) {
+            accumulateRow(windowBottom, true);
+        }
+        for (; windowTop < rows[y].beg; windowTop++) {
+            accumulateRow(windowTop, false);
+        }
+
+        for (size_t i = 0; i < columnSums.size(); i++) {
+            areaSums[i + 4] = areaSums[i] + columnSums[i];
+        }
+
+        unsigned char* pixel = pixels + y * rowStride;
+        const uint64_t rowCount = rows[y].end - rows[y].beg;
+
+        for (uint32_t x = 0; x < width; x++, pixel += 4) {
+            const uint64_t* begSums = areaSums.data() + static_cast<size_t>(columns[x].beg - sourceLeft) * 4;
+            const uint64_t* endSums = areaSums.data() + static_cast<size_t>(columns[x].end - sourceLeft) * 4;
+            const uint64_t pixelCountInBox = (columns[x].end - columns[x].beg) * rowCount;
+            const uint64_t alphaSum = endSums[3] - begSums[3];
+
+            pixel[3] = static_cast<unsigned char>((alphaSum + pixelCountInBox / 2) / pixelCountInBox);
+
+            for (uint32_t channel = 0; channel < 3; channel++) {
+                const uint64_t sum = endSums[channel] - begSums[channel];
+
+                if (isPremultiplied) {
+                    pixel[channel] = static_cast<unsigned char>((sum + pixelCountInBox / 2) / pixelCountInBox);
+                }
+                else {
+                    // Alpha weighted average of the straight colors
+                    pixel[channel] = alphaSum > 0 && pixel[3] > 0
+                        ? static_cast<unsigned char>((sum + alphaSum / 2) / alphaSum)
+                        : 0;
+                }
+            }
+        }
+    }
+}
+
+void odr::ImageResampler::ResampleSeparableArea(const PixelRectangle& area, unsigned char* pixels, size_t rowStride) const {
+    const ImageDimensions& dimensions = source.GetDimensions();
+    const bool isPremultiplied = source.GetPixelFormat() == PixelFormat::Premultiplied;
+    const uint32_t width = area.dimensions.width;
+
+    const Contributions columns = ComputeContributions(filter, dimensions.width, newDimensions.width, area.position.left, width);
+    const Contributions rows = ComputeContributions(filter, dimensions.height, newDimensions.height, area.position.top, area.dimensions.height);
+
+    // Source columns touched by the area, the windows only move forward
+    const uint32_t sourceLeft = columns.firsts.front();
+    const uint32_t sourceRight = columns.firsts.back() + columns.tapCount;
+
+    std::vector<float> sourceRow((sourceRight - sourceLeft) * 4);
+    std::vector<float> filteredRows;
+    std::vector<float> sums(static_cast<size_t>(width) * 4);
+
+    // Bands of area rows, only the source rows of one band are filtered and kept at once
+    for (uint32_t bandTop = 0; bandTop < area.dimensions.height; bandTop += SEPARABLE_BAND_HEIGHT) {
+        const uint32_t bandBottom = std::min(bandTop + SEPARABLE_BAND_HEIGHT, area.dimensions.height);
+        const uint32_t sourceTop = rows.firsts[bandTop];
+        const uint32_t sourceBottom = rows.firsts[bandBottom - 1] + rows.tapCount;
+
+        // Horizontal pass: every source row touched by the band filtered to the area columns, premultiplied
+        filteredRows.resize(static_cast<size_t>(sourceBottom - sourceTop) * width * 4);
+
+        for (uint32_t sourceY = sourceTop; sourceY < sourceBottom; sourceY++) {
+            const unsigned char* sourcePixel = source.GetRowData(sourceY) + sourceLeft * 4;
+            for (uint32_t x = 0; x < sourceRight - sourceLeft; x++, sourcePixel += 4) {
+                const float alphaF = isPremultiplied ? 1.0f : static_cast<float>(sourcePixel[3]) / 255.0f;
+                sourceRow[x * 4 + 0] = static_cast<float>(sourcePixel[0]) * alphaF;
+                sourceRow[x * 4 + 1] = static_cast<float>(sourcePixel[1]) * alphaF;
+                sourceRow[x * 4 + 2] = static_cast<float>(sourcePixel[2]) * alphaF;
+                sourceRow[x * 4 + 3] = static_cast<float>(sourcePixel[3]);
+            }
+
+            float* filteredPixel = filteredRows.data() + static_cast<size_t>(sourceY - sourceTop) * width * 4;
+            for (uint32_t x = 0; x < width; x++, filteredPixel += 4) {
+                const float* weights = columns.weights.data() + static_cast<size_t>(x) * columns.tapCount;
+                const float* tapPixel = sourceRow.data() + (columns.firsts[x] - sourceLeft) * 4;
+
+                float tapSums[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+                for (uint32_t tap = 0; tap < columns.tapCount; tap++, tapPixel += 4) {
+                    tapSums[0] += weights[tap] * tapPixel[0];
+                    tapSums[1] += weights[tap] * tapPixel[1];
+                    tapSums[2] += weights[tap] * tapPixel[2];
+                    tapSums[3] += weights[tap] * tapPixel[3];
+                }
+                std::copy(tapSums, tapSums + 4, filteredPixel);
+            }
+        }
+
+        // Vertical pass: combine the filtered rows, back to the source pixel format
+        for (uint32_t y = bandTop; y < bandBottom; y++) {
+            const float* weights = rows.weights.data() + static_cast<size_t>(y) * rows.tapCount;
+            const float* filteredRow = filteredRows.data() + static_cast<size_t>(rows.firsts[y] - sourceTop) * width * 4;
+
+            std::fill(sums.begin(), sums.end(), 0.0f);
+            for (uint32_t tap = 0; tap < rows.tapCount; tap++, filteredRow += width * 4) {
+                for (size_t i = 0; i < sums.size(); i++) {
+                    sums[i] += weights[tap] * filteredRow[i];
+                }
+            }
+
+            unsigned char* pixel = pixels + y * rowStride;
+            for (uint32_t x = 0; x < width; x++, pixel += 4) {
+                const float* sum = sums.data() + x * 4;
+                pixel[3] = ToChannel(sum[3], 255.0f);
+
+                if (pixel[3] == 0) {
+                    pixel[0] = pixel[1] = pixel[2] = 0;
+                }
+                else if (isPremultiplied) {
+                    // Overshooting kernels must not produce colors brighter than the alpha
+                    const float maxValue = static_cast<float>(pixel[3]);
+                    pixel[0] = ToChannel(sum[0], maxValue);
+                    pixel[1] = ToChannel(sum[1], maxValue);
+                    pixel[2] = ToChannel(sum[2], maxValue);
+                }
+                else {
+                    const float unpremultiply = 255.0f / sum[3];
+                    pixel[0] = ToChannel(sum[0] * unpremultiply, 255.0f);
+                    pixel[1] = ToChannel(sum[1] * unpremultiply, 255.0f);
+                    pixel[2] = ToChannel(sum[2] * unpremultiply, 255.0f);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+
+#include <OpenDesignRenderer/ImageDimensions.h>
+#include <OpenDesignRenderer/ImageView.h>
+#include <OpenDesignRenderer/PixelRectangle.h>
+#include <OpenDesignRenderer/ResamplingFilter.h>
+
+// Forward declarations
+namespace odr {
+class Image;
+class MipmapPyramid;
+}
+
+namespace odr {
+/*!
+    \brief Computes pixels of an image scaled to new dimensions on demand, see Image::Scaled.
+    \note Any area of the scaled image can be computed without computing the rest, the results are identical
+        to the corresponding pixels of Image::Scaled.
+        The Box filter is the original per-pixel box average. SummedAreaBox keeps running column sums over a
+        sliding window of source rows and their prefix sums, so every pixel is a difference of two sums.
+        The other filters are separable: contribution tables are computed once per area, a horizontal pass
+        filters the contiguous source rows and a vertical pass combines the filtered rows. Colors are filtered
+        premultiplied, so transparent pixels do not bleed.
+        Downscales of images with mipmaps enabled start from the smallest mipmap level at least as large as the
+        scaled image, see Image::SetMipmapsEnabled.
+*/
+class ImageResampler {
+public:
+    /*!
+        \brief Prepare scaling of an initialized image. The image must outlive the resampler.
+        \param isMipmapAllowed Use a mipmap level of the image when its mipmaps are enabled.
+    */
+    ImageResampler(
+        const Image& image,
+        const ImageDimensions& newDimensions,
+        ResamplingFilter filter = ResamplingFilter::Box,
+        bool isMipmapAllowed = true);
+    //! Prepare scaling of viewed pixels, see ImageView. The viewed pixels must outlive the resampler.
+    ImageResampler(
+        const ImageView& view,
+        const ImageDimensions& newDimensions,
+        ResamplingFilter filter = ResamplingFilter::Box);
+    ~ImageResampler();
+
+    //! The pixels the scaled pixels are computed from - the scaled image or view, or one of the image's mipmap levels.
+    const ImageView& GetSource() const;
+
+    //! Dimensions of the scaled image.
+    const ImageDimensions& GetDimensions() const;
+    //! Detect if the scaled image is identical to the source image.
+    bool IsIdentity() const;
+
+    /*!
+        \brief Compute an area of the scaled image, in the pixel format of the source image.
+        \param area The area of the scaled image, must lie inside it.
+        \param pixels Receives the rows of RGBA pixels of the area.
+        \param rowStride Distance between the starts of the rows in pixels, in bytes.
+    */
+    void ResampleArea(const PixelRectangle& area, unsigned char* pixels, size_t rowStride) const;
+
+    //! Compute an area of the scaled image into a new image, in the pixel format of the source image.
+    bool Resample(const PixelRectangle& area, Image& result) const;
+
+private:
+    //! Mipmap pyramid of an image to downscale from, nullptr when no level can be used.
+    static std::shared_ptr<const MipmapPyramid> FindMipmaps(const Image& image, const ImageDimensions& newDimensions, bool isMipmapAllowed);
+
+    //! Compute the box filter size, once the source is known.
+    void PrepareBoxFilter();
+    //! Box filter of a span of one row of the scaled image.
+    void ResampleBoxRow(uint32_t top, uint32_t left, uint32_t pixelCount, unsigned char* pixels) const;
+    //! Summed-area box filter of an area.
+    void ResampleSummedAreaBox(const PixelRectangle& area, unsigned char* pixels, size_t rowStride) const;
+    //! Separable filter of an area.
+    void ResampleSeparableArea(const PixelRectangle& area, unsigned char* pixels, size_t rowStride) const;
+
+    //! Keeps the mipmap level used as the source alive.
+    std::shared_ptr<const MipmapPyramid> mipmaps;
+    ImageView source;
+    ImageDimensions newDimensions;
+    ResamplingFilter filter;
+
+    float scalingFactorX = 1.0f;
+    float scalingFactorY = 1.0f;
+    //! Box filter size in source pixels.
+    uint32_t boxWidth = 1;
+    uint32_t boxHeight = 1;
+};
+}
@@ -0,0 +1,144 @@
+#include <OpenDesignRenderer/ImageView.h>
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include <OpenDesignRenderer/Image.h>
+#include <OpenDesignRenderer/PixelColor.h>
+
+#include "FileWriter.h"
+#include "ImageResampler.h"
+#include "PixelFormatConversion.h"
+#include "RgbaBitmap.h"
+
+namespace {
+    //! Size of the chunks of converted pixels written by Save, in bytes.
+    constexpr size_t SAVE_CHUNK_SIZE = 256 * 1024;
+}
+
+odr::ImageView::ImageView() = default;
+
+odr::ImageView::ImageView(
+    const unsigned char* data_,
+    const ImageDimensions& dimensions_,
+    size_t rowStride_,
+    PixelFormat pixelFormat_) :
+    data(data_),
+    dimensions(data_ != nullptr ? dimensions_ : IMAGE_DIMENSIONS_EMPTY),
+    rowStride(rowStride_),
+    pixelFormat(pixelFormat_) {
+}
+
+odr::ImageView::ImageView(const Image& image) :
+    ImageView(image.GetRowData(0), image.GetDimensions(), image.GetRowStride(), image.GetPixelFormat()) {
+}
+
+odr::ImageView::ImageView(const Image& image, const PixelRectangle& rectangle) :
+    ImageView(ImageView(image).Subview(rectangle)) {
+}
+
+odr::ImageView odr::ImageView::Subview(const PixelRectangle& rectangle) const {
+    const PixelRectangle area = rectangle.Intersected(PixelRectangle{ { 0, 0 }, dimensions });
+    if (area.IsEmpty()) {
+        return ImageView();
+    }
+
+    return ImageView(
+        data + area.position.top * rowStride + area.position.left * 4,
+        area.dimensions,
+        rowStride,
+        pixelFormat);
+}
+
+bool odr::ImageView::IsInitialized() const {
+    return data != nullptr && dimensions.width > 0 && dimensions.height > 0;
+}
+
+const odr::ImageDimensions& odr::ImageView::GetDimensions() const {
+    return dimensions;
+}
+
+odr::PixelFormat odr::ImageView::GetPixelFormat() const {
+    return pixelFormat;
+}
+
+size_t odr::ImageView::GetRowStride() const {
+    return rowStride;
+}
+
+odr::PixelColor odr::ImageView::GetColor(const PixelCoordinates& coords) const {
+    if (coords.left >= dimensions.width || coords.top >= dimensions.height || data == nullptr) {
+        return COLOR_TRANSPARENT;
+    }
+
+    const unsigned char* pixel = GetRowData(coords.top) + coords.left * 4;
+    const PixelColor color{ pixel[0], pixel[1], pixel[2], pixel[3] };
+
+    if (pixelFormat == PixelFormat::Premultiplied) {
+        return PixelColor::Unpremultiplied(color);
+    }
+
+    return color;
+}
+
+const unsigned char* odr::ImageView::GetRowData(uint32_t top) const {
+    if (top >= dimensions.height || data == nullptr) {
+        return nullptr;
+    }
+
+    return data + top * rowStride;
+}
+
+odr::Image odr::ImageView::Scaled(const ImageDimensions& newDimensions, ResamplingFilter filter) const {
+    Image scaledImage;
+
+    if (!IsInitialized() || newDimensions.width == 0 || newDimensions.height == 0) {
+        return scaledImage;
+    }
+
+    // Identical dimensions copy the viewed rows
+    const ImageResampler resampler(*this, newDimensions, filter);
+    resampler.Resample(PixelRectangle{ { 0, 0 }, newDimensions }, scaledImage);
+
+    return scaledImage;
+}
+
+bool odr::ImageView::Save(const std::string& filePath, const ImageSaveSettings& settings) const {
+    if (!IsInitialized()) {
+        return false;
+    }
+
+    unsigned char header[12];
+    RgbaBitmap::EncodeHeader(header, dimensions.width, dimensions.height);
+
+    FileWriter writer;
+    if (!writer.Open(filePath, settings) || !writer.Write(header, sizeof(header))) {
+        return false;
+    }
+
+    const size_t rowSize = static_cast<size_t>(dimensions.width) * 4;
+
+    // Contiguous straight alpha rows, e.g. a whole image, are written at once
+    if (pixelFormat == PixelFormat::Straight && rowStride == rowSize) {
+        return writer.Write(data, dimensions.DataSize()) && writer.Close();
+    }
+
+    // Otherwise gathered and converted to straight alpha by chunks of whole rows
+    const uint32_t chunkRowCount = static_cast<uint32_t>(std::max<size_t>(SAVE_CHUNK_SIZE / rowSize, 1));
+    std::vector<unsigned char> chunk(std::min(chunkRowCount, dimensions.height) * rowSize);
+
+    for (uint32_t top = 0; top < dimensions.height; top += chunkRowCount) {
+        const uint32_t rowCount = std::min(chunkRowCount, dimensions.height - top);
+        for (uint32_t y = 0; y < rowCount; y++) {
+            std::memcpy(chunk.data() + y * rowSize, GetRowData(top + y), rowSize);
+        }
+        ConvertPixelFormatSpan(chunk.data(), rowCount * dimensions.width, pixelFormat, PixelFormat::Straight);
+
+        if (!writer.Write(chunk.data(), rowCount * rowSize)) {
+            return false;
+        }
+    }
+
+    return writer.Close();
+}
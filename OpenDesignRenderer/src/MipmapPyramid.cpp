@@ -0,0 +1,62 @@
+#include "MipmapPyramid.h"
+
+#include <OpenDesignRenderer/Image.h>
+#include <OpenDesignRenderer/PixelRectangle.h>
+
+#include "ImageResampler.h"
+
+odr::MipmapPyramid::MipmapPyramid(const Image& image) :
+    sourceContentId(image.GetContentId()) {
+    const Image* previousLevel = &image;
+
+    // Halving only the longer side of an elongated image would add up to its whole size, the levels stop at a side of 1
+    while (
+        previousLevel->IsInitialized() &&
+        previousLevel->GetDimensions().width > 1 &&
+        previousLevel->GetDimensions().height > 1) {
+        const ImageDimensions& previousDimensions = previousLevel->GetDimensions();
+        const ImageDimensions levelDimensions{ previousDimensions.width / 2, previousDimensions.height / 2 };
+
+        // Exact area average, at even dimensions the premultiplied average of 2x2 pixels
+        auto level = std::make_unique<Image>();
+        const ImageResampler resampler(*previousLevel, levelDimensions, ResamplingFilter::SummedAreaBox, false);
+        if (!resampler.Resample(PixelRectangle{ { 0, 0 }, levelDimensions }, *level)) {
+            break;
+        }
+
+        levels.push_back(std::move(level));
+        previousLevel = levels.back().get();
+    }
+}
+
+odr::MipmapPyramid::~MipmapPyramid() = default;
+
+uint64_t odr::MipmapPyramid::GetSourceContentId() const {
+    return sourceContentId;
+}
+
+size_t odr::MipmapPyramid::GetLevelCount() const {
+    return levels.size();
+}
+
+size_t odr::MipmapPyramid::GetByteSize() const {
+    size_t byteSize = 0;
+    for (const std::unique_ptr<Image>& level : levels) {
+        byteSize += level->GetDimensions().DataSize();
+    }
+    return byteSize;
+}
+
+const odr::Image* odr::MipmapPyramid::FindLevel(const ImageDimensions& dimensions) const {
+    const Image* foundLevel = nullptr;
+
+    for (const std::unique_ptr<Image>& level : levels) {
+        const ImageDimensions& levelDimensions = level->GetDimensions();
+        if (levelDimensions.width < dimensions.width || levelDimensions.height < dimensions.height) {
+            break;
+        }
+        foundLevel = level.get();
+    }
+
+    return foundLevel;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <vector>
+
+#include <OpenDesignRenderer/ImageDimensions.h>
+
+// Forward declarations
+namespace odr {
+class Image;
+}
+
+namespace odr {
+/*!
+    \brief Chain of successively halved copies of an image, used to start large downscales from a smaller source.
+    \note Every level halves both dimensions of the previous one (rounded down), each pixel the premultiplied
+        average of the covered 2x2 pixels. Halving stops once either dimension is 1, so every level takes at most
+        a quarter of the previous one and all levels together at most a third of the image memory, also for
+        elongated images. The levels keep the pixel format of the image.
+*/
+class MipmapPyramid {
+public:
+    //! Build all levels of an initialized image.
+    explicit MipmapPyramid(const Image& image);
+    ~MipmapPyramid();
+
+    MipmapPyramid(const MipmapPyramid&) = delete;
+    MipmapPyramid& operator=(const MipmapPyramid&) = delete;
+
+    //! Content identifier of the image the levels were built from, see Image::GetContentId.
+    uint64_t GetSourceContentId() const;
+    //! Number of levels, not counting the image itself.
+    size_t GetLevelCount() const;
+    //! Memory taken by the pixels of all levels, in bytes.
+    size_t GetByteSize() const;
+
+    //! The smallest level at least as large as the dimensions in both directions, nullptr if there is none.
+    const Image* FindLevel(const ImageDimensions& dimensions) const;
+
+private:
+    uint64_t sourceContentId;
+    //! Levels from the largest one.
+    std::vector<std::unique_ptr<Image>> levels;
+};
+}
@@ -0,0 +1,67 @@
+#include "PixelBuffer.h"
+
+#include <utility>
+
+#include <OpenDesignRenderer/ImageAllocator.h>
+
+#include "FileMapping.h"
+
+/*static*/ std::shared_ptr<odr::PixelBuffer> odr::PixelBuffer::Allocate(size_t size) {
+    std::shared_ptr<ImageAllocator> allocator = ImageAllocator::GetCurrent();
+    unsigned char* data = static_cast<unsigned char*>(allocator->Allocate(size));
+    if (data == nullptr) {
+        return nullptr;
+    }
+
+    return std::shared_ptr<PixelBuffer>(new PixelBuffer(data, size, std::move(allocator)));
+}
+
+/*static*/ std::shared_ptr<odr::PixelBuffer> odr::PixelBuffer::MapFile(const std::string& filepath) {
+    size_t size = 0;
+    unsigned char* data = odr::MapFile(filepath, size);
+    if (data == nullptr) {
+        return nullptr;
+    }
+
+    return std::shared_ptr<PixelBuffer>(new PixelBuffer(data, size, nullptr));
+}
+
+odr::PixelBuffer::PixelBuffer(unsigned char* data_, size_t size_, std::shared_ptr<ImageAllocator> allocator_) :
+    data(data_),
+    size(size_),
+    allocator(std::move(allocator_)),
+    ownerCount(0) {
+}
+
+odr::PixelBuffer::~PixelBuffer() {
+    if (allocator) {
+        allocator->Deallocate(data, size);
+    } else {
+        UnmapFile(data, size);
+    }
+}
+
+unsigned char* odr::PixelBuffer::GetData() const {
+    return data;
+}
+
+size_t odr::PixelBuffer::GetSize() const {
+    return size;
+}
+
+bool odr::PixelBuffer::IsFileMapped() const {
+    return !allocator;
+}
+
+void odr::PixelBuffer::AddOwner() {
+    // The new owner is given the buffer by an existing one, no ordering is needed
+    ownerCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+void odr::PixelBuffer::RemoveOwner() {
+    ownerCount.fetch_sub(1, std::memory_order_release);
+}
+
+bool odr::PixelBuffer::IsShared() const {
+    return ownerCount.load(std::memory_order_acquire) > 1;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <stddef.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+
+// Forward declarations
+namespace odr {
+class ImageAllocator;
+}
+
+namespace odr {
+/*!
+    \brief Memory holding the data of one or more images, see Image::CloneFrom.
+    \note Kept alive by std::shared_ptr. The images using the data are counted separately as owners, with the
+        memory ordering copy-on-write needs: an image that finds itself the only owner sees all accesses of the
+        former owners completed, even when they ran on other threads. Images copy a shared buffer before changing it.
+*/
+class PixelBuffer {
+public:
+    //! Allocate uninitialized memory from the current image allocator, see ImageAllocator::GetCurrent. nullptr on failure.
+    static std::shared_ptr<PixelBuffer> Allocate(size_t size);
+    //! Map a whole file as a private copy-on-write mapping, see MapFile. nullptr on failure.
+    static std::shared_ptr<PixelBuffer> MapFile(const std::string& filepath);
+
+    ~PixelBuffer();
+
+    PixelBuffer(const PixelBuffer&) = delete;
+    PixelBuffer& operator=(const PixelBuffer&) = delete;
+
+    //! Start of the memory.
+    unsigned char* GetData() const;
+    //! Size of the memory in bytes.
+    size_t GetSize() const;
+    //! Detect if the memory is a mapped file.
+    bool IsFileMapped() const;
+
+    //! Count an image as an owner of the memory. Called by an image given the buffer by its creator or another owner.
+    void AddOwner();
+    //! Stop counting an image as an owner, after its last access to the memory. Releases its accesses, see IsShared.
+    void RemoveOwner();
+    /*!
+        \brief Detect if the memory has more than one owner.
+        \note Acquires the accesses of the removed owners: when false, the only owner may change the memory in place.
+    */
+    bool IsShared() const;
+
+private:
+    PixelBuffer(unsigned char* data, size_t size, std::shared_ptr<ImageAllocator> allocator);
+
+    unsigned char* data;
+    size_t size;
+    //! The allocator of the data, nullptr for mapped files.
+    std::shared_ptr<ImageAllocator> allocator;
+    //! Number of images using the memory, see AddOwner.
+    std::atomic<uint32_t> ownerCount;
+};
+}
@@ -1,6 +1,9 @@
 #include <OpenDesignRenderer/PixelColor.h>
 
 #include <cmath>
+#include <vector>
+
+#include "BlendSpan.h"
 
 namespace {
     //! Convert an unsigned char value in the range <0, 255> to <0.0, 1.0>
@@ -19,6 +22,13 @@ namespace {
             return static_cast<unsigned char>(std::round(value * 255.0));
         }
     }
+    //! Largest sum of blending weights, 255 * 255.
+    constexpr uint32_t MAX_BLEND_WEIGHT = 255u * 255u;
+    //! Compute value / 255 rounded to the nearest integer, exact for value in <0, 255*255>.
+    inline unsigned char Div255(uint32_t value) {
+        value += 128u;
+        return static_cast<unsigned char>((value + (value >> 8)) >> 8);
+    }
     //! Compute the absolute difference between unsigned chars.
     inline unsigned char UCharAbsoluteDiff(unsigned char charA, unsigned char charB) {
         return charA >= charB
@@ -82,6 +92,98 @@ bool odr::PixelColor::operator==(const PixelColor& other) const {
     };
 }
 
+const uint32_t* odr::BlendWeightReciprocals() {
+    static const std::vector<uint32_t> reciprocals = [] {
+        std::vector<uint32_t> table(MAX_BLEND_WEIGHT + 1, 0u);
+        for (uint32_t weight = 255u; weight <= MAX_BLEND_WEIGHT; weight++) {
+            table[weight] = static_cast<uint32_t>(((uint64_t(1) << 32) + weight / 2) / weight);
+        }
+        return table;
+    }();
+
+    return reciprocals.data();
+}
+
+/*static*/ odr::PixelColor odr::PixelColor::BlendFixedPoint(const PixelColor& bgColor, const PixelColor& fgColor) {
+    if (fgColor.a <= 0 && bgColor.a <= 0) {
+        return PixelColor{
+            static_cast<unsigned char>((bgColor.r + fgColor.r + 1) / 2),
+            static_cast<unsigned char>((bgColor.g + fgColor.g + 1) / 2),
+            static_cast<unsigned char>((bgColor.b + fgColor.b + 1) / 2),
+            0
+        };
+    } if (fgColor.a <= 0u) {
+        return bgColor;
+    }
+    else if (fgColor.a >= 255u || bgColor.a <= 0u) {
+        return fgColor;
+    }
+
+    // Weights of the foreground and background colors, in units of 1/(255*255)
+    const uint32_t fgWeight = fgColor.a * 255u;
+    const uint32_t bgWeight = bgColor.a * (255u - fgColor.a);
+    const uint32_t weightSum = fgWeight + bgWeight;
+
+    // Color = weighted sum / weight sum, the division done as a multiplication by the reciprocal.
+    // The weighted sums fit in 24 bits, the products in 48 bits.
+    const uint64_t reciprocal = BlendWeightReciprocals()[weightSum];
+    const auto blendChannel = [&](unsigned char bgChannel, unsigned char fgChannel) {
+        const uint64_t weighted = fgChannel * fgWeight + bgChannel * bgWeight;
+        return static_cast<unsigned char>((weighted * reciprocal + (uint64_t(1) << 31)) >> 32);
+    };
+
+    return PixelColor{
+        blendChannel(bgColor.r, fgColor.r),
+        blendChannel(bgColor.g, fgColor.g),
+        blendChannel(bgColor.b, fgColor.b),
+        static_cast<unsigned char>((weightSum + 127u) / 255u)
+    };
+}
+
+/*static*/ odr::PixelColor odr::PixelColor::BlendPremultiplied(const PixelColor& bgColor, const PixelColor& fgColor) {
+    const uint32_t fgAlphaInv = 255u - fgColor.a;
+
+    // Saturated, channels of invalid premultiplied colors may exceed alpha
+    const auto blendChannel = [&](unsigned char bgChannel, unsigned char fgChannel) {
+        const uint32_t value = fgChannel + Div255(bgChannel * fgAlphaInv);
+        return static_cast<unsigned char>(value < 255u ? value : 255u);
+    };
+
+    return PixelColor{
+        blendChannel(bgColor.r, fgColor.r),
+        blendChannel(bgColor.g, fgColor.g),
+        blendChannel(bgColor.b, fgColor.b),
+        blendChannel(bgColor.a, fgColor.a)
+    };
+}
+
+/*static*/ odr::PixelColor odr::PixelColor::Premultiplied(const PixelColor& color) {
+    return PixelColor{
+        Div255(color.r * color.a),
+        Div255(color.g * color.a),
+        Div255(color.b * color.a),
+        color.a
+    };
+}
+
+/*static*/ odr::PixelColor odr::PixelColor::Unpremultiplied(const PixelColor& color) {
+    if (color.a == 0u) {
+        return COLOR_TRANSPARENT;
+    }
+
+    const auto unpremultiply = [&](unsigned char channel) {
+        const uint32_t value = (channel * 255u + color.a / 2u) / color.a;
+        return static_cast<unsigned char>(value < 255u ? value : 255u);
+    };
+
+    return PixelColor{
+        unpremultiply(color.r),
+        unpremultiply(color.g),
+        unpremultiply(color.b),
+        color.a
+    };
+}
+
 /*static*/ odr::PixelColor odr::PixelColor::AbsoluteDiff(const PixelColor& colorA, const PixelColor& colorB) {
     return PixelColor {
         UCharAbsoluteDiff(colorA.r, colorB.r),
@@ -0,0 +1,28 @@
+#include "PixelFormatConversion.h"
+
+#include <OpenDesignRenderer/PixelColor.h>
+
+
+void odr::ConvertPixelFormatSpan(unsigned char* pixels, uint32_t pixelCount, PixelFormat fromFormat, PixelFormat toFormat) {
+    if (fromFormat == toFormat) {
+        return;
+    }
+
+    const bool isPremultiplying = toFormat == PixelFormat::Premultiplied;
+
+    for (uint32_t i = 0; i < pixelCount; i++, pixels += 4) {
+        // Opaque pixels are the same in both formats
+        if (pixels[3] == 0xFF) {
+            continue;
+        }
+
+        const PixelColor color{ pixels[0], pixels[1], pixels[2], pixels[3] };
+        const PixelColor converted = isPremultiplying
+            ? PixelColor::Premultiplied(color)
+            : PixelColor::Unpremultiplied(color);
+
+        pixels[0] = converted.r;
+        pixels[1] = converted.g;
+        pixels[2] = converted.b;
+    }
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <OpenDesignRenderer/PixelFormat.h>
+
+namespace odr {
+/*!
+    \brief Convert a span of RGBA pixels from one pixel format to another, in place.
+    \param pixels The pixels to convert.
+    \param pixelCount Number of pixels in the span.
+    \param fromFormat Current format of the pixels.
+    \param toFormat Requested format of the pixels. Nothing is done if it is the current format.
+*/
+void ConvertPixelFormatSpan(unsigned char* pixels, uint32_t pixelCount, PixelFormat fromFormat, PixelFormat toFormat);
+}
@@ -0,0 +1,133 @@
+#include "PixelHash.h"
+
+#include <cstring>
+
+#include "CpuFeatures.h"
+
+namespace {
+    //! Stripes between scrambles of the accumulators, which keep them from degrading on long inputs.
+    constexpr size_t STRIPES_PER_BLOCK = 16;
+
+    //! Key indices of the stripe words, the scrambles and the two final merges.
+    constexpr uint32_t SCRAMBLE_KEY_INDEX = odr::HASH_LANE_COUNT;
+    constexpr uint32_t MERGE_LOW_KEY_INDEX = 2 * odr::HASH_LANE_COUNT;
+    constexpr uint32_t MERGE_HIGH_KEY_INDEX = 3 * odr::HASH_LANE_COUNT;
+
+    constexpr uint64_t PRIME32_1 = 0x9E3779B1ull;
+    constexpr uint64_t PRIME64_1 = 0x9E3779B185EBCA87ull;
+    constexpr uint64_t PRIME64_2 = 0xC2B2AE3D27D4EB4Full;
+
+    //! Read a little-endian 64-bit word.
+    inline uint64_t LoadWord(const unsigned char* data) {
+        uint64_t word = 0;
+        for (uint32_t i = 0; i < 8; i++) {
+            word |= static_cast<uint64_t>(data[i]) << (i * 8);
+        }
+        return word;
+    }
+
+    //! XOR of the low and high halves of the 128-bit product.
+    inline uint64_t MultiplyFold(uint64_t a, uint64_t b) {
+        const uint64_t aLo = a & 0xFFFFFFFFu;
+        const uint64_t aHi = a >> 32;
+        const uint64_t bLo = b & 0xFFFFFFFFu;
+        const uint64_t bHi = b >> 32;
+
+        const uint64_t loLo = aLo * bLo;
+        const uint64_t hiLo = aHi * bLo;
+        const uint64_t loHi = aLo * bHi;
+        const uint64_t hiHi = aHi * bHi;
+
+        const uint64_t cross = (loLo >> 32) + (hiLo & 0xFFFFFFFFu) + loHi;
+        const uint64_t hi = hiHi + (hiLo >> 32) + (cross >> 32);
+        const uint64_t lo = (cross << 32) | (loLo & 0xFFFFFFFFu);
+        return lo ^ hi;
+    }
+
+    //! Spread the entropy of all bits over all bits.
+    inline uint64_t Avalanche(uint64_t hash) {
+        hash ^= hash >> 37;
+        hash *= 0x165667919E3779F9ull;
+        return hash ^ (hash >> 32);
+    }
+
+    //! Combine the accumulators to 64 bits with keys from keyIndex.
+    uint64_t MergeAccumulators(const uint64_t* accumulators, uint32_t keyIndex, uint64_t hash) {
+        for (uint32_t i = 0; i < odr::HASH_LANE_COUNT; i += 2) {
+            hash += MultiplyFold(accumulators[i] ^ odr::HashKey(keyIndex + i), accumulators[i + 1] ^ odr::HashKey(keyIndex + i + 1));
+        }
+        return Avalanche(hash);
+    }
+
+    //! Mix the high bits of the accumulators into the low ones, which the 32-bit products depend on.
+    void ScrambleAccumulators(uint64_t* accumulators) {
+        for (uint32_t i = 0; i < odr::HASH_LANE_COUNT; i++) {
+            uint64_t accumulator = accumulators[i];
+            accumulator ^= accumulator >> 47;
+            accumulator ^= odr::HashKey(SCRAMBLE_KEY_INDEX + i);
+            accumulators[i] = accumulator * PRIME32_1;
+        }
+    }
+}
+
+
+odr::HashStripesFunction odr::SelectHashStripes(InstructionSet maxInstructionSet) {
+#if defined(ODR_X86_SIMD)
+    if (maxInstructionSet >= InstructionSet::Avx2 && IsAvx2Supported()) {
+        return HashStripesAvx2;
+    }
+    if (maxInstructionSet >= InstructionSet::Sse2) {
+        return HashStripesSse2;
+    }
+#else
+    (void)maxInstructionSet;
+#endif
+    return HashStripesScalar;
+}
+
+odr::ImageHash odr::HashBytes(const unsigned char* data, size_t size, uint64_t seed, InstructionSet maxInstructionSet) {
+    const HashStripesFunction hashStripes = SelectHashStripes(maxInstructionSet);
+
+    uint64_t accumulators[HASH_LANE_COUNT];
+    for (uint32_t i = 0; i < HASH_LANE_COUNT; i++) {
+        accumulators[i] = HashKey(i) ^ seed;
+    }
+
+    // Whole blocks, then the remaining whole stripes, then the last partial stripe padded with zeros
+    const size_t stripeCount = size / HASH_STRIPE_SIZE;
+    size_t stripe = 0;
+    for (; stripe + STRIPES_PER_BLOCK <= stripeCount; stripe += STRIPES_PER_BLOCK) {
+        hashStripes(accumulators, data + stripe * HASH_STRIPE_SIZE, STRIPES_PER_BLOCK);
+        ScrambleAccumulators(accumulators);
+    }
+    hashStripes(accumulators, data + stripe * HASH_STRIPE_SIZE, stripeCount - stripe);
+
+    const size_t tailSize = size - stripeCount * HASH_STRIPE_SIZE;
+    if (tailSize > 0) {
+        unsigned char tail[HASH_STRIPE_SIZE] = {};
+        std::memcpy(tail, data + stripeCount * HASH_STRIPE_SIZE, tailSize);
+        HashStripesScalar(accumulators, tail, 1);
+    }
+
+    const uint64_t sizeBits = static_cast<uint64_t>(size);
+    return ImageHash{
+        MergeAccumulators(accumulators, MERGE_LOW_KEY_INDEX, sizeBits * PRIME64_1),
+        MergeAccumulators(accumulators, MERGE_HIGH_KEY_INDEX, ~(sizeBits * PRIME64_2)) };
+}
+
+void odr::HashStripesScalar(uint64_t* accumulators, const unsigned char* data, size_t stripeCount) {
+    uint64_t keys[HASH_LANE_COUNT];
+    for (uint32_t i = 0; i < HASH_LANE_COUNT; i++) {
+        keys[i] = HashKey(i);
+    }
+
+    for (size_t stripe = 0; stripe < stripeCount; stripe++, data += HASH_STRIPE_SIZE) {
+        for (uint32_t i = 0; i < HASH_LANE_COUNT; i++) {
+            const uint64_t word = LoadWord(data + i * 8);
+            const uint64_t keyedWord = word ^ keys[i];
+
+            accumulators[i ^ 1] += word;
+            accumulators[i] += (keyedWord & 0xFFFFFFFFu) * (keyedWord >> 32);
+        }
+    }
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <OpenDesignRenderer/ImageHash.h>
+#include <OpenDesignRenderer/InstructionSet.h>
+
+namespace odr {
+//! Number of 64-bit accumulators of the pixel hash.
+constexpr uint32_t HASH_LANE_COUNT = 8;
+//! Bytes added to the accumulators at once, one 64-bit word per accumulator.
+constexpr size_t HASH_STRIPE_SIZE = HASH_LANE_COUNT * 8;
+
+//! Fixed pseudo-random keys of the hash, SplitMix64 of the index.
+constexpr uint64_t HashKey(uint32_t index) {
+    uint64_t z = 0x9E3779B97F4A7C15ull * (index + 1ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+/*!
+    \brief Add stripes of data to the hash accumulators.
+    \note For every 64-bit word d of a stripe and its key k, accumulator i gets the product of the 32-bit halves
+        of d ^ k, and the neighbouring accumulator i ^ 1 gets d itself.
+    \param accumulators HASH_LANE_COUNT accumulators.
+    \param data stripeCount * HASH_STRIPE_SIZE bytes, read as little-endian words.
+    \param stripeCount Number of stripes.
+*/
+using HashStripesFunction = void (*)(uint64_t* accumulators, const unsigned char* data, size_t stripeCount);
+
+//! Select the fastest stripe kernel supported by the CPU, up to the specified instruction set. All give identical results.
+HashStripesFunction SelectHashStripes(InstructionSet maxInstructionSet);
+
+/*!
+    \brief Hash a span of bytes, at memory bandwidth for long spans.
+    \note The hash is not cryptographic. Spans of different sizes or seeds hash differently.
+*/
+ImageHash HashBytes(const unsigned char* data, size_t size, uint64_t seed, InstructionSet maxInstructionSet);
+
+//! Portable kernel, one word at a time.
+void HashStripesScalar(uint64_t* accumulators, const unsigned char* data, size_t stripeCount);
+
+#if defined(ODR_X86_SIMD)
+//! SSE2 kernel, 2 words per instruction.
+void HashStripesSse2(uint64_t* accumulators, const unsigned char* data, size_t stripeCount);
+//! AVX2 kernel, 4 words per instruction. Only call it if IsAvx2Supported().
+void HashStripesAvx2(uint64_t* accumulators, const unsigned char* data, size_t stripeCount);
+#endif
+}
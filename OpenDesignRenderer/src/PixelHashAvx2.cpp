@@ -0,0 +1,38 @@
+#include "PixelHash.h"
+
+#if defined(ODR_X86_SIMD)
+
+#include <immintrin.h>
+
+// This file is compiled with AVX2 enabled, see CMakeLists.txt.
+
+void odr::HashStripesAvx2(uint64_t* accumulators, const unsigned char* data, size_t stripeCount) {
+    __m256i sums[HASH_LANE_COUNT / 4];
+    __m256i keys[HASH_LANE_COUNT / 4];
+    for (uint32_t i = 0; i < HASH_LANE_COUNT / 4; i++) {
+        sums[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(accumulators + i * 4));
+        keys[i] = _mm256_set_epi64x(
+            static_cast<int64_t>(HashKey(i * 4 + 3)),
+            static_cast<int64_t>(HashKey(i * 4 + 2)),
+            static_cast<int64_t>(HashKey(i * 4 + 1)),
+            static_cast<int64_t>(HashKey(i * 4)));
+    }
+
+    for (size_t stripe = 0; stripe < stripeCount; stripe++, data += HASH_STRIPE_SIZE) {
+        for (uint32_t i = 0; i < HASH_LANE_COUNT / 4; i++) {
+            const __m256i words = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i * 32));
+            const __m256i keyedWords = _mm256_xor_si256(words, keys[i]);
+            const __m256i products = _mm256_mul_epu32(keyedWords, _mm256_srli_epi64(keyedWords, 32));
+            // Each word goes to the neighbouring accumulator
+            const __m256i swappedWords = _mm256_shuffle_epi32(words, _MM_SHUFFLE(1, 0, 3, 2));
+
+            sums[i] = _mm256_add_epi64(sums[i], _mm256_add_epi64(products, swappedWords));
+        }
+    }
+
+    for (uint32_t i = 0; i < HASH_LANE_COUNT / 4; i++) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(accumulators + i * 4), sums[i]);
+    }
+}
+
+#endif
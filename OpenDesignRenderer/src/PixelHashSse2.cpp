@@ -0,0 +1,33 @@
+#include "PixelHash.h"
+
+#if defined(ODR_X86_SIMD)
+
+#include <emmintrin.h>
+
+
+void odr::HashStripesSse2(uint64_t* accumulators, const unsigned char* data, size_t stripeCount) {
+    __m128i sums[HASH_LANE_COUNT / 2];
+    __m128i keys[HASH_LANE_COUNT / 2];
+    for (uint32_t i = 0; i < HASH_LANE_COUNT / 2; i++) {
+        sums[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(accumulators + i * 2));
+        keys[i] = _mm_set_epi64x(static_cast<int64_t>(HashKey(i * 2 + 1)), static_cast<int64_t>(HashKey(i * 2)));
+    }
+
+    for (size_t stripe = 0; stripe < stripeCount; stripe++, data += HASH_STRIPE_SIZE) {
+        for (uint32_t i = 0; i < HASH_LANE_COUNT / 2; i++) {
+            const __m128i words = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i * 16));
+            const __m128i keyedWords = _mm_xor_si128(words, keys[i]);
+            const __m128i products = _mm_mul_epu32(keyedWords, _mm_srli_epi64(keyedWords, 32));
+            // Each word goes to the neighbouring accumulator
+            const __m128i swappedWords = _mm_shuffle_epi32(words, _MM_SHUFFLE(1, 0, 3, 2));
+
+            sums[i] = _mm_add_epi64(sums[i], _mm_add_epi64(products, swappedWords));
+        }
+    }
+
+    for (uint32_t i = 0; i < HASH_LANE_COUNT / 2; i++) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(accumulators + i * 2), sums[i]);
+    }
+}
+
+#endif
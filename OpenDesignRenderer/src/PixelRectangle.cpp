@@ -0,0 +1,121 @@
+#include <OpenDesignRenderer/PixelRectangle.h>
+
+#include <algorithm>
+
+
+uint32_t odr::PixelRectangle::Right() const {
+    return position.left + dimensions.width;
+}
+
+uint32_t odr::PixelRectangle::Bottom() const {
+    return position.top + dimensions.height;
+}
+
+bool odr::PixelRectangle::IsEmpty() const {
+    return
+        dimensions.width == 0 ||
+        dimensions.height == 0;
+}
+
+bool odr::PixelRectangle::Contains(const PixelRectangle& other) const {
+    if (other.IsEmpty()) {
+        return true;
+    }
+
+    return
+        other.position.left >= position.left &&
+        other.position.top >= position.top &&
+        other.Right() <= Right() &&
+        other.Bottom() <= Bottom();
+}
+
+odr::PixelRectangle odr::PixelRectangle::Intersected(const PixelRectangle& other) const {
+    const uint32_t left = std::max(position.left, other.position.left);
+    const uint32_t top = std::max(position.top, other.position.top);
+    const uint32_t right = std::min(Right(), other.Right());
+    const uint32_t bottom = std::min(Bottom(), other.Bottom());
+
+    if (left >= right || top >= bottom) {
+        return PIXEL_RECTANGLE_EMPTY;
+    }
+
+    return PixelRectangle{ { left, top }, { right - left, bottom - top } };
+}
+
+odr::PixelRectangle odr::PixelRectangle::United(const PixelRectangle& other) const {
+    if (other.IsEmpty()) {
+        return *this;
+    }
+    if (IsEmpty()) {
+        return other;
+    }
+
+    const uint32_t left = std::min(position.left, other.position.left);
+    const uint32_t top = std::min(position.top, other.position.top);
+    const uint32_t right = std::max(Right(), other.Right());
+    const uint32_t bottom = std::max(Bottom(), other.Bottom());
+
+    return PixelRectangle{ { left, top }, { right - left, bottom - top } };
+}
+
+odr::PixelRectangle odr::PixelRectangle::Subtracted(const PixelRectangle& other) const {
+    const PixelRectangle covered = Intersected(other);
+    if (covered.IsEmpty()) {
+        return *this;
+    }
+    if (covered == *this) {
+        return PIXEL_RECTANGLE_EMPTY;
+    }
+
+    // Covered band spanning the whole width, at the top or at the bottom
+    if (covered.position.left == position.left && covered.Right() == Right()) {
+        if (covered.position.top == position.top) {
+            return PixelRectangle{ { position.left, covered.Bottom() }, { dimensions.width, Bottom() - covered.Bottom() } };
+        }
+        if (covered.Bottom() == Bottom()) {
+            return PixelRectangle{ position, { dimensions.width, covered.position.top - position.top } };
+        }
+    }
+
+    // Covered band spanning the whole height, on the left or on the right
+    if (covered.position.top == position.top && covered.Bottom() == Bottom()) {
+        if (covered.position.left == position.left) {
+            return PixelRectangle{ { covered.Right(), position.top }, { Right() - covered.Right(), dimensions.height } };
+        }
+        if (covered.Right() == Right()) {
+            return PixelRectangle{ position, { covered.position.left - position.left, dimensions.height } };
+        }
+    }
+
+    return *this;
+}
+
+bool odr::PixelRectangle::operator==(const PixelRectangle& other) const {
+    return
+        position.left == other.position.left &&
+        position.top == other.position.top &&
+        dimensions == other.dimensions;
+}
+
+bool odr::PixelRectangle::operator!=(const PixelRectangle& other) const {
+    return !(*this == other);
+}
+
+/*static*/ odr::PixelRectangle odr::PixelRectangle::Clipped(
+    const PixelCoordinatesUnbounded& position,
+    const ImageDimensions& dimensions,
+    const ImageDimensions& bounds) {
+    // 64-bit arithmetic so that far off-screen rectangles can not wrap around
+    const int64_t left = std::max<int64_t>(position.left, 0);
+    const int64_t top = std::max<int64_t>(position.top, 0);
+    const int64_t right = std::min<int64_t>(static_cast<int64_t>(position.left) + dimensions.width, bounds.width);
+    const int64_t bottom = std::min<int64_t>(static_cast<int64_t>(position.top) + dimensions.height, bounds.height);
+
+    if (left >= right || top >= bottom) {
+        return PIXEL_RECTANGLE_EMPTY;
+    }
+
+    return PixelRectangle{
+        { static_cast<uint32_t>(left), static_cast<uint32_t>(top) },
+        { static_cast<uint32_t>(right - left), static_cast<uint32_t>(bottom - top) } };
+}
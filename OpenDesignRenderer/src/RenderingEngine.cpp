@@ -1,49 +1,349 @@
 #include <OpenDesignRenderer/RenderingEngine.h>
 
-#include <algorithm>
-
+#include <OpenDesignRenderer/ImageContentInfo.h>
+#include <OpenDesignRenderer/ImagePoolAllocator.h>
 #include <OpenDesignRenderer/PixelCoordinates.h>
 #include <OpenDesignRenderer/PixelColor.h>
+#include <OpenDesignRenderer/PixelRectangle.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <limits>
+#include <utility>
+#include <thread>
+
+#include "BlendSpan.h"
+#include "Compositing.h"
+#include "DirtyRegion.h"
+#include "DisplayList.h"
+#include "ImageResampler.h"
+#include "PixelFormatConversion.h"
+#include "ThreadPool.h"
+#include "Tiling.h"
+
+
+odr::RenderingEngine::RenderingEngine() :
+    RenderingEngine(RenderingEngineSettings{}) {
+}
+
+odr::RenderingEngine::RenderingEngine(const RenderingEngineSettings& settings_) :
+    settings(settings_),
+    blendKernels(&BlendKernels::Select(settings_.frameBufferPixelFormat, settings_.blendMode, settings_.maxInstructionSet)),
+    displayList(std::make_unique<DisplayList>(settings_.isOcclusionCullingEnabled)),
+    retainedDisplayList(std::make_unique<DisplayList>(settings_.isOcclusionCullingEnabled)),
+    unrenderedRegion(std::make_unique<DirtyRegion>()),
+    culledPixelCount(0),
+    layerAllocator(std::make_shared<ImagePoolAllocator>()),
+    layerByteSize(0) {
+    const uint32_t threadCount = settings.threadCount > 0
+        ? settings.threadCount
+        : std::thread::hardware_concurrency();
 
+    if (threadCount > 1) {
+        threadPool = std::make_unique<ThreadPool>(threadCount);
+    }
+}
+
+odr::RenderingEngine::~RenderingEngine() = default;
+
+const odr::RenderingEngineSettings& odr::RenderingEngine::GetSettings() const {
+    return settings;
+}
+
+odr::InstructionSet odr::RenderingEngine::GetInstructionSet() const {
+    return blendKernels->instructionSet;
+}
+
+uint32_t odr::RenderingEngine::GetThreadCount() const {
+    return threadPool ? threadPool->GetThreadCount() : 1u;
+}
 
 bool odr::RenderingEngine::InitializeFrameBuffer(const ImageDimensions& dimensions) {
-    return frameBuffer.Initialize(dimensions, COLOR_TRANSPARENT);
+    displayList->Clear();
+    retainedDisplayList->Clear();
+    unrenderedRegion->Clear();
+    culledPixelCount = 0;
+    layers.clear();
+    layerByteSize = 0;
+
+    if (!frameBuffer.Initialize(dimensions, COLOR_TRANSPARENT, settings.frameBufferPixelFormat)) {
+        return false;
+    }
+
+    unrenderedRegion->Add(PixelRectangle{ { 0, 0 }, dimensions });
+    return true;
+}
+
+bool odr::RenderingEngine::Render(Image& image) {
+    if (
+        !Flush() ||
+        !image.CloneFrom(frameBuffer) ||
+        !image.ConvertToPixelFormat(PixelFormat::Straight)) {
+        return false;
+    }
+
+    unrenderedRegion->Clear();
+    return true;
+}
+
+bool odr::RenderingEngine::Render(Image& image, std::vector<PixelRectangle>& changedRegions) {
+    changedRegions.clear();
+
+    if (!Flush()) {
+        return false;
+    }
+
+    const bool isImageReusable =
+        image.IsInitialized() &&
+        image.GetDimensions() == frameBuffer.GetDimensions() &&
+        image.GetPixelFormat() == PixelFormat::Straight;
+
+    if (!isImageReusable) {
+        if (!Render(image)) {
+            return false;
+        }
+        changedRegions.push_back(PixelRectangle{ { 0, 0 }, frameBuffer.GetDimensions() });
+        return true;
+    }
+
+    for (const PixelRectangle& region : unrenderedRegion->GetRectangles()) {
+        for (uint32_t y = region.position.top; y < region.Bottom(); y++) {
+            unsigned char* imageRow = image.GetRowData(y) + region.position.left * 4;
+            std::memcpy(imageRow, frameBuffer.GetRowData(y) + region.position.left * 4, region.dimensions.width * 4);
+            ConvertPixelFormatSpan(imageRow, region.dimensions.width, frameBuffer.GetPixelFormat(), PixelFormat::Straight);
+        }
+    }
+    image.MarkContentChanged();
+
+    changedRegions = unrenderedRegion->GetRectangles();
+    unrenderedRegion->Clear();
+    return true;
+}
+
+bool odr::RenderingEngine::TakeFrameBuffer(Image& image) {
+    if (
+        !frameBuffer.IsInitialized() ||
+        !Flush() ||
+        !frameBuffer.ConvertToPixelFormat(PixelFormat::Straight)) {
+        return false;
+    }
+
+    const ImageDimensions dimensions = frameBuffer.GetDimensions();
+    std::swap(image, frameBuffer);
+
+    if (settings.renderMode != RenderMode::Retained) {
+        return InitializeFrameBuffer(dimensions);
+    }
+
+    // The retained scene is kept, the new frame buffer starts with its pixels so the next Flush only redraws changes
+    if (!frameBuffer.Initialize(dimensions, COLOR_TRANSPARENT, settings.frameBufferPixelFormat)) {
+        return false;
+    }
+    unrenderedRegion->Clear();
+
+    // Premultiplied pixels would lose precision converted back from the taken image, they are composited again
+    if (settings.frameBufferPixelFormat == PixelFormat::Premultiplied) {
+        return ExecuteDisplayList(PixelRectangle{ { 0, 0 }, dimensions });
+    }
+
+    const Image& takenImage = image;
+    for (uint32_t y = 0; y < dimensions.height; y++) {
+        std::memcpy(frameBuffer.GetRowData(y), takenImage.GetRowData(y), dimensions.width * 4);
+    }
+    frameBuffer.MarkContentChanged();
+    return true;
+}
+
+void odr::RenderingEngine::BeginFrame() {
+    layers.clear();
+    layerByteSize = 0;
+
+    if (settings.renderMode == RenderMode::Retained) {
+        displayList->Clear();
+    }
+}
+
+bool odr::RenderingEngine::Flush() {
+    // The open layers are not a part of the frame buffer yet
+    if (!layers.empty()) {
+        return false;
+    }
+
+    if (settings.renderMode == RenderMode::Retained) {
+        return FlushRetained();
+    }
+
+    if (displayList->IsEmpty()) {
+        return true;
+    }
+
+    const bool isFlushed = ExecuteDisplayList(displayList->GetBounds());
+    unrenderedRegion->Add(displayList->GetBounds());
+
+    displayList->Clear();
+    return isFlushed;
+}
+
+size_t odr::RenderingEngine::GetDeferredCommandCount() const {
+    return displayList->GetCommandCount();
 }
 
-bool odr::RenderingEngine::Render(Image& image) const {
-    return image.CloneFrom(frameBuffer);
+uint64_t odr::RenderingEngine::GetCulledPixelCount() const {
+    return culledPixelCount;
 }
 
 bool odr::RenderingEngine::Draw(
     const Image& image,
+    const PixelCoordinatesUnbounded& imagePosition_,
+    const ImageDimensions& imageDimensions) {
+    const PixelCoordinatesUnbounded imagePosition = ToTargetCoordinates(imagePosition_);
+    const PixelRectangle area = PixelRectangle::Clipped(imagePosition, imageDimensions, GetTarget().GetDimensions());
+    if (area.IsEmpty()) {
+        return true;
+    }
+
+    if (!image.IsInitialized()) {
+        return false;
+    }
+
+    // Scaling keeps transparent images transparent, they leave premultiplied frame buffers unchanged.
+    // The content info scans the whole image on first use, scaled straight alpha draws never need it.
+    if (settings.frameBufferPixelFormat == PixelFormat::Premultiplied && image.GetContentInfo().isTransparent) {
+        return true;
+    }
+
+    const std::shared_ptr<const Image> cachedImage = FindCachedScaledImage(image, imageDimensions);
+    if (cachedImage) {
+        return DrawScaledImage(cachedImage, imagePosition, area);
+    }
+
+    const ImageResampler resampler(image, imageDimensions, settings.resamplingFilter);
+    if (!resampler.IsIdentity()) {
+        return DrawResampled(resampler, imagePosition, area, false, image.GetContentId());
+    }
+
+    // Unscaled images may only change the frame buffer below their non-transparent pixels, opaque ones replace it
+    const ImageContentInfo contentInfo = image.GetContentInfo();
+    const PixelRectangle contentArea = ClipToContent(area, contentInfo, imagePosition, settings.frameBufferPixelFormat);
+    if (contentArea.IsEmpty()) {
+        return true;
+    }
+    return DrawResampled(resampler, imagePosition, contentArea, contentInfo.isOpaque, image.GetContentId());
+}
+
+bool odr::RenderingEngine::Draw(
+    const ImageView& image,
+    const PixelCoordinatesUnbounded& imagePosition_,
+    const ImageDimensions& imageDimensions) {
+    const PixelCoordinatesUnbounded imagePosition = ToTargetCoordinates(imagePosition_);
+    const PixelRectangle area = PixelRectangle::Clipped(imagePosition, imageDimensions, GetTarget().GetDimensions());
+    if (area.IsEmpty()) {
+        return true;
+    }
+
+    if (!image.IsInitialized()) {
+        return false;
+    }
+
+    return DrawResampled(ImageResampler(image, imageDimensions, settings.resamplingFilter), imagePosition, area, false, 0);
+}
+
+bool odr::RenderingEngine::DrawResampled(
+    const ImageResampler& resampler,
     const PixelCoordinatesUnbounded& imagePosition,
+    const PixelRectangle& area,
+    bool isImageOpaque,
+    uint64_t sourceContentId) {
+    if (IsRecording()) {
+        const RecordedImageSource imageSource{
+            sourceContentId, resampler.GetDimensions(), settings.resamplingFilter, imagePosition, area };
+
+        // The retained scene recorded the same drawing when the source is unchanged, its image is reused as is
+        std::shared_ptr<const Image> recordedImage = retainedDisplayList->FindRecordedImage(displayList->GetCommandCount(), imageSource);
+        if (!recordedImage) {
+            // Only the visible part of the scaled image is recorded, the caller may change or destroy the image before Render
+            const PixelRectangle visibleArea{
+                { static_cast<uint32_t>(area.position.left - imagePosition.left), static_cast<uint32_t>(area.position.top - imagePosition.top) },
+                area.dimensions };
+
+            auto resampledImage = std::make_shared<Image>();
+            if (
+                !resampler.Resample(visibleArea, *resampledImage) ||
+                !resampledImage->ConvertToPixelFormat(settings.frameBufferPixelFormat)) {
+                return false;
+            }
+            recordedImage = std::move(resampledImage);
+        }
+
+        const PixelCoordinatesUnbounded recordedPosition{
+            static_cast<int32_t>(area.position.left),
+            static_cast<int32_t>(area.position.top) };
+        displayList->AddImage(recordedImage, recordedPosition, area, imageSource);
+        return true;
+    }
+
+    Image& target = GetTarget();
+    std::atomic<bool> isDrawn(true);
+
+    ForEachTile(area, [&](const PixelRectangle& tile) {
+        if (!CompositeScaledImage(*blendKernels, target, tile, resampler, imagePosition, isImageOpaque)) {
+            isDrawn = false;
+        }
+    });
+    if (layers.empty()) {
+        unrenderedRegion->Add(area);
+    }
+
+    return isDrawn;
+}
+
+std::shared_ptr<const odr::Image> odr::RenderingEngine::FindCachedScaledImage(
+    const Image& image,
     const ImageDimensions& imageDimensions) {
-    const Image scaledImage = image.Scaled(imageDimensions);
+    ScaledImageCache* cache = settings.scaledImageCache.get();
+    if (cache == nullptr || !cache->IsCacheable(imageDimensions)) {
+        return nullptr;
+    }
 
-    const ImageDimensions& fbDimensions = frameBuffer.GetDimensions();
+    // Drawn directly from the source, nothing to cache
+    if (image.GetDimensions() == imageDimensions && image.GetPixelFormat() == settings.frameBufferPixelFormat) {
+        return nullptr;
+    }
 
-    const uint32_t fbLeft = std::max(imagePosition.left, 0);
-    const uint32_t fbRight = std::min(imageDimensions.width + imagePosition.left, fbDimensions.width);
-    const uint32_t fbTop = std::max(imagePosition.top, 0);
-    const uint32_t fbBottom = std::min(imageDimensions.height + imagePosition.top, fbDimensions.height);
+    return cache->FindOrCreate(image, imageDimensions, settings.frameBufferPixelFormat, settings.resamplingFilter);
+}
 
-    bool areAllColorsSet = true;
+bool odr::RenderingEngine::DrawScaledImage(
+    const std::shared_ptr<const Image>& scaledImage,
+    const PixelCoordinatesUnbounded& imagePosition,
+    const PixelRectangle& area) {
+    // Cached images and finished layers are never modified, recorded commands may share them
+    if (IsRecording()) {
+        displayList->AddImage(scaledImage, imagePosition, area, RecordedImageSource{});
+        return true;
+    }
 
-    // For each pixel in the frame buffer where the image will be drawn
-    for (uint32_t y = fbTop; y < fbBottom; y++) {
-        for (uint32_t x = fbLeft; x < fbRight; x++) {
-            const PixelCoordinates imgCoords{ x - imagePosition.left, y - imagePosition.top };
-            const PixelCoordinates fbCoords{ x, y };
+    // The content info is cached with the scaled image, it is computed once for all draws of it
+    const ImageContentInfo contentInfo = scaledImage->GetContentInfo();
+    const PixelRectangle contentArea = ClipToContent(area, contentInfo, imagePosition, settings.frameBufferPixelFormat);
+    if (contentArea.IsEmpty()) {
+        return true;
+    }
 
-            const PixelColor imageColor = scaledImage.GetColor(imgCoords);
-            const PixelColor frameBufferColor = frameBuffer.GetColor(fbCoords);
-            const PixelColor blendedPixelColor = PixelColor::Blend(frameBufferColor, imageColor);
+    Image& target = GetTarget();
+    std::atomic<bool> isDrawn(true);
 
-            areAllColorsSet &= frameBuffer.SetColor(blendedPixelColor, fbCoords);
+    ForEachTile(contentArea, [&](const PixelRectangle& tile) {
+        if (!CompositeImage(*blendKernels, target, tile, *scaledImage, imagePosition, contentInfo.isOpaque)) {
+            isDrawn = false;
         }
+    });
+    if (layers.empty()) {
+        unrenderedRegion->Add(contentArea);
     }
 
-    return areAllColorsSet;
+    return isDrawn;
 }
 
 bool odr::RenderingEngine::DrawRectangle(
@@ -52,35 +352,148 @@ bool odr::RenderingEngine::DrawRectangle(
     const PixelColor& fillColor,
     uint32_t innerStrokeWidth,
     const PixelColor& strokeColor) {
-    const ImageDimensions& fbDimensions = frameBuffer.GetDimensions();
+    const PixelCoordinatesUnbounded targetPosition = ToTargetCoordinates(rectanglePosition);
+    Image& target = GetTarget();
+    const PixelRectangle area = PixelRectangle::Clipped(targetPosition, rectangleDimensions, target.GetDimensions());
+
+    if (IsRecording()) {
+        displayList->AddRectangle(rectanglePosition, rectangleDimensions, area, fillColor, innerStrokeWidth, strokeColor);
+        return true;
+    }
+
+    ForEachTile(area, [&](const PixelRectangle& tile) {
+        CompositeRectangle(*blendKernels, target, tile, targetPosition, rectangleDimensions, fillColor, innerStrokeWidth, strokeColor);
+    });
+    if (layers.empty()) {
+        unrenderedRegion->Add(area);
+    }
+
+    return true;
+}
+
+bool odr::RenderingEngine::BeginLayer(
+    const PixelCoordinatesUnbounded& contentPosition,
+    const ImageDimensions& contentDimensions,
+    unsigned char opacity) {
+    // Clipped to the enclosing layer, nothing outside of it can be seen
+    const PixelRectangle targetArea = PixelRectangle::Clipped(
+        ToTargetCoordinates(contentPosition), contentDimensions, GetTarget().GetDimensions());
+    const PixelCoordinates origin = layers.empty() ? PixelCoordinates{ 0, 0 } : layers.back().area.position;
+
+    Layer layer{ std::make_shared<Image>(), targetArea, opacity };
+    layer.area.position = PixelCoordinates{ origin.left + targetArea.position.left, origin.top + targetArea.position.top };
+
+    if (!targetArea.IsEmpty()) {
+        // Layer buffers of the same size class are recycled, frames of similar layers run without allocations
+        ImageAllocatorScope allocatorScope(layerAllocator);
+        if (!layer.image->Initialize(targetArea.dimensions, COLOR_TRANSPARENT, settings.frameBufferPixelFormat)) {
+            return false;
+        }
+        layerByteSize += targetArea.dimensions.DataSize();
+    }
+
+    layers.push_back(std::move(layer));
+    return true;
+}
+
+bool odr::RenderingEngine::EndLayer() {
+    if (layers.empty()) {
+        return false;
+    }
+
+    const Layer layer = std::move(layers.back());
+    layers.pop_back();
+
+    if (!layer.image->IsInitialized() || layer.opacity == 0) {
+        return true;
+    }
+
+    // Blending the layer with its alpha scaled equals blending it with the opacity
+    MultiplyOpacity(*layer.image, layer.opacity);
+
+    const PixelCoordinatesUnbounded position = ToTargetCoordinates(PixelCoordinatesUnbounded{
+        static_cast<int32_t>(layer.area.position.left),
+        static_cast<int32_t>(layer.area.position.top) });
+    const PixelRectangle area = PixelRectangle::Clipped(position, layer.area.dimensions, GetTarget().GetDimensions());
+    return DrawScaledImage(layer.image, position, area);
+}
 
-    const uint32_t fbLeft = std::max(rectanglePosition.left, 0);
-    const uint32_t fbRight = std::min(rectangleDimensions.width + rectanglePosition.left, fbDimensions.width);
-    const uint32_t fbTop = std::max(rectanglePosition.top, 0);
-    const uint32_t fbBottom = std::min(rectangleDimensions.height + rectanglePosition.top, fbDimensions.height);
+size_t odr::RenderingEngine::GetLayerDepth() const {
+    return layers.size();
+}
+
+uint64_t odr::RenderingEngine::GetLayerByteSize() const {
+    return layerByteSize;
+}
+
+odr::ImagePoolAllocator& odr::RenderingEngine::GetLayerAllocator() const {
+    return *layerAllocator;
+}
+
+odr::Image& odr::RenderingEngine::GetTarget() {
+    return layers.empty() ? frameBuffer : *layers.back().image;
+}
+
+odr::PixelCoordinatesUnbounded odr::RenderingEngine::ToTargetCoordinates(const PixelCoordinatesUnbounded& position) const {
+    if (layers.empty()) {
+        return position;
+    }
 
-    bool areAllColorsSet = true;
+    // Saturated, positions this far outside of a layer are clipped away anyway
+    const PixelCoordinates& origin = layers.back().area.position;
+    const auto toTarget = [](int32_t coordinate, uint32_t originCoordinate) {
+        return static_cast<int32_t>(std::max<int64_t>(
+            static_cast<int64_t>(coordinate) - originCoordinate,
+            std::numeric_limits<int32_t>::min()));
+    };
+    return PixelCoordinatesUnbounded{ toTarget(position.left, origin.left), toTarget(position.top, origin.top) };
+}
 
-    // For each pixel in the frame buffer where the image will be drawn
-    for (uint32_t y = fbTop; y < fbBottom; y++) {
-        for (uint32_t x = fbLeft; x < fbRight; x++) {
-            const PixelCoordinates rectCoords{ x - rectanglePosition.left, y - rectanglePosition.top };
-            const PixelCoordinates fbCoords{ x, y };
+bool odr::RenderingEngine::IsRecording() const {
+    return layers.empty() && settings.renderMode != RenderMode::Immediate;
+}
 
-            const bool arerectCoordsInInnerFill =
-                rectCoords.left < innerStrokeWidth ||
-                rectCoords.left >= rectangleDimensions.width - innerStrokeWidth ||
-                rectCoords.top < innerStrokeWidth ||
-                rectCoords.top >= rectangleDimensions.height - innerStrokeWidth;
+void odr::RenderingEngine::ForEachTile(const PixelRectangle& area, const std::function<void(const PixelRectangle&)>& draw) {
+    // The frame buffer shared with a rendered image is copied once, not by the first tiles at the same time
+    if (!threadPool || !GetTarget().DetachData()) {
+        draw(area);
+        return;
+    }
+
+    // Tiles do not overlap, each pixel is still blended by exactly one thread in the drawing order
+    const std::vector<PixelRectangle> tiles = SplitIntoTiles(area, settings.tileSize);
+    threadPool->ParallelFor(static_cast<uint32_t>(tiles.size()), [&](uint32_t tileIndex) {
+        draw(tiles[tileIndex]);
+    });
+}
 
-            const PixelColor frameBufferColor = frameBuffer.GetColor(fbCoords);
-            const PixelColor blendedPixelColor = arerectCoordsInInnerFill
-                ? PixelColor::Blend(frameBufferColor, strokeColor)
-                : PixelColor::Blend(frameBufferColor, fillColor);
+bool odr::RenderingEngine::ExecuteDisplayList(const PixelRectangle& area) {
+    // Each tile runs the whole list, a tile's pixels stay in the cache for all commands touching it
+    std::atomic<bool> isExecuted(true);
 
-            areAllColorsSet &= frameBuffer.SetColor(blendedPixelColor, fbCoords);
+    ForEachTile(area, [&](const PixelRectangle& tile) {
+        uint64_t tileCulledPixelCount = 0;
+        if (!displayList->Execute(*blendKernels, frameBuffer, tile, tileCulledPixelCount)) {
+            isExecuted = false;
         }
+        culledPixelCount += tileCulledPixelCount;
+    });
+
+    return isExecuted;
+}
+
+bool odr::RenderingEngine::FlushRetained() {
+    DirtyRegion changedRegion;
+    displayList->AddChangedAreas(*retainedDisplayList, changedRegion);
+
+    // The changed areas do not overlap, each pixel is cleared and recomposited once
+    bool isFlushed = true;
+    for (const PixelRectangle& area : changedRegion.GetRectangles()) {
+        ClearArea(frameBuffer, area);
+        isFlushed &= ExecuteDisplayList(area);
     }
 
-    return areAllColorsSet;
+    *retainedDisplayList = *displayList;
+    unrenderedRegion->Add(changedRegion);
+    return isFlushed;
 }
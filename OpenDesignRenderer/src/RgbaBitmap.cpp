@@ -1,8 +1,5 @@
 #include "RgbaBitmap.h"
 
-#include <string>
-#include <stdlib.h>
-
 
 #define RGBA_BITMAP_MAGIC_NUMBER            0x52474241   /* 'RGBA' */
 
@@ -12,33 +9,17 @@
                                             *(ptr+2) = (u32 >> 8) & 0xFF; \
                                             *(ptr+3) = u32 & 0xFF;
 
-/*static*/ unsigned char* odr::RgbaBitmap::EndcodeToFileData(
-    const unsigned char* input_buffer,
+/*static*/ void odr::RgbaBitmap::EncodeHeader(
+    unsigned char* output_header,
     uint32_t width,
     uint32_t height)
 {
-    if (!input_buffer || width == 0 || height == 0) {
-        return nullptr;
-    }
-
-    const uint32_t imageDataSize = width * height * 4;
-    const uint32_t output_size = 12 + imageDataSize;
-
-    unsigned char* rgba_file = (unsigned char*)malloc(output_size);
-    if (!rgba_file) {
-        return nullptr;
-    }
-
-    WRITE_BIG_ENDIAN_UINT32(&rgba_file[0], RGBA_BITMAP_MAGIC_NUMBER);
-    WRITE_BIG_ENDIAN_UINT32(&rgba_file[4], width);
-    WRITE_BIG_ENDIAN_UINT32(&rgba_file[8], height);
-
-    memcpy(&rgba_file[12], input_buffer, imageDataSize);
-
-    return rgba_file;
+    WRITE_BIG_ENDIAN_UINT32(&output_header[0], RGBA_BITMAP_MAGIC_NUMBER);
+    WRITE_BIG_ENDIAN_UINT32(&output_header[4], width);
+    WRITE_BIG_ENDIAN_UINT32(&output_header[8], height);
 }
 
-/*static*/ unsigned char* odr::RgbaBitmap::DecodeFromFileData(
+/*static*/ const unsigned char* odr::RgbaBitmap::DecodeHeader(
     const unsigned char* file_data,
     uint32_t file_data_length,
     uint32_t* p_width,
@@ -60,21 +41,14 @@
     const uint32_t width = READ_BIG_ENDIAN_UINT32(&file_data[4]);
     const uint32_t height = READ_BIG_ENDIAN_UINT32(&file_data[8]);
 
-    const uint32_t imageDataSize = width * height * 4;
+    const uint64_t imageDataSize = (uint64_t)width * height * 4;
 
     if (file_data_length < (12 + imageDataSize)) {
         return nullptr;
     }
 
-    unsigned char* bitmap = (unsigned char*)malloc(imageDataSize);
-    if (!bitmap) {
-        return nullptr;
-    }
-
-    memcpy(bitmap, &file_data[12], imageDataSize);
-
     *p_width = width;
     *p_height = height;
 
-    return bitmap;
+    return &file_data[12];
 }
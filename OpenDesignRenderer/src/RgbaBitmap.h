@@ -9,12 +9,14 @@ namespace odr {
 */
 struct RgbaBitmap {
 
-static unsigned char * EndcodeToFileData(
-    const unsigned char * input_buffer,
+/* Write the 12 byte header of an RGBA file, the pixel data follows it. */
+static void EncodeHeader(
+    unsigned char * output_header,
     uint32_t width,
     uint32_t height);
 
-static unsigned char * DecodeFromFileData(
+/* Validate the header of RGBA file data and return the start of the pixel data inside it, or NULL. */
+static const unsigned char * DecodeHeader(
     const unsigned char * file_data,
     uint32_t file_data_length,
     uint32_t * p_width,
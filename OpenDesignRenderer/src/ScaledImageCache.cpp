@@ -0,0 +1,175 @@
+#include <OpenDesignRenderer/ScaledImageCache.h>
+
+#include <functional>
+
+#include <OpenDesignRenderer/Image.h>
+
+#include "ImageResampler.h"
+
+namespace {
+    //! Bytes of image data of the dimensions, without 32-bit overflow.
+    uint64_t ImageByteSize(const odr::ImageDimensions& dimensions) {
+        return static_cast<uint64_t>(dimensions.width) * dimensions.height * 4;
+    }
+}
+
+
+bool odr::ScaledImageCache::Key::operator==(const Key& other) const {
+    return
+        sourceContentId == other.sourceContentId &&
+        dimensions == other.dimensions &&
+        pixelFormat == other.pixelFormat &&
+        filter == other.filter;
+}
+
+size_t odr::ScaledImageCache::KeyHash::operator()(const Key& key) const {
+    const uint64_t dimensionsBits = (static_cast<uint64_t>(key.dimensions.width) << 32) | key.dimensions.height;
+
+    size_t hash = std::hash<uint64_t>()(key.sourceContentId);
+    hash ^= std::hash<uint64_t>()(dimensionsBits) + 0x9E3779B9 + (hash << 6) + (hash >> 2);
+    hash ^= static_cast<size_t>(key.pixelFormat) | (static_cast<size_t>(key.filter) << 1);
+    return hash;
+}
+
+odr::ScaledImageCache::ScaledImageCache(size_t byteBudget_) :
+    byteBudget(byteBudget_) {
+}
+
+std::shared_ptr<const odr::Image> odr::ScaledImageCache::Find(
+    const Image& source,
+    const ImageDimensions& dimensions,
+    PixelFormat pixelFormat,
+    ResamplingFilter filter) {
+    const Key key{ source.GetContentId(), dimensions, pixelFormat, filter };
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    const auto found = entriesByKey.find(key);
+    if (found == entriesByKey.end()) {
+        missCount++;
+        return nullptr;
+    }
+
+    hitCount++;
+    entries.splice(entries.begin(), entries, found->second);
+    return found->second->image;
+}
+
+std::shared_ptr<const odr::Image> odr::ScaledImageCache::FindOrCreate(
+    const Image& source,
+    const ImageDimensions& dimensions,
+    PixelFormat pixelFormat,
+    ResamplingFilter filter) {
+    std::shared_ptr<const Image> cachedImage = Find(source, dimensions, pixelFormat, filter);
+    if (cachedImage) {
+        return cachedImage;
+    }
+
+    if (!IsCacheable(dimensions)) {
+        return nullptr;
+    }
+
+    // Computed without the lock, concurrent misses of the same key may compute the image twice
+    auto scaledImage = std::make_shared<Image>();
+    const ImageResampler resampler(source, dimensions, filter);
+    if (
+        !source.IsInitialized() ||
+        !resampler.Resample(PixelRectangle{ { 0, 0 }, dimensions }, *scaledImage) ||
+        !scaledImage->ConvertToPixelFormat(pixelFormat)) {
+        return nullptr;
+    }
+
+    Insert(source, dimensions, pixelFormat, filter, scaledImage);
+    return scaledImage;
+}
+
+void odr::ScaledImageCache::Insert(
+    const Image& source,
+    const ImageDimensions& dimensions,
+    PixelFormat pixelFormat,
+    ResamplingFilter filter,
+    const std::shared_ptr<const Image>& scaledImage) {
+    if (!IsCacheable(dimensions)) {
+        return;
+    }
+
+    const Key key{ source.GetContentId(), dimensions, pixelFormat, filter };
+    const size_t imageByteSize = static_cast<size_t>(ImageByteSize(dimensions));
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    const auto found = entriesByKey.find(key);
+    if (found != entriesByKey.end()) {
+        entries.splice(entries.begin(), entries, found->second);
+        return;
+    }
+
+    entries.push_front(Entry{ key, scaledImage, imageByteSize });
+    entriesByKey.emplace(key, entries.begin());
+    byteSize += imageByteSize;
+
+    EvictToBudget();
+}
+
+bool odr::ScaledImageCache::IsCacheable(const ImageDimensions& dimensions) const {
+    return ImageByteSize(dimensions) <= byteBudget;
+}
+
+void odr::ScaledImageCache::Invalidate(const Image& source) {
+    const uint64_t sourceContentId = source.GetContentId();
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for (auto entry = entries.begin(); entry != entries.end();) {
+        if (entry->key.sourceContentId != sourceContentId) {
+            ++entry;
+            continue;
+        }
+
+        byteSize -= entry->byteSize;
+        entriesByKey.erase(entry->key);
+        entry = entries.erase(entry);
+    }
+}
+
+void odr::ScaledImageCache::Clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    entries.clear();
+    entriesByKey.clear();
+    byteSize = 0;
+}
+
+size_t odr::ScaledImageCache::GetByteBudget() const {
+    return byteBudget;
+}
+
+size_t odr::ScaledImageCache::GetByteSize() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return byteSize;
+}
+
+size_t odr::ScaledImageCache::GetEntryCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size();
+}
+
+uint64_t odr::ScaledImageCache::GetHitCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return hitCount;
+}
+
+uint64_t odr::ScaledImageCache::GetMissCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return missCount;
+}
+
+void odr::ScaledImageCache::EvictToBudget() {
+    // Entries already handed out stay alive in their users until released
+    while (byteSize > byteBudget && !entries.empty()) {
+        const Entry& leastRecentlyUsed = entries.back();
+        byteSize -= leastRecentlyUsed.byteSize;
+        entriesByKey.erase(leastRecentlyUsed.key);
+        entries.pop_back();
+    }
+}
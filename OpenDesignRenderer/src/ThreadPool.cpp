@@ -0,0 +1,136 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace {
+    //! Upper bound of a single sleep. Timed waits only re-check their condition, a lost wake-up can not stall a thread.
+    constexpr std::chrono::milliseconds MAX_WAIT_DURATION(10);
+}
+
+
+odr::ThreadPool::ThreadPool(uint32_t threadCount) :
+    pendingTaskCount(0) {
+    threadCount = std::max(threadCount, 1u);
+
+    for (uint32_t i = 0; i < threadCount; i++) {
+        queues.push_back(std::make_unique<Queue>());
+    }
+
+    for (uint32_t i = 1; i < threadCount; i++) {
+        workers.emplace_back(&ThreadPool::WorkerLoop, this, i);
+    }
+}
+
+odr::ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        isStopping = true;
+    }
+    wakeCondition.notify_all();
+
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+uint32_t odr::ThreadPool::GetThreadCount() const {
+    return static_cast<uint32_t>(queues.size());
+}
+
+void odr::ThreadPool::ParallelFor(uint32_t taskCount, const std::function<void(uint32_t)>& task) {
+    if (taskCount == 0) {
+        return;
+    }
+
+    // Nothing to distribute
+    if (taskCount == 1 || workers.empty()) {
+        for (uint32_t index = 0; index < taskCount; index++) {
+            task(index);
+        }
+        return;
+    }
+
+    Job job;
+    job.task = &task;
+    job.remainingTaskCount = taskCount;
+
+    // Counted before queueing, so the count never drops below the number of queued tasks
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        pendingTaskCount += taskCount;
+    }
+
+    // Deal the tasks to all queues, neighbouring indices end up in different queues
+    for (uint32_t index = 0; index < taskCount; index++) {
+        Queue& queue = *queues[index % queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(Task{ &job, index });
+    }
+    wakeCondition.notify_all();
+
+    // Help until there is nothing left to take, then wait for the tasks running on the workers
+    Task nextTask;
+    while (job.remainingTaskCount > 0 && TryTakeTask(0, nextTask)) {
+        RunTask(nextTask);
+    }
+
+    std::unique_lock<std::mutex> lock(job.mutex);
+    while (!job.finished.wait_for(lock, MAX_WAIT_DURATION, [&job] { return job.remainingTaskCount == 0; })) {
+    }
+}
+
+bool odr::ThreadPool::TryTakeTask(uint32_t queueIndex, Task& task) {
+    // Own queue first, from the front
+    {
+        Queue& queue = *queues[queueIndex];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.tasks.empty()) {
+            task = queue.tasks.front();
+            queue.tasks.pop_front();
+            pendingTaskCount--;
+            return true;
+        }
+    }
+
+    // Steal from the back of the other queues
+    for (size_t offset = 1; offset < queues.size(); offset++) {
+        Queue& queue = *queues[(queueIndex + offset) % queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.tasks.empty()) {
+            task = queue.tasks.back();
+            queue.tasks.pop_back();
+            pendingTaskCount--;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*static*/ void odr::ThreadPool::RunTask(const Task& task) {
+    Job& job = *task.job;
+    (*job.task)(task.index);
+
+    // Under the lock, the job lives on the waiting thread's stack and must outlive the notification
+    std::lock_guard<std::mutex> lock(job.mutex);
+    if (--job.remainingTaskCount == 0) {
+        job.finished.notify_all();
+    }
+}
+
+void odr::ThreadPool::WorkerLoop(uint32_t queueIndex) {
+    while (true) {
+        Task task;
+        if (TryTakeTask(queueIndex, task)) {
+            RunTask(task);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        wakeCondition.wait_for(lock, MAX_WAIT_DURATION, [this] { return isStopping || pendingTaskCount > 0; });
+        if (isStopping && pendingTaskCount == 0) {
+            return;
+        }
+    }
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace odr {
+/*!
+    \brief Work-stealing thread pool.
+    \note Each worker owns a task queue and takes tasks from its front. Idle workers steal from the back
+        of other queues, so uneven tasks (e.g. tiles with a lot of content) are balanced automatically.
+*/
+class ThreadPool {
+public:
+    //! Start a pool that runs tasks on threadCount threads, including the thread calling ParallelFor.
+    explicit ThreadPool(uint32_t threadCount);
+    //! Stop and join all workers.
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    //! Number of threads running the tasks, including the calling thread.
+    uint32_t GetThreadCount() const;
+
+    /*!
+        \brief Run task(index) for every index in <0, taskCount) and wait until all of them finish.
+        \note The calling thread runs tasks as well. Tasks must not call ParallelFor themselves.
+    */
+    void ParallelFor(uint32_t taskCount, const std::function<void(uint32_t)>& task);
+
+private:
+    //! One ParallelFor call.
+    struct Job {
+        const std::function<void(uint32_t)>* task;
+        std::atomic<uint32_t> remainingTaskCount;
+        std::mutex mutex;
+        std::condition_variable finished;
+    };
+    //! One task index of a job.
+    struct Task {
+        Job* job;
+        uint32_t index;
+    };
+    //! Task queue owned by one thread.
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    //! Take a task from the own queue, or steal one from another queue.
+    bool TryTakeTask(uint32_t queueIndex, Task& task);
+    //! Run a task and signal the job if it was the last one.
+    static void RunTask(const Task& task);
+    //! Worker thread main loop.
+    void WorkerLoop(uint32_t queueIndex);
+
+    //! Queue 0 belongs to the threads calling ParallelFor, the others to the workers.
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+
+    //! Tasks queued and not taken yet.
+    std::atomic<uint32_t> pendingTaskCount;
+    std::mutex wakeMutex;
+    std::condition_variable wakeCondition;
+    bool isStopping = false;
+};
+}
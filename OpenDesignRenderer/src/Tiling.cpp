@@ -0,0 +1,27 @@
+#include "Tiling.h"
+
+#include <algorithm>
+
+
+std::vector<odr::PixelRectangle> odr::SplitIntoTiles(const PixelRectangle& area, uint32_t tileSize) {
+    std::vector<PixelRectangle> tiles;
+    if (area.IsEmpty()) {
+        return tiles;
+    }
+
+    tileSize = std::max(tileSize, 1u);
+
+    const uint32_t firstTileTop = area.position.top - area.position.top % tileSize;
+    const uint32_t firstTileLeft = area.position.left - area.position.left % tileSize;
+
+    for (uint64_t tileTop = firstTileTop; tileTop < area.Bottom(); tileTop += tileSize) {
+        for (uint64_t tileLeft = firstTileLeft; tileLeft < area.Right(); tileLeft += tileSize) {
+            const PixelRectangle tile{
+                { static_cast<uint32_t>(tileLeft), static_cast<uint32_t>(tileTop) },
+                { tileSize, tileSize } };
+            tiles.push_back(tile.Intersected(area));
+        }
+    }
+
+    return tiles;
+}
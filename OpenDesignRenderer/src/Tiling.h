@@ -0,0 +1,17 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <vector>
+
+#include <OpenDesignRenderer/PixelRectangle.h>
+
+namespace odr {
+/*!
+    \brief Split an area into the parts covered by the tiles of a grid.
+    \param area The area to split.
+    \param tileSize Width and height of the square tiles, the grid starts at the origin.
+    \return Non-empty parts of the area in row-major tile order.
+*/
+std::vector<PixelRectangle> SplitIntoTiles(const PixelRectangle& area, uint32_t tileSize);
+}
@@ -0,0 +1,156 @@
+#include <memory>
+#include <gtest/gtest.h>
+
+#include <OpenDesignRenderer/Image.h>
+#include <OpenDesignRenderer/ImageAllocator.h>
+#include <OpenDesignRenderer/ImagePoolAllocator.h>
+#include <OpenDesignRenderer/PixelColor.h>
+#include <OpenDesignRenderer/RenderingEngine.h>
+
+
+namespace {
+constexpr odr::PixelColor COLOR_LIGHT_GREEN{ 0x70, 0xF0, 0x70, 0x80 };
+}
+
+//! ImageAllocator and ImagePoolAllocator class tests.
+class ImageAllocatorTests : public ::testing::Test {
+protected:
+    virtual void SetUp() override {
+    }
+};
+
+TEST_F(ImageAllocatorTests, Statistics) {
+    const auto allocator = std::make_shared<odr::ImageAllocator>();
+    {
+        odr::ImageAllocatorScope scope(allocator);
+        ASSERT_EQ(odr::ImageAllocator::GetCurrent(), allocator);
+
+        odr::Image image;
+        ASSERT_TRUE(image.Initialize({ 33, 10 }, COLOR_LIGHT_GREEN));
+        ASSERT_EQ(reinterpret_cast<uintptr_t>(image.GetRowData(0)) % odr::ImageAllocator::ALIGNMENT, 0u);
+        ASSERT_EQ(allocator->GetLiveByteSize(), 33u * 10u * 4u);
+
+        odr::Image otherImage;
+        ASSERT_TRUE(otherImage.Initialize({ 10, 10 }, COLOR_LIGHT_GREEN));
+        ASSERT_EQ(allocator->GetLiveByteSize(), 33u * 10u * 4u + 10u * 10u * 4u);
+
+        image.Clear();
+        ASSERT_EQ(allocator->GetLiveByteSize(), 10u * 10u * 4u);
+    }
+
+    ASSERT_EQ(odr::ImageAllocator::GetCurrent(), odr::ImageAllocator::GetDefault());
+    ASSERT_EQ(allocator->GetLiveByteSize(), 0u);
+    ASSERT_EQ(allocator->GetPeakLiveByteSize(), 33u * 10u * 4u + 10u * 10u * 4u);
+    ASSERT_EQ(allocator->GetAllocationCount(), 2u);
+    ASSERT_EQ(allocator->GetReuseRate(), 0.0);
+}
+
+TEST_F(ImageAllocatorTests, NestedScopes) {
+    const auto outerAllocator = std::make_shared<odr::ImageAllocator>();
+    const auto innerAllocator = std::make_shared<odr::ImagePoolAllocator>();
+
+    odr::ImageAllocatorScope outerScope(outerAllocator);
+    {
+        odr::ImageAllocatorScope innerScope(innerAllocator);
+        ASSERT_EQ(odr::ImageAllocator::GetCurrent(), innerAllocator);
+    }
+    ASSERT_EQ(odr::ImageAllocator::GetCurrent(), outerAllocator);
+}
+
+TEST_F(ImageAllocatorTests, PoolReuse) {
+    const odr::ImageDimensions dimensions{ 100, 70 };
+    const size_t sizeClass = odr::ImagePoolAllocator::GetSizeClass(dimensions.DataSize());
+
+    odr::Image keptImage;
+    {
+        auto pool = std::make_shared<odr::ImagePoolAllocator>();
+        odr::ImageAllocatorScope scope(pool);
+
+        // Temporaries of the same size recycle one buffer
+        for (uint32_t i = 0; i < 10; i++) {
+            odr::Image temporaryImage;
+            ASSERT_TRUE(temporaryImage.Initialize(dimensions, COLOR_LIGHT_GREEN));
+            ASSERT_EQ(pool->GetLiveByteSize(), sizeClass);
+        }
+        ASSERT_EQ(pool->GetAllocationCount(), 10u);
+        ASSERT_EQ(pool->GetReusedAllocationCount(), 9u);
+        ASSERT_DOUBLE_EQ(pool->GetReuseRate(), 0.9);
+        ASSERT_EQ(pool->GetCachedByteSize(), sizeClass);
+
+        // Sizes of the same class share the buffers
+        ASSERT_TRUE(keptImage.Initialize({ 99, 70 }, COLOR_LIGHT_GREEN));
+        ASSERT_EQ(pool->GetReusedAllocationCount(), 10u);
+        ASSERT_EQ(pool->GetCachedByteSize(), 0u);
+
+        odr::Image otherImage;
+        ASSERT_TRUE(otherImage.Initialize(dimensions, COLOR_LIGHT_GREEN));
+        otherImage.Clear();
+        pool->ReleaseCached();
+        ASSERT_EQ(pool->GetCachedByteSize(), 0u);
+        ASSERT_EQ(pool->GetPeakLiveByteSize(), 2 * sizeClass);
+    }
+
+    // The pool lives as long as the memory allocated from it
+    ASSERT_EQ(keptImage.GetColor({ 98, 69 }), COLOR_LIGHT_GREEN);
+    keptImage.Clear();
+}
+
+TEST_F(ImageAllocatorTests, PoolLimit) {
+    auto pool = std::make_shared<odr::ImagePoolAllocator>(10000);
+    odr::ImageAllocatorScope scope(pool);
+
+    odr::Image smallImage;
+    odr::Image largeImage;
+    ASSERT_TRUE(smallImage.Initialize({ 20, 20 }, COLOR_LIGHT_GREEN));
+    ASSERT_TRUE(largeImage.Initialize({ 100, 100 }, COLOR_LIGHT_GREEN));
+    smallImage.Clear();
+    largeImage.Clear();
+
+    ASSERT_EQ(pool->GetCachedByteSize(), odr::ImagePoolAllocator::GetSizeClass(20 * 20 * 4));
+    ASSERT_EQ(pool->GetLiveByteSize(), 0u);
+}
+
+TEST_F(ImageAllocatorTests, SizeClasses) {
+    for (size_t size = 1; size < 10000000; size = size * 3 / 2 + 1) {
+        const size_t sizeClass = odr::ImagePoolAllocator::GetSizeClass(size);
+        ASSERT_GE(sizeClass, size);
+        ASSERT_EQ(sizeClass % odr::ImageAllocator::ALIGNMENT, 0u);
+        if (size >= 4 * odr::ImageAllocator::ALIGNMENT) {
+            ASSERT_LE(sizeClass, size + size / 4);
+        }
+    }
+}
+
+TEST_F(ImageAllocatorTests, RenderJob) {
+    odr::Image imgC;
+    ASSERT_TRUE(imgC.Load(std::string(TESTING_IMAGES_DIR) + "image-C.rgba"));
+
+    odr::Image referenceImage;
+    {
+        odr::RenderingEngineSettings settings;
+        settings.renderMode = odr::RenderMode::Deferred;
+        odr::RenderingEngine engine(settings);
+        ASSERT_TRUE(engine.InitializeFrameBuffer({ 320, 240 }));
+        for (int32_t i = 0; i < 5; i++) {
+            ASSERT_TRUE(engine.Draw(imgC, { i * 30, i * 20 }, { 100, 100 }));
+        }
+        ASSERT_TRUE(engine.Render(referenceImage));
+    }
+
+    // Frames of a job recycle the recorded images
+    auto pool = std::make_shared<odr::ImagePoolAllocator>();
+    odr::ImageAllocatorScope scope(pool);
+    odr::RenderingEngineSettings settings;
+    settings.renderMode = odr::RenderMode::Deferred;
+    odr::RenderingEngine engine(settings);
+    for (uint32_t frame = 0; frame < 3; frame++) {
+        ASSERT_TRUE(engine.InitializeFrameBuffer({ 320, 240 }));
+        for (int32_t i = 0; i < 5; i++) {
+            ASSERT_TRUE(engine.Draw(imgC, { i * 30, i * 20 }, { 100, 100 }));
+        }
+        odr::Image renderedImage;
+        ASSERT_TRUE(engine.Render(renderedImage));
+        ASSERT_EQ(renderedImage, referenceImage);
+    }
+    ASSERT_GT(pool->GetReuseRate(), 0.5);
+}
@@ -1,4 +1,9 @@
+#include <algorithm>
+#include <cmath>
 #include <memory>
+#include <thread>
+#include <unordered_set>
+#include <vector>
 #include <gtest/gtest.h>
 
 #include <OpenDesignRenderer/PixelCoordinates.h>
@@ -136,6 +141,50 @@ TEST_F(ImageTests, CloneFrom) {
     ASSERT_EQ(imgA, imgACopy);
 }
 
+TEST_F(ImageTests, CloneFromThreaded) {
+    odr::Image asset;
+    ASSERT_TRUE(asset.Load(std::string(TESTING_IMAGES_DIR) + "image-A.rgba"));
+    odr::Image reference;
+    ASSERT_TRUE(reference.CloneFrom(asset));
+    ASSERT_TRUE(reference.DetachData());
+
+    // Render threads read shared clones of the asset, then release or change them
+    for (uint32_t round = 0; round < 20; round++) {
+        std::vector<odr::Image> clones(4);
+        for (odr::Image& clone : clones) {
+            ASSERT_TRUE(clone.CloneFrom(asset));
+        }
+
+        std::vector<std::thread> threads;
+        for (uint32_t i = 0; i < clones.size(); i++) {
+            threads.emplace_back([&, i]() {
+                odr::Image& clone = clones[i];
+                EXPECT_EQ(clone.GetColor({ i, round }), reference.GetColor({ i, round }));
+                if (i % 2 == 0) {
+                    clone.Clear();
+                    return;
+                }
+                EXPECT_TRUE(clone.SetColor(COLOR_LIGHT_GREEN, { i, round }));
+                EXPECT_FALSE(clone.IsDataShared());
+                EXPECT_EQ(clone.GetColor({ i, round }), COLOR_LIGHT_GREEN);
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+
+        // The changed clones have private copies, the asset is the only owner of its data again
+        ASSERT_FALSE(asset.IsDataShared());
+        ASSERT_TRUE(asset == reference);
+    }
+
+    // The only owner changes the data in place
+    const unsigned char* assetData = static_cast<const odr::Image&>(asset).GetRowData(0);
+    ASSERT_TRUE(asset.SetColor(COLOR_DARK_GREEN, { 0, 0 }));
+    ASSERT_EQ(static_cast<const odr::Image&>(asset).GetRowData(0), assetData);
+    ASSERT_FALSE(asset == reference);
+}
+
 TEST_F(ImageTests, Scaled) {
     odr::Image imgA;
     odr::Image imgC;
@@ -223,3 +272,740 @@ TEST_F(ImageTests, Scaled) {
         ASSERT_TRUE(isImgCScaledSaved);
     }
 }
+
+TEST_F(ImageTests, PixelFormatPremultiplied) {
+    odr::Image imgA;
+    odr::Image imgAPremultiplied;
+
+    const bool isImgALoaded = imgA.Load(std::string(TESTING_IMAGES_DIR) + "image-A.rgba");
+    ASSERT_TRUE(isImgALoaded);
+    const bool isImgAPremultipliedLoaded = imgAPremultiplied.Load(std::string(TESTING_IMAGES_DIR) + "image-A.rgba", odr::PixelFormat::Premultiplied);
+    ASSERT_TRUE(isImgAPremultipliedLoaded);
+
+    ASSERT_EQ(imgAPremultiplied.GetPixelFormat(), odr::PixelFormat::Premultiplied);
+    ASSERT_EQ(imgAPremultiplied.GetDimensions(), imgA.GetDimensions());
+
+    // Transparent pixel loses its color, opaque pixels are unchanged
+    ASSERT_EQ(imgAPremultiplied.GetColor({ 0, 0 }), odr::COLOR_TRANSPARENT);
+    ASSERT_EQ(imgAPremultiplied.GetColor({ 215, 170 }), imgA.GetColor({ 215, 170 }));
+
+    // Pixels are set and saved in straight alpha, 8-bit premultiplied colors lose precision
+    const odr::PixelColor colorDarkGreenRounded{ 0x30, 0xEF, 0x30, 0x80 };
+    ASSERT_TRUE(imgAPremultiplied.SetColor(COLOR_DARK_GREEN, { 1, 1 }));
+    ASSERT_EQ(imgAPremultiplied.GetColor({ 1, 1 }), colorDarkGreenRounded);
+
+    const bool isSaved = imgAPremultiplied.Save(std::string(TESTING_IMAGES_DIR) + "tmp_image-A-premultiplied.rgba");
+    ASSERT_TRUE(isSaved);
+
+    odr::Image imgASaved;
+    const bool isSavedLoaded = imgASaved.Load(std::string(TESTING_IMAGES_DIR) + "tmp_image-A-premultiplied.rgba");
+    ASSERT_TRUE(isSavedLoaded);
+    ASSERT_EQ(imgASaved.GetColor({ 1, 1 }), colorDarkGreenRounded);
+    ASSERT_EQ(imgASaved.GetColor({ 480, 150 }), imgA.GetColor({ 480, 150 }));
+
+    // Converting back keeps the dimensions and the format
+    ASSERT_TRUE(imgAPremultiplied.ConvertToPixelFormat(odr::PixelFormat::Straight));
+    ASSERT_EQ(imgAPremultiplied.GetPixelFormat(), odr::PixelFormat::Straight);
+    ASSERT_EQ(imgAPremultiplied.GetColor({ 215, 170 }), imgA.GetColor({ 215, 170 }));
+
+    // Scaling keeps the format
+    const odr::Image imgAScaled = imgASaved.Scaled({ 100, 100 });
+    ASSERT_EQ(imgAScaled.GetPixelFormat(), odr::PixelFormat::Straight);
+}
+
+TEST_F(ImageTests, ScaledFilters) {
+    const odr::ResamplingFilter separableFilters[] = {
+        odr::ResamplingFilter::Bilinear,
+        odr::ResamplingFilter::Bicubic,
+        odr::ResamplingFilter::Lanczos3,
+    };
+
+    // Uniform images stay uniform at fractional ratios, in both directions
+    odr::Image uniformImage;
+    ASSERT_TRUE(uniformImage.Initialize({ 37, 23 }, COLOR_LIGHT_GREEN));
+    for (const odr::ResamplingFilter filter : separableFilters) {
+        for (const odr::ImageDimensions& scaledDimensions : { odr::ImageDimensions{ 10, 7 }, odr::ImageDimensions{ 101, 59 } }) {
+            const odr::Image scaledImage = uniformImage.Scaled(scaledDimensions, filter);
+            ASSERT_EQ(scaledImage.GetDimensions(), scaledDimensions);
+
+            for (uint32_t y = 0; y < scaledDimensions.height; y++) {
+                for (uint32_t x = 0; x < scaledDimensions.width; x++) {
+                    ASSERT_EQ(scaledImage.GetColor({ x, y }), COLOR_LIGHT_GREEN);
+                }
+            }
+        }
+    }
+
+    // Upscaled 2x1 image: box repeats the pixels, interpolating filters blend them
+    odr::Image twoPixelImage;
+    ASSERT_TRUE(twoPixelImage.Initialize({ 2, 1 }, odr::PixelColor{ 0, 0, 0, 0xFF }));
+    ASSERT_TRUE(twoPixelImage.SetColor(odr::PixelColor{ 0xFF, 0xFF, 0xFF, 0xFF }, { 1, 0 }));
+
+    const odr::Image boxImage = twoPixelImage.Scaled({ 8, 1 });
+    ASSERT_EQ(boxImage.GetColor({ 3, 0 }).r, 0x00);
+    ASSERT_EQ(boxImage.GetColor({ 4, 0 }).r, 0xFF);
+
+    const odr::Image bilinearImage = twoPixelImage.Scaled({ 8, 1 }, odr::ResamplingFilter::Bilinear);
+    for (uint32_t x = 1; x < 8; x++) {
+        ASSERT_GE(bilinearImage.GetColor({ x, 0 }).r, bilinearImage.GetColor({ x - 1, 0 }).r);
+    }
+    ASSERT_GT(bilinearImage.GetColor({ 3, 0 }).r, 0x00);
+    ASSERT_LT(bilinearImage.GetColor({ 4, 0 }).r, 0xFF);
+
+    // Colors of transparent pixels do not bleed into visible ones
+    odr::Image edgeImage;
+    ASSERT_TRUE(edgeImage.Initialize({ 8, 8 }, odr::PixelColor{ 0xFF, 0x00, 0x00, 0x00 }));
+    for (uint32_t y = 0; y < 8; y++) {
+        for (uint32_t x = 4; x < 8; x++) {
+            ASSERT_TRUE(edgeImage.SetColor(odr::PixelColor{ 0x00, 0x00, 0xFF, 0xFF }, { x, y }));
+        }
+    }
+    for (const odr::ResamplingFilter filter : separableFilters) {
+        const odr::Image scaledImage = edgeImage.Scaled({ 13, 5 }, filter);
+        for (uint32_t x = 0; x < 13; x++) {
+            const odr::PixelColor color = scaledImage.GetColor({ x, 2 });
+            if (color.a > 0) {
+                ASSERT_EQ(color.r, 0x00);
+                ASSERT_EQ(color.b, 0xFF);
+            }
+        }
+    }
+
+    // Opaque images give the same colors in both pixel formats, up to rounding
+    odr::Image imgA;
+    ASSERT_TRUE(imgA.Load(std::string(TESTING_IMAGES_DIR) + "image-A.rgba"));
+    const odr::ImageDimensions& imgADimensions = imgA.GetDimensions();
+    for (uint32_t y = 0; y < imgADimensions.height; y++) {
+        for (uint32_t x = 0; x < imgADimensions.width; x++) {
+            odr::PixelColor color = imgA.GetColor({ x, y });
+            color.a = 0xFF;
+            ASSERT_TRUE(imgA.SetColor(color, { x, y }));
+        }
+    }
+    odr::Image imgAPremultiplied;
+    ASSERT_TRUE(imgAPremultiplied.CloneFrom(imgA));
+    ASSERT_TRUE(imgAPremultiplied.ConvertToPixelFormat(odr::PixelFormat::Premultiplied));
+
+    for (const odr::ResamplingFilter filter : separableFilters) {
+        const odr::Image scaledImage = imgA.Scaled({ 97, 151 }, filter);
+        odr::Image scaledPremultipliedImage = imgAPremultiplied.Scaled({ 97, 151 }, filter);
+        ASSERT_EQ(scaledPremultipliedImage.GetPixelFormat(), odr::PixelFormat::Premultiplied);
+
+        for (uint32_t y = 0; y < 151; y++) {
+            for (uint32_t x = 0; x < 97; x++) {
+                const odr::PixelColor color = scaledImage.GetColor({ x, y });
+                const odr::PixelColor premultipliedColor = scaledPremultipliedImage.GetColor({ x, y });
+                ASSERT_EQ(color.a, premultipliedColor.a);
+                ASSERT_NEAR(color.r, premultipliedColor.r, 1);
+                ASSERT_NEAR(color.g, premultipliedColor.g, 1);
+                ASSERT_NEAR(color.b, premultipliedColor.b, 1);
+            }
+        }
+    }
+}
+
+TEST_F(ImageTests, ScaledSummedAreaBox) {
+    odr::Image imgA;
+    ASSERT_TRUE(imgA.Load(std::string(TESTING_IMAGES_DIR) + "image-A.rgba"));
+    const odr::ImageDimensions& sourceDimensions = imgA.GetDimensions();
+
+    // Alpha weighted average of the covered source area, at fractional ratios in both directions
+    for (const odr::ImageDimensions& scaledDimensions : { odr::ImageDimensions{ 37, 53 }, odr::ImageDimensions{ 613, 211 } }) {
+        const odr::Image scaledImage = imgA.Scaled(scaledDimensions, odr::ResamplingFilter::SummedAreaBox);
+        ASSERT_EQ(scaledImage.GetDimensions(), scaledDimensions);
+
+        for (uint32_t y = 0; y < scaledDimensions.height; y += 7) {
+            for (uint32_t x = 0; x < scaledDimensions.width; x += 7) {
+                const uint64_t xBeg = uint64_t{ x } * sourceDimensions.width / scaledDimensions.width;
+                const uint64_t xEnd = std::max(xBeg + 1, ((uint64_t{ x } + 1) * sourceDimensions.width + scaledDimensions.width - 1) / scaledDimensions.width);
+                const uint64_t yBeg = uint64_t{ y } * sourceDimensions.height / scaledDimensions.height;
+                const uint64_t yEnd = std::max(yBeg + 1, ((uint64_t{ y } + 1) * sourceDimensions.height + scaledDimensions.height - 1) / scaledDimensions.height);
+
+                uint64_t sums[4] = { 0, 0, 0, 0 };
+                for (uint64_t sourceY = yBeg; sourceY < yEnd; sourceY++) {
+                    for (uint64_t sourceX = xBeg; sourceX < xEnd; sourceX++) {
+                        const odr::PixelColor color = imgA.GetColor({ static_cast<uint32_t>(sourceX), static_cast<uint32_t>(sourceY) });
+                        sums[0] += uint64_t{ color.r } * color.a;
+                        sums[1] += uint64_t{ color.g } * color.a;
+                        sums[2] += uint64_t{ color.b } * color.a;
+                        sums[3] += color.a;
+                    }
+                }
+
+                const uint64_t pixelCount = (xEnd - xBeg) * (yEnd - yBeg);
+                const odr::PixelColor color = scaledImage.GetColor({ x, y });
+                ASSERT_EQ(color.a, (sums[3] + pixelCount / 2) / pixelCount);
+                if (color.a > 0) {
+                    ASSERT_EQ(color.r, (sums[0] + sums[3] / 2) / sums[3]);
+                    ASSERT_EQ(color.g, (sums[1] + sums[3] / 2) / sums[3]);
+                    ASSERT_EQ(color.b, (sums[2] + sums[3] / 2) / sums[3]);
+                }
+            }
+        }
+    }
+
+    // Same as the original box filter for premultiplied images at integer ratios
+    odr::Image imgC;
+    ASSERT_TRUE(imgC.Load(std::string(TESTING_IMAGES_DIR) + "image-C.rgba", odr::PixelFormat::Premultiplied));
+    const odr::ImageDimensions quarterDimensions{ imgC.GetDimensions().width / 4, imgC.GetDimensions().height / 4 };
+    ASSERT_EQ(imgC.Scaled(quarterDimensions, odr::ResamplingFilter::SummedAreaBox), imgC.Scaled(quarterDimensions));
+
+    // Large ratios average whole areas at constant cost per pixel
+    odr::Image largeImage;
+    ASSERT_TRUE(largeImage.Initialize({ 2000, 1500 }, COLOR_DARK_GREEN));
+    const odr::Image thumbnail = largeImage.Scaled({ 7, 5 }, odr::ResamplingFilter::SummedAreaBox);
+    for (uint32_t y = 0; y < 5; y++) {
+        for (uint32_t x = 0; x < 7; x++) {
+            ASSERT_EQ(thumbnail.GetColor({ x, y }), COLOR_DARK_GREEN);
+        }
+    }
+}
+
+TEST_F(ImageTests, ScaledFromMipmaps) {
+    odr::Image imgC;
+    ASSERT_TRUE(imgC.Load(std::string(TESTING_IMAGES_DIR) + "image-C.rgba", odr::PixelFormat::Premultiplied));
+    const odr::ImageDimensions quarterDimensions{ imgC.GetDimensions().width / 4, imgC.GetDimensions().height / 4 };
+    const odr::Image referenceImage = imgC.Scaled(quarterDimensions, odr::ResamplingFilter::SummedAreaBox);
+
+    // Built on the first downscale by half or more, at most a third of the image memory
+    imgC.SetMipmapsEnabled(true);
+    ASSERT_EQ(imgC.GetMipmapByteSize(), 0u);
+    const odr::Image slightlySmallerImage = imgC.Scaled({ imgC.GetDimensions().width - 1, imgC.GetDimensions().height - 1 });
+    ASSERT_EQ(imgC.GetMipmapByteSize(), 0u);
+
+    const odr::Image mipmappedImage = imgC.Scaled(quarterDimensions, odr::ResamplingFilter::SummedAreaBox);
+    ASSERT_GT(imgC.GetMipmapByteSize(), 0u);
+    ASSERT_LE(imgC.GetMipmapByteSize(), imgC.GetDimensions().DataSize() / 3);
+
+    // Averages of 2x2 averages differ from the direct average only by rounding
+    ASSERT_EQ(mipmappedImage.GetDimensions(), quarterDimensions);
+    for (uint32_t y = 0; y < quarterDimensions.height; y++) {
+        const unsigned char* mipmappedRow = mipmappedImage.GetRowData(y);
+        const unsigned char* referenceRow = referenceImage.GetRowData(y);
+        for (uint32_t channel = 0; channel < quarterDimensions.width * 4; channel++) {
+            ASSERT_NEAR(mipmappedRow[channel], referenceRow[channel], 1);
+        }
+    }
+
+    // Discarded under memory pressure, rebuilt when needed
+    imgC.DiscardMipmaps();
+    ASSERT_EQ(imgC.GetMipmapByteSize(), 0u);
+    ASSERT_EQ(imgC.Scaled(quarterDimensions, odr::ResamplingFilter::SummedAreaBox), mipmappedImage);
+
+    // Changes of the image are not hidden by outdated levels
+    odr::Image uniformImage;
+    ASSERT_TRUE(uniformImage.Initialize({ 64, 64 }, COLOR_LIGHT_GREEN));
+    uniformImage.SetMipmapsEnabled(true);
+    ASSERT_EQ(uniformImage.Scaled({ 1, 1 }).GetColor({ 0, 0 }), COLOR_LIGHT_GREEN);
+    ASSERT_TRUE(uniformImage.Initialize({ 64, 64 }, COLOR_DARK_GREEN));
+    ASSERT_EQ(uniformImage.Scaled({ 1, 1 }).GetColor({ 0, 0 }), COLOR_DARK_GREEN);
+
+    uniformImage.SetMipmapsEnabled(false);
+    ASSERT_EQ(uniformImage.GetMipmapByteSize(), 0u);
+
+    // Levels of elongated images stop at a side of 1 pixel, still at most a third of the image memory
+    odr::Image elongatedImage;
+    ASSERT_TRUE(elongatedImage.Initialize({ 4096, 4 }, COLOR_LIGHT_GREEN));
+    elongatedImage.SetMipmapsEnabled(true);
+    ASSERT_EQ(elongatedImage.Scaled({ 1024, 1 }).GetColor({ 0, 0 }), COLOR_LIGHT_GREEN);
+    ASSERT_EQ(elongatedImage.GetMipmapByteSize(), (2048u * 2u + 1024u) * 4u);
+    ASSERT_LE(elongatedImage.GetMipmapByteSize(), elongatedImage.GetDimensions().DataSize() / 3);
+}
+
+TEST_F(ImageTests, LoadMapped) {
+    const std::string imgAPath = std::string(TESTING_IMAGES_DIR) + "image-A.rgba";
+    odr::Image imgA;
+    ASSERT_TRUE(imgA.Load(imgAPath));
+    ASSERT_FALSE(imgA.IsFileMapped());
+
+    odr::Image imgAMapped;
+    ASSERT_TRUE(imgAMapped.LoadMapped(imgAPath));
+    ASSERT_EQ(imgAMapped, imgA);
+#if defined(__unix__) || defined(__APPLE__)
+    ASSERT_TRUE(imgAMapped.IsFileMapped());
+#endif
+
+    // Changes are private to the image, the file stays intact
+    ASSERT_TRUE(imgAMapped.SetColor(COLOR_DARK_GREEN, { 10, 10 }));
+    ASSERT_EQ(imgAMapped.GetColor({ 10, 10 }), COLOR_DARK_GREEN);
+    odr::Image imgAMappedAgain;
+    ASSERT_TRUE(imgAMappedAgain.LoadMapped(imgAPath));
+    ASSERT_EQ(imgAMappedAgain, imgA);
+
+    // Converted like Load
+    odr::Image imgAPremultiplied;
+    ASSERT_TRUE(imgAPremultiplied.Load(imgAPath, odr::PixelFormat::Premultiplied));
+    ASSERT_TRUE(imgAMappedAgain.LoadMapped(imgAPath, odr::PixelFormat::Premultiplied));
+    ASSERT_EQ(imgAMappedAgain, imgAPremultiplied);
+
+    // Unmapped when cleared or reused
+    ASSERT_TRUE(imgAMappedAgain.Initialize({ 3, 3 }, COLOR_LIGHT_GREEN));
+    ASSERT_FALSE(imgAMappedAgain.IsFileMapped());
+
+    ASSERT_FALSE(imgAMappedAgain.LoadMapped(std::string(TESTING_IMAGES_DIR) + "missing-image.rgba"));
+    ASSERT_FALSE(imgAMappedAgain.IsInitialized());
+}
+
+TEST_F(ImageTests, SaveSettings) {
+    odr::Image imgA;
+    ASSERT_TRUE(imgA.Load(std::string(TESTING_IMAGES_DIR) + "image-A.rgba"));
+
+    // Direct writes of sizes not aligned to blocks, synced and premultiplied
+    odr::Image imgAPremultiplied;
+    ASSERT_TRUE(imgAPremultiplied.Load(std::string(TESTING_IMAGES_DIR) + "image-A.rgba", odr::PixelFormat::Premultiplied));
+    odr::Image imgAStraight;
+    ASSERT_TRUE(imgAStraight.CloneFrom(imgAPremultiplied));
+    ASSERT_TRUE(imgAStraight.ConvertToPixelFormat(odr::PixelFormat::Straight));
+
+    for (const bool isDirect : { false, true }) {
+        for (const bool isSynced : { false, true }) {
+            odr::ImageSaveSettings settings;
+            settings.isDirect = isDirect;
+            settings.isSynced = isSynced;
+
+            const std::string filepath = std::string(TESTING_IMAGES_DIR) + "tmp_image-A-saved.rgba";
+            odr::Image savedImage;
+            ASSERT_TRUE(imgA.Save(filepath, settings));
+            ASSERT_TRUE(savedImage.Load(filepath));
+            ASSERT_EQ(savedImage, imgA);
+
+            ASSERT_TRUE(imgAPremultiplied.Save(filepath, settings));
+            ASSERT_TRUE(savedImage.Load(filepath));
+            ASSERT_EQ(savedImage, imgAStraight);
+        }
+    }
+
+    ASSERT_FALSE(imgA.Save(std::string(TESTING_IMAGES_DIR) + "missing-directory/tmp_image-A.rgba"));
+}
+
+TEST_F(ImageTests, MoveSemantics) {
+    odr::Image imgA;
+    ASSERT_TRUE(imgA.Load(std::string(TESTING_IMAGES_DIR) + "image-A.rgba"));
+    odr::Image imgACopy;
+    ASSERT_TRUE(imgACopy.CloneFrom(imgA));
+
+    // The data is taken over, not copied
+    const unsigned char* imgAData = imgA.GetRowData(0);
+    const uint64_t imgAContentId = imgA.GetContentId();
+    odr::Image movedImage(std::move(imgA));
+    ASSERT_FALSE(imgA.IsInitialized());
+    ASSERT_EQ(movedImage.GetRowData(0), imgAData);
+    ASSERT_EQ(movedImage.GetContentId(), imgAContentId);
+    ASSERT_EQ(movedImage, imgACopy);
+
+    odr::Image assignedImage;
+    ASSERT_TRUE(assignedImage.Initialize({ 5, 5 }, COLOR_LIGHT_GREEN));
+    assignedImage = std::move(movedImage);
+    ASSERT_FALSE(movedImage.IsInitialized());
+    ASSERT_EQ(assignedImage.GetRowData(0), imgAData);
+
+    // Moved-from images are reusable
+    ASSERT_TRUE(movedImage.Initialize({ 5, 5 }, COLOR_DARK_GREEN));
+    ASSERT_EQ(movedImage.GetColor({ 4, 4 }), COLOR_DARK_GREEN);
+
+    // Mapped images stay mapped
+    odr::Image mappedImage;
+    ASSERT_TRUE(mappedImage.LoadMapped(std::string(TESTING_IMAGES_DIR) + "image-A.rgba"));
+    std::vector<odr::Image> images;
+    images.push_back(std::move(mappedImage));
+    images.push_back(std::move(assignedImage));
+    images.emplace_back();
+    ASSERT_EQ(images[0], imgACopy);
+    ASSERT_EQ(images[1], imgACopy);
+
+    // Buffers of the same size are reused
+    const unsigned char* copyData = imgACopy.GetRowData(0);
+    ASSERT_TRUE(imgACopy.Initialize(imgACopy.GetDimensions(), COLOR_LIGHT_GREEN));
+    ASSERT_EQ(imgACopy.GetRowData(0), copyData);
+}
+
+TEST_F(ImageTests, CopyOnWrite) {
+    odr::Image imgA;
+    ASSERT_TRUE(imgA.Load(std::string(TESTING_IMAGES_DIR) + "image-A.rgba"));
+    ASSERT_FALSE(imgA.IsDataShared());
+
+    // Clones share the data
+    odr::Image imgAClone;
+    ASSERT_TRUE(imgAClone.CloneFrom(imgA));
+    ASSERT_TRUE(imgA.IsDataShared());
+    ASSERT_TRUE(imgAClone.IsDataShared());
+    const odr::Image& constImgA = imgA;
+    const odr::Image& constImgAClone = imgAClone;
+    ASSERT_EQ(constImgAClone.GetRowData(0), constImgA.GetRowData(0));
+    ASSERT_EQ(imgAClone, imgA);
+
+    // The first change copies the data, the other image keeps it
+    const odr::PixelColor originalColor = imgA.GetColor({ 3, 4 });
+    ASSERT_TRUE(imgAClone.SetColor(COLOR_DARK_GREEN, { 3, 4 }));
+    ASSERT_FALSE(imgA.IsDataShared());
+    ASSERT_FALSE(imgAClone.IsDataShared());
+    ASSERT_EQ(imgAClone.GetColor({ 3, 4 }), COLOR_DARK_GREEN);
+    ASSERT_EQ(imgA.GetColor({ 3, 4 }), originalColor);
+
+    // Through conversions and row pointers as well
+    odr::Image imgAPremultiplied;
+    ASSERT_TRUE(imgAPremultiplied.CloneFrom(imgA));
+    ASSERT_TRUE(imgAPremultiplied.ConvertToPixelFormat(odr::PixelFormat::Premultiplied));
+    ASSERT_EQ(imgA.GetPixelFormat(), odr::PixelFormat::Straight);
+    ASSERT_EQ(imgA.GetColor({ 3, 4 }), originalColor);
+
+    odr::Image imgAChanged;
+    ASSERT_TRUE(imgAChanged.CloneFrom(imgA));
+    imgAChanged.GetRowData(4)[3 * 4] ^= 0xFF;
+    imgAChanged.MarkContentChanged();
+    ASSERT_EQ(imgA.GetColor({ 3, 4 }), originalColor);
+    ASSERT_FALSE(imgAChanged == imgA);
+
+    // The data outlives the image it was cloned from, also on other threads
+    odr::Image imgAThreadClone;
+    {
+        odr::Image imgASource;
+        ASSERT_TRUE(imgASource.LoadMapped(std::string(TESTING_IMAGES_DIR) + "image-A.rgba"));
+        ASSERT_TRUE(imgAThreadClone.CloneFrom(imgASource));
+    }
+    ASSERT_FALSE(imgAThreadClone.IsDataShared());
+
+    std::vector<odr::Image> threadImages(4);
+    std::vector<std::thread> threads;
+    for (odr::Image& threadImage : threadImages) {
+        ASSERT_TRUE(threadImage.CloneFrom(imgA));
+    }
+    for (uint32_t threadIndex = 0; threadIndex < threadImages.size(); threadIndex++) {
+        threads.emplace_back([&threadImages, threadIndex]() {
+            odr::Image& threadImage = threadImages[threadIndex];
+            threadImage.SetColor(COLOR_LIGHT_GREEN, { threadIndex, 0 });
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    for (uint32_t threadIndex = 0; threadIndex < threadImages.size(); threadIndex++) {
+        ASSERT_EQ(threadImages[threadIndex].GetColor({ threadIndex, 0 }), COLOR_LIGHT_GREEN);
+        ASSERT_EQ(imgA.GetColor({ threadIndex, 0 }), imgAThreadClone.GetColor({ threadIndex, 0 }));
+    }
+}
+
+TEST_F(ImageTests, BulkOperations) {
+    odr::Image image;
+    ASSERT_TRUE(image.Initialize({ 37, 23 }, odr::COLOR_TRANSPARENT));
+    ASSERT_EQ(image.GetRowStride(), 37u * 4u);
+    ASSERT_EQ(image.GetRowData(1) - image.GetRowData(0), static_cast<ptrdiff_t>(image.GetRowStride()));
+
+    // Pattern and memset fills
+    for (const odr::PixelColor& color : { COLOR_LIGHT_GREEN, odr::PixelColor{ 0xFF, 0xFF, 0xFF, 0xFF }, odr::COLOR_TRANSPARENT }) {
+        ASSERT_TRUE(image.Fill(color));
+        for (uint32_t y = 0; y < 23; y++) {
+            for (uint32_t x = 0; x < 37; x++) {
+                ASSERT_EQ(image.GetColor({ x, y }), color);
+            }
+        }
+    }
+
+    // Clipped rectangle fills
+    ASSERT_TRUE(image.FillRect({ { 30, 20 }, { 100, 100 } }, COLOR_DARK_GREEN));
+    ASSERT_TRUE(image.FillRect({ { 2, 3 }, { 5, 4 } }, COLOR_LIGHT_GREEN));
+    ASSERT_TRUE(image.FillRect({ { 40, 0 }, { 5, 4 } }, COLOR_LIGHT_GREEN));
+    for (uint32_t y = 0; y < 23; y++) {
+        for (uint32_t x = 0; x < 37; x++) {
+            const bool isDarkGreen = x >= 30 && y >= 20;
+            const bool isLightGreen = x >= 2 && x < 7 && y >= 3 && y < 7;
+            const odr::PixelColor expectedColor = isDarkGreen ? COLOR_DARK_GREEN : (isLightGreen ? COLOR_LIGHT_GREEN : odr::COLOR_TRANSPARENT);
+            ASSERT_EQ(image.GetColor({ x, y }), expectedColor);
+        }
+    }
+
+    // Filled in the pixel format of the image
+    odr::Image premultipliedImage;
+    ASSERT_TRUE(premultipliedImage.Initialize({ 8, 8 }, odr::COLOR_TRANSPARENT, odr::PixelFormat::Premultiplied));
+    ASSERT_TRUE(premultipliedImage.FillRect({ { 1, 1 }, { 3, 3 } }, COLOR_LIGHT_GREEN));
+    odr::Image straightImage;
+    ASSERT_TRUE(straightImage.Initialize({ 8, 8 }, odr::COLOR_TRANSPARENT, odr::PixelFormat::Premultiplied));
+    for (uint32_t y = 1; y < 4; y++) {
+        for (uint32_t x = 1; x < 4; x++) {
+            ASSERT_TRUE(straightImage.SetColor(COLOR_LIGHT_GREEN, { x, y }));
+        }
+    }
+    ASSERT_EQ(premultipliedImage, straightImage);
+}
+
+TEST_F(ImageTests, CopyRect) {
+    odr::Image imgA;
+    ASSERT_TRUE(imgA.Load(std::string(TESTING_IMAGES_DIR) + "image-A.rgba"));
+
+    // Clipped to both images
+    odr::Image target;
+    ASSERT_TRUE(target.Initialize({ 50, 40 }, COLOR_DARK_GREEN));
+    ASSERT_TRUE(target.CopyRect(imgA, { { 100, 80 }, { 60, 60 } }, { 10, 5 }));
+    for (uint32_t y = 0; y < 40; y++) {
+        for (uint32_t x = 0; x < 50; x++) {
+            const bool isCopied = x >= 10 && y >= 5;
+            ASSERT_EQ(target.GetColor({ x, y }), isCopied ? imgA.GetColor({ x - 10 + 100, y - 5 + 80 }) : COLOR_DARK_GREEN);
+        }
+    }
+
+    // Converted between pixel formats
+    odr::Image premultipliedTarget;
+    ASSERT_TRUE(premultipliedTarget.Initialize({ 50, 40 }, COLOR_DARK_GREEN, odr::PixelFormat::Premultiplied));
+    ASSERT_TRUE(premultipliedTarget.CopyRect(imgA, { { 100, 80 }, { 60, 60 } }, { 10, 5 }));
+    ASSERT_TRUE(premultipliedTarget.ConvertToPixelFormat(odr::PixelFormat::Straight));
+    odr::Image expectedTarget;
+    ASSERT_TRUE(expectedTarget.CloneFrom(target));
+    ASSERT_TRUE(expectedTarget.ConvertToPixelFormat(odr::PixelFormat::Premultiplied));
+    ASSERT_TRUE(expectedTarget.ConvertToPixelFormat(odr::PixelFormat::Straight));
+    ASSERT_EQ(premultipliedTarget, expectedTarget);
+
+    // Overlapping areas of one image, in both directions
+    for (const int32_t shift : { 7, -7 }) {
+        odr::Image shiftedImage;
+        ASSERT_TRUE(shiftedImage.CloneFrom(imgA));
+        const odr::PixelCoordinates targetPosition{ static_cast<uint32_t>(50 + shift), static_cast<uint32_t>(60 + shift) };
+        ASSERT_TRUE(shiftedImage.CopyRect(shiftedImage, { { 50, 60 }, { 100, 100 } }, targetPosition));
+
+        for (uint32_t y = 0; y < 100; y++) {
+            for (uint32_t x = 0; x < 100; x++) {
+                ASSERT_EQ(shiftedImage.GetColor({ targetPosition.left + x, targetPosition.top + y }), imgA.GetColor({ 50 + x, 60 + y }));
+            }
+        }
+    }
+
+    ASSERT_FALSE(target.CopyRect(odr::Image(), { { 0, 0 }, { 10, 10 } }, { 0, 0 }));
+}
+
+TEST_F(ImageTests, AbsoluteDiffDifferentDimensions) {
+    odr::Image wideImage;
+    odr::Image tallImage;
+    ASSERT_TRUE(wideImage.Initialize({ 30, 10 }, COLOR_LIGHT_GREEN));
+    ASSERT_TRUE(tallImage.Initialize({ 10, 20 }, COLOR_DARK_GREEN));
+
+    // Pixels outside of one image keep the color of the other one
+    const odr::Image diffImage = odr::Image::AbsoluteDiff(wideImage, tallImage);
+    ASSERT_EQ(diffImage.GetDimensions(), (odr::ImageDimensions{ 30, 20 }));
+    ASSERT_EQ(diffImage.GetColor({ 5, 5 }), odr::PixelColor::AbsoluteDiff(COLOR_LIGHT_GREEN, COLOR_DARK_GREEN));
+    ASSERT_EQ(diffImage.GetColor({ 25, 5 }), COLOR_LIGHT_GREEN);
+    ASSERT_EQ(diffImage.GetColor({ 5, 15 }), COLOR_DARK_GREEN);
+    ASSERT_EQ(diffImage.GetColor({ 25, 15 }), (odr::PixelColor{ 0, 0, 0, 0 }));
+}
+
+TEST_F(ImageTests, Compare) {
+    odr::Image imgA;
+    ASSERT_TRUE(imgA.Load(std::string(TESTING_IMAGES_DIR) + "image-A.rgba"));
+
+    // Identical images
+    {
+        const odr::ImageComparison comparison = odr::Image::Compare(imgA, imgA);
+        ASSERT_TRUE(comparison.IsMatch());
+        ASSERT_EQ(comparison.pixelCount, imgA.GetDimensions().width * static_cast<uint64_t>(imgA.GetDimensions().height));
+        ASSERT_EQ(comparison.maxChannelError, 0);
+        ASSERT_EQ(comparison.rmsError, 0.0);
+        ASSERT_TRUE(std::isinf(comparison.psnr));
+    }
+
+    odr::Image changedImage;
+    ASSERT_TRUE(changedImage.CloneFrom(imgA));
+    ASSERT_TRUE(changedImage.FillRect({ { 10, 20 }, { 30, 5 } }, COLOR_DARK_GREEN));
+    ASSERT_TRUE(changedImage.SetColor(odr::PixelColor{ 1, 2, 3, 4 }, { 200, 100 }));
+
+    // All instruction sets give the same statistics as the scalar comparison of GetColor values
+    uint64_t errorSum = 0;
+    uint64_t squaredErrorSum = 0;
+    uint64_t differentPixelCount = 0;
+    uint8_t maxChannelError = 0;
+    for (uint32_t y = 0; y < imgA.GetDimensions().height; y++) {
+        for (uint32_t x = 0; x < imgA.GetDimensions().width; x++) {
+            const odr::PixelColor diff = odr::PixelColor::AbsoluteDiff(imgA.GetColor({ x, y }), changedImage.GetColor({ x, y }));
+            for (const uint8_t error : { diff.r, diff.g, diff.b, diff.a }) {
+                errorSum += error;
+                squaredErrorSum += error * error;
+                maxChannelError = std::max(maxChannelError, error);
+            }
+            differentPixelCount += std::max({ diff.r, diff.g, diff.b, diff.a }) > 8 ? 1 : 0;
+        }
+    }
+
+    for (const odr::InstructionSet instructionSet : { odr::InstructionSet::Scalar, odr::InstructionSet::Sse2, odr::InstructionSet::Avx2 }) {
+        odr::ImageComparisonSettings settings;
+        settings.tolerance = 8;
+        settings.maxInstructionSet = instructionSet;
+
+        odr::Image diffImage;
+        const odr::ImageComparison comparison = odr::Image::Compare(imgA, changedImage, settings, &diffImage);
+        const double channelCount = static_cast<double>(comparison.pixelCount) * 4.0;
+
+        ASSERT_TRUE(comparison.isComplete);
+        ASSERT_FALSE(comparison.IsMatch());
+        ASSERT_EQ(comparison.differentPixelCount, differentPixelCount);
+        ASSERT_EQ(comparison.maxChannelError, maxChannelError);
+        ASSERT_DOUBLE_EQ(comparison.meanError, errorSum / channelCount);
+        ASSERT_DOUBLE_EQ(comparison.rmsError, std::sqrt(squaredErrorSum / channelCount));
+        ASSERT_GT(comparison.psnr, 0.0);
+        ASSERT_EQ(diffImage, odr::Image::AbsoluteDiff(imgA, changedImage));
+    }
+
+    // Early exit once too many pixels differ
+    {
+        odr::ImageComparisonSettings settings;
+        settings.maxDifferentPixelCount = 10;
+
+        const odr::ImageComparison comparison = odr::Image::Compare(imgA, changedImage, settings);
+        ASSERT_FALSE(comparison.isComplete);
+        ASSERT_GT(comparison.differentPixelCount, 10u);
+        ASSERT_EQ(comparison.pixelCount, imgA.GetDimensions().width * 21ull);
+    }
+
+    // Premultiplied images are compared in straight alpha
+    {
+        odr::Image premultipliedImage;
+        ASSERT_TRUE(premultipliedImage.Load(std::string(TESTING_IMAGES_DIR) + "image-A.rgba", odr::PixelFormat::Premultiplied));
+        odr::Image roundTrippedImage;
+        ASSERT_TRUE(roundTrippedImage.CloneFrom(premultipliedImage));
+        ASSERT_TRUE(roundTrippedImage.ConvertToPixelFormat(odr::PixelFormat::Straight));
+
+        ASSERT_TRUE(odr::Image::Compare(premultipliedImage, roundTrippedImage).IsMatch());
+    }
+}
+
+TEST_F(ImageTests, ContentHash) {
+    odr::Image imgA;
+    odr::Image imgAAgain;
+    ASSERT_TRUE(imgA.Load(std::string(TESTING_IMAGES_DIR) + "image-A.rgba"));
+    ASSERT_TRUE(imgAAgain.Load(std::string(TESTING_IMAGES_DIR) + "image-A.rgba"));
+
+    // Same content, same hash, computed once
+    const odr::ImageHash hash = imgA.GetContentHash();
+    ASSERT_EQ(imgAAgain.GetContentHash(), hash);
+    ASSERT_EQ(imgA.GetContentHash(), hash);
+
+    odr::Image clonedImage;
+    ASSERT_TRUE(clonedImage.CloneFrom(imgA));
+    ASSERT_EQ(clonedImage.GetContentHash(), hash);
+
+    // Every change is detected
+    ASSERT_TRUE(clonedImage.SetColor(COLOR_LIGHT_GREEN, { 123, 45 }));
+    const odr::ImageHash changedHash = clonedImage.GetContentHash();
+    ASSERT_NE(changedHash, hash);
+    ASSERT_FALSE(clonedImage == imgA);
+    ASSERT_EQ(imgA.GetContentHash(), hash);
+
+    clonedImage.GetRowData(7)[13] ^= 1;
+    clonedImage.MarkContentChanged();
+    ASSERT_NE(clonedImage.GetContentHash(), changedHash);
+
+    // The dimensions and the pixel format are a part of the content
+    odr::Image wideImage;
+    odr::Image tallImage;
+    ASSERT_TRUE(wideImage.Initialize({ 20, 10 }, odr::COLOR_TRANSPARENT));
+    ASSERT_TRUE(tallImage.Initialize({ 10, 20 }, odr::COLOR_TRANSPARENT));
+    ASSERT_NE(wideImage.GetContentHash(), tallImage.GetContentHash());
+    ASSERT_TRUE(tallImage.ConvertToPixelFormat(odr::PixelFormat::Premultiplied));
+    ASSERT_TRUE(wideImage.Initialize({ 10, 20 }, odr::COLOR_TRANSPARENT));
+    ASSERT_NE(wideImage.GetContentHash(), tallImage.GetContentHash());
+
+    // Single pixel images of all sizes of the hashed tail
+    std::unordered_set<odr::ImageHash> hashes;
+    for (uint32_t width = 1; width <= 40; width++) {
+        odr::Image image;
+        ASSERT_TRUE(image.Initialize({ width, 1 }, COLOR_DARK_GREEN));
+        ASSERT_TRUE(hashes.insert(image.GetContentHash()).second);
+        ASSERT_TRUE(image.SetColor(COLOR_LIGHT_GREEN, { width - 1, 0 }));
+        ASSERT_TRUE(hashes.insert(image.GetContentHash()).second);
+    }
+
+    // All instruction sets give the same hashes, including the tails
+    for (const uint32_t width : { 1u, 7u, 16u, 17u, 33u, 640u }) {
+        odr::Image image;
+        ASSERT_TRUE(image.Initialize({ width, 3 }, COLOR_DARK_GREEN));
+        ASSERT_TRUE(image.SetColor(COLOR_LIGHT_GREEN, { width / 2, 1 }));
+
+        const odr::ImageHash scalarHash = image.GetContentHash(odr::InstructionSet::Scalar);
+        for (const odr::InstructionSet instructionSet : { odr::InstructionSet::Sse2, odr::InstructionSet::Avx2 }) {
+            // A new content identifier, so the hash is computed again instead of being cached
+            image.MarkContentChanged();
+            ASSERT_EQ(image.GetContentHash(instructionSet), scalarHash);
+        }
+    }
+
+    // Concurrent first use
+    odr::Image sharedImage;
+    ASSERT_TRUE(sharedImage.Load(std::string(TESTING_IMAGES_DIR) + "image-C.rgba"));
+    std::vector<odr::ImageHash> threadHashes(4);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < threadHashes.size(); i++) {
+        threads.emplace_back([&, i]() {
+            threadHashes[i] = sharedImage.GetContentHash();
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    for (const odr::ImageHash& threadHash : threadHashes) {
+        ASSERT_EQ(threadHash, sharedImage.GetContentHash());
+    }
+}
+
+TEST_F(ImageTests, ContentInfo) {
+    constexpr odr::PixelColor COLOR_OPAQUE_RED{ 0xF0, 0x30, 0x30, 0xFF };
+
+    odr::Image image;
+    ASSERT_FALSE(image.GetContentInfo().isOpaque);
+    ASSERT_FALSE(image.GetContentInfo().isTransparent);
+
+    // Uniform images
+    ASSERT_TRUE(image.Initialize({ 40, 30 }, odr::COLOR_TRANSPARENT));
+    odr::ImageContentInfo info = image.GetContentInfo();
+    ASSERT_TRUE(info.isTransparent);
+    ASSERT_FALSE(info.isOpaque);
+    ASSERT_TRUE(info.isUniform);
+    ASSERT_TRUE(info.contentBounds.IsEmpty());
+
+    ASSERT_TRUE(image.Fill(COLOR_OPAQUE_RED));
+    info = image.GetContentInfo();
+    ASSERT_TRUE(info.isOpaque);
+    ASSERT_FALSE(info.isTransparent);
+    ASSERT_TRUE(info.isUniform);
+    ASSERT_EQ(info.uniformColor, COLOR_OPAQUE_RED);
+    ASSERT_EQ(info.contentBounds, (odr::PixelRectangle{ { 0, 0 }, { 40, 30 } }));
+
+    ASSERT_TRUE(image.Fill(COLOR_LIGHT_GREEN));
+    ASSERT_TRUE(image.ConvertToPixelFormat(odr::PixelFormat::Premultiplied));
+    info = image.GetContentInfo();
+    ASSERT_FALSE(info.isOpaque);
+    ASSERT_TRUE(info.isUniform);
+    ASSERT_EQ(info.uniformColor, image.GetColor({ 0, 0 }));
+
+    // Bounds of scattered pixels, every change is detected
+    ASSERT_TRUE(image.Initialize({ 40, 30 }, odr::COLOR_TRANSPARENT));
+    ASSERT_TRUE(image.SetColor(COLOR_LIGHT_GREEN, { 12, 5 }));
+    ASSERT_EQ(image.GetContentInfo().contentBounds, (odr::PixelRectangle{ { 12, 5 }, { 1, 1 } }));
+    ASSERT_TRUE(image.SetColor(COLOR_DARK_GREEN, { 3, 20 }));
+    ASSERT_TRUE(image.SetColor(COLOR_DARK_GREEN, { 39, 9 }));
+    info = image.GetContentInfo();
+    ASSERT_FALSE(info.isTransparent);
+    ASSERT_FALSE(info.isUniform);
+    ASSERT_EQ(info.contentBounds, (odr::PixelRectangle{ { 3, 5 }, { 37, 16 } }));
+
+    // Transparent pixels of any color are outside of the bounds
+    ASSERT_TRUE(image.SetColor(odr::PixelColor{ 0xFF, 0xFF, 0xFF, 0 }, { 0, 0 }));
+    ASSERT_EQ(image.GetContentInfo().contentBounds, info.contentBounds);
+
+    image.GetRowData(29)[3] = 0xFF;
+    image.MarkContentChanged();
+    ASSERT_EQ(image.GetContentInfo().contentBounds, (odr::PixelRectangle{ { 0, 5 }, { 40, 25 } }));
+
+    // Clones share the info
+    odr::Image clonedImage;
+    ASSERT_TRUE(clonedImage.CloneFrom(image));
+    ASSERT_EQ(clonedImage.GetContentInfo().contentBounds, (odr::PixelRectangle{ { 0, 5 }, { 40, 25 } }));
+
+    // Loaded images
+    odr::Image imgA;
+    ASSERT_TRUE(imgA.Load(std::string(TESTING_IMAGES_DIR) + "image-A.rgba"));
+    info = imgA.GetContentInfo();
+    bool isOpaque = true;
+    for (uint32_t y = 0; y < imgA.GetDimensions().height; y++) {
+        for (uint32_t x = 0; x < imgA.GetDimensions().width; x++) {
+            isOpaque &= imgA.GetColor({ x, y }).a == 0xFF;
+        }
+    }
+    ASSERT_EQ(info.isOpaque, isOpaque);
+    ASSERT_FALSE(info.isUniform);
+}
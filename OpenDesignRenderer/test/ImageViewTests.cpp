@@ -0,0 +1,166 @@
+#include <vector>
+#include <gtest/gtest.h>
+
+#include <OpenDesignRenderer/Image.h>
+#include <OpenDesignRenderer/ImageView.h>
+#include <OpenDesignRenderer/PixelColor.h>
+#include <OpenDesignRenderer/RenderingEngine.h>
+
+
+namespace {
+//! Copy a rectangle of an image into a new image.
+odr::Image Cropped(const odr::Image& image, const odr::PixelRectangle& rectangle) {
+    odr::Image croppedImage;
+    croppedImage.Initialize(rectangle.dimensions, odr::COLOR_TRANSPARENT, image.GetPixelFormat());
+    croppedImage.CopyRect(image, rectangle, { 0, 0 });
+    return croppedImage;
+}
+}
+
+//! ImageView class tests.
+class ImageViewTests : public ::testing::Test {
+protected:
+    virtual void SetUp() override {
+        ASSERT_TRUE(imgA.Load(std::string(TESTING_IMAGES_DIR) + "image-A.rgba"));
+    }
+
+    odr::Image imgA;
+    const odr::PixelRectangle cropRectangle{ { 37, 21 }, { 211, 143 } };
+};
+
+TEST_F(ImageViewTests, WholeImage) {
+    const odr::ImageView view(imgA);
+
+    ASSERT_TRUE(view.IsInitialized());
+    ASSERT_EQ(view.GetDimensions(), imgA.GetDimensions());
+    ASSERT_EQ(view.GetRowStride(), imgA.GetRowStride());
+    ASSERT_EQ(view.GetRowData(0), static_cast<const odr::Image&>(imgA).GetRowData(0));
+    ASSERT_EQ(view.GetColor({ 10, 20 }), imgA.GetColor({ 10, 20 }));
+
+    ASSERT_FALSE(odr::ImageView().IsInitialized());
+    ASSERT_FALSE(odr::ImageView(odr::Image()).IsInitialized());
+}
+
+TEST_F(ImageViewTests, Subview) {
+    const odr::ImageView view(imgA, cropRectangle);
+    ASSERT_EQ(view.GetDimensions(), cropRectangle.dimensions);
+    ASSERT_EQ(view.GetRowStride(), imgA.GetRowStride());
+
+    // No pixels are copied
+    ASSERT_EQ(
+        view.GetRowData(0),
+        static_cast<const odr::Image&>(imgA).GetRowData(cropRectangle.position.top) + cropRectangle.position.left * 4);
+
+    for (uint32_t y = 0; y < cropRectangle.dimensions.height; y += 7) {
+        for (uint32_t x = 0; x < cropRectangle.dimensions.width; x += 5) {
+            ASSERT_EQ(view.GetColor({ x, y }), imgA.GetColor({ cropRectangle.position.left + x, cropRectangle.position.top + y }));
+        }
+    }
+    ASSERT_EQ(view.GetColor({ cropRectangle.dimensions.width, 0 }), odr::COLOR_TRANSPARENT);
+    ASSERT_EQ(view.GetRowData(cropRectangle.dimensions.height), nullptr);
+
+    // Clipped to the viewed pixels
+    const odr::ImageView corner = view.Subview({ { 200, 140 }, { 100, 100 } });
+    ASSERT_EQ(corner.GetDimensions(), (odr::ImageDimensions{ 11, 3 }));
+    ASSERT_EQ(corner.GetColor({ 0, 0 }), view.GetColor({ 200, 140 }));
+    ASSERT_FALSE(view.Subview({ { 300, 0 }, { 10, 10 } }).IsInitialized());
+}
+
+TEST_F(ImageViewTests, ExternalMemory) {
+    // Rows with padding between them, as a decoder or a window system may provide
+    const odr::ImageDimensions dimensions{ 5, 3 };
+    const size_t rowStride = 32;
+    std::vector<unsigned char> pixels(rowStride * dimensions.height, 0xEE);
+
+    for (uint32_t y = 0; y < dimensions.height; y++) {
+        for (uint32_t x = 0; x < dimensions.width; x++) {
+            unsigned char* pixel = pixels.data() + y * rowStride + x * 4;
+            pixel[0] = static_cast<unsigned char>(x * 40);
+            pixel[1] = static_cast<unsigned char>(y * 80);
+            pixel[2] = 0x10;
+            pixel[3] = 0xFF;
+        }
+    }
+
+    const odr::ImageView view(pixels.data(), dimensions, rowStride, odr::PixelFormat::Straight);
+    ASSERT_EQ(view.GetColor({ 4, 2 }), (odr::PixelColor{ 160, 160, 0x10, 0xFF }));
+
+    const odr::Image copy = view.Scaled(dimensions);
+    ASSERT_EQ(copy.GetDimensions(), dimensions);
+    for (uint32_t y = 0; y < dimensions.height; y++) {
+        for (uint32_t x = 0; x < dimensions.width; x++) {
+            ASSERT_EQ(copy.GetColor({ x, y }), view.GetColor({ x, y }));
+        }
+    }
+}
+
+TEST_F(ImageViewTests, ScaledAndSaveMatchCrop) {
+    const odr::Image croppedImage = Cropped(imgA, cropRectangle);
+    const odr::ImageView view(imgA, cropRectangle);
+
+    for (const odr::ResamplingFilter filter : { odr::ResamplingFilter::Box, odr::ResamplingFilter::SummedAreaBox, odr::ResamplingFilter::Bicubic }) {
+        for (const odr::ImageDimensions& dimensions : { odr::ImageDimensions{ 70, 40 }, odr::ImageDimensions{ 400, 300 } }) {
+            ASSERT_EQ(view.Scaled(dimensions, filter), croppedImage.Scaled(dimensions, filter));
+        }
+    }
+
+    // Strided rows are gathered, premultiplied ones converted
+    odr::Image premultipliedImage;
+    ASSERT_TRUE(premultipliedImage.Load(std::string(TESTING_IMAGES_DIR) + "image-A.rgba", odr::PixelFormat::Premultiplied));
+
+    for (const odr::Image* image : { &imgA, &premultipliedImage }) {
+        const std::string filepath = std::string(TESTING_IMAGES_DIR) + "tmp_image-A-view.rgba";
+        ASSERT_TRUE(odr::ImageView(*image, cropRectangle).Save(filepath));
+
+        odr::Image expectedImage = Cropped(*image, cropRectangle);
+        ASSERT_TRUE(expectedImage.ConvertToPixelFormat(odr::PixelFormat::Straight));
+
+        odr::Image savedImage;
+        ASSERT_TRUE(savedImage.Load(filepath));
+        ASSERT_EQ(savedImage, expectedImage);
+    }
+    ASSERT_FALSE(odr::ImageView().Save(std::string(TESTING_IMAGES_DIR) + "tmp_image-A-view.rgba"));
+}
+
+TEST_F(ImageViewTests, AbsoluteDiff) {
+    const odr::Image croppedImage = Cropped(imgA, cropRectangle);
+
+    const odr::Image diffImage = odr::Image::AbsoluteDiff(odr::ImageView(imgA, cropRectangle), croppedImage);
+    ASSERT_EQ(diffImage.GetDimensions(), cropRectangle.dimensions);
+
+    for (uint32_t y = 0; y < cropRectangle.dimensions.height; y++) {
+        for (uint32_t x = 0; x < cropRectangle.dimensions.width; x++) {
+            ASSERT_EQ(diffImage.GetColor({ x, y }), (odr::PixelColor{ 0, 0, 0, 0 }));
+        }
+    }
+}
+
+TEST_F(ImageViewTests, Draw) {
+    const odr::Image croppedImage = Cropped(imgA, cropRectangle);
+
+    for (const odr::RenderMode renderMode : { odr::RenderMode::Immediate, odr::RenderMode::Deferred }) {
+        for (const odr::ImageDimensions& dimensions : { cropRectangle.dimensions, odr::ImageDimensions{ 100, 60 }, odr::ImageDimensions{ 500, 350 } }) {
+            odr::RenderingEngineSettings settings;
+            settings.renderMode = renderMode;
+            settings.threadCount = 4;
+
+            odr::RenderingEngine croppedEngine(settings);
+            odr::RenderingEngine viewEngine(settings);
+            ASSERT_TRUE(croppedEngine.InitializeFrameBuffer({ 320, 240 }));
+            ASSERT_TRUE(viewEngine.InitializeFrameBuffer({ 320, 240 }));
+
+            ASSERT_TRUE(croppedEngine.Draw(croppedImage, { -20, 15 }, dimensions));
+            ASSERT_TRUE(viewEngine.Draw(odr::ImageView(imgA, cropRectangle), { -20, 15 }, dimensions));
+
+            odr::Image croppedRendered;
+            odr::Image viewRendered;
+            ASSERT_TRUE(croppedEngine.Render(croppedRendered));
+            ASSERT_TRUE(viewEngine.Render(viewRendered));
+            ASSERT_EQ(viewRendered, croppedRendered);
+        }
+    }
+
+    odr::RenderingEngine engine;
+    ASSERT_TRUE(engine.InitializeFrameBuffer({ 320, 240 }));
+    ASSERT_FALSE(engine.Draw(odr::ImageView(), { 0, 0 }, { 10, 10 }));
+}
@@ -10,6 +10,12 @@ constexpr odr::PixelColor COLOR_LIGHT_RED{ 0xF0, 0x30, 0x30, 0x80 };
 constexpr odr::PixelColor COLOR_DARK_RED{ 0xF0, 0x70, 0x70, 0x80 };
 constexpr odr::PixelColor COLOR_RED_05{ 0xFF, 0, 0, 0x80 };
 constexpr odr::PixelColor COLOR_BLUE_10{ 0, 0, 0xFF, 0xFF };
+
+//! Detect if the colors differ by at most 1 in each color channel and have the same alpha.
+bool IsNearColor(const odr::PixelColor& colorA, const odr::PixelColor& colorB) {
+    const odr::PixelColor diff = odr::PixelColor::AbsoluteDiff(colorA, colorB);
+    return diff.r <= 1 && diff.g <= 1 && diff.b <= 1 && diff.a == 0;
+}
 }
 
 //! PixelColor class tests.
@@ -47,3 +53,71 @@ TEST_F(PixelColorTests, AlphaBlend) {
     const auto blue10Overred05 = odr::PixelColor::Blend(COLOR_RED_05, COLOR_BLUE_10);
     ASSERT_EQ(blue10Overred05, COLOR_BLUE_10);
 }
+
+TEST_F(PixelColorTests, AlphaBlendFixedPoint) {
+    const auto channelDiff = [](unsigned char a, unsigned char b) {
+        return a >= b ? a - b : b - a;
+    };
+
+    for (uint32_t bgAlpha = 0; bgAlpha < 256; bgAlpha += 3) {
+        for (uint32_t fgAlpha = 0; fgAlpha < 256; fgAlpha += 3) {
+            for (uint32_t bgChannel = 0; bgChannel < 256; bgChannel += 17) {
+                for (uint32_t fgChannel = 0; fgChannel < 256; fgChannel += 17) {
+                    const odr::PixelColor bgColor{
+                        static_cast<unsigned char>(bgChannel),
+                        static_cast<unsigned char>(255 - bgChannel),
+                        static_cast<unsigned char>(fgChannel),
+                        static_cast<unsigned char>(bgAlpha) };
+                    const odr::PixelColor fgColor{
+                        static_cast<unsigned char>(fgChannel),
+                        static_cast<unsigned char>(bgChannel),
+                        static_cast<unsigned char>(255 - fgChannel),
+                        static_cast<unsigned char>(fgAlpha) };
+
+                    const odr::PixelColor floatColor = odr::PixelColor::Blend(bgColor, fgColor);
+                    const odr::PixelColor fixedPointColor = odr::PixelColor::BlendFixedPoint(bgColor, fgColor);
+
+                    ASSERT_LE(channelDiff(floatColor.r, fixedPointColor.r), 1);
+                    ASSERT_LE(channelDiff(floatColor.g, fixedPointColor.g), 1);
+                    ASSERT_LE(channelDiff(floatColor.b, fixedPointColor.b), 1);
+                    ASSERT_EQ(floatColor.a, fixedPointColor.a);
+                }
+            }
+        }
+    }
+
+    const auto red05OverBlue10 = odr::PixelColor::BlendFixedPoint(COLOR_BLUE_10, COLOR_RED_05);
+    const odr::PixelColor r05ob10{ 0x80, 0, 0x7F, 0xFF };
+    ASSERT_EQ(red05OverBlue10, r05ob10);
+}
+
+TEST_F(PixelColorTests, Premultiplied) {
+    ASSERT_EQ(odr::PixelColor::Premultiplied(COLOR_BLUE_10), COLOR_BLUE_10);
+    ASSERT_EQ(odr::PixelColor::Unpremultiplied(COLOR_BLUE_10), COLOR_BLUE_10);
+
+    const odr::PixelColor transparentWhite{ 0xFF, 0xFF, 0xFF, 0 };
+    ASSERT_EQ(odr::PixelColor::Premultiplied(transparentWhite), odr::COLOR_TRANSPARENT);
+
+    // 8-bit premultiplied colors lose precision
+    const odr::PixelColor lightRedPremultiplied{ 0x78, 0x18, 0x18, 0x80 };
+    ASSERT_EQ(odr::PixelColor::Premultiplied(COLOR_LIGHT_RED), lightRedPremultiplied);
+    ASSERT_TRUE(IsNearColor(odr::PixelColor::Unpremultiplied(lightRedPremultiplied), COLOR_LIGHT_RED));
+}
+
+TEST_F(PixelColorTests, AlphaBlendPremultiplied) {
+    const auto blendPremultiplied = [](const odr::PixelColor& bgColor, const odr::PixelColor& fgColor) {
+        return odr::PixelColor::Unpremultiplied(odr::PixelColor::BlendPremultiplied(
+            odr::PixelColor::Premultiplied(bgColor),
+            odr::PixelColor::Premultiplied(fgColor)));
+    };
+
+    ASSERT_TRUE(IsNearColor(blendPremultiplied(odr::COLOR_TRANSPARENT, COLOR_LIGHT_RED), COLOR_LIGHT_RED));
+    ASSERT_TRUE(IsNearColor(blendPremultiplied(COLOR_LIGHT_RED, odr::COLOR_TRANSPARENT), COLOR_LIGHT_RED));
+    ASSERT_EQ(blendPremultiplied(COLOR_RED_05, COLOR_BLUE_10), COLOR_BLUE_10);
+
+    const odr::PixelColor lrolgColor{ 0xC5, 0x70, 0x45, 0xC0 };
+    ASSERT_TRUE(IsNearColor(blendPremultiplied(COLOR_LIGHT_GREEN, COLOR_LIGHT_RED), lrolgColor));
+
+    const odr::PixelColor r05ob10{ 0x80, 0, 0x7F, 0xFF };
+    ASSERT_TRUE(IsNearColor(blendPremultiplied(COLOR_BLUE_10, COLOR_RED_05), r05ob10));
+}
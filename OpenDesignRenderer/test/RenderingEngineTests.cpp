@@ -1,7 +1,10 @@
 #include <memory>
+#include <utility>
+#include <vector>
 #include <gtest/gtest.h>
 
 #include <OpenDesignRenderer/Image.h>
+#include <OpenDesignRenderer/ImagePoolAllocator.h>
 #include <OpenDesignRenderer/PixelCoordinates.h>
 #include <OpenDesignRenderer/PixelColor.h>
 #include <OpenDesignRenderer/RenderingEngine.h>
@@ -64,9 +67,9 @@ TEST_F(RenderingEngineTests, DrawRectangle) {
             const odr::PixelColor pixelColor = renderedImage.GetColor(odr::PixelCoordinates{ x, y });
 
             if (
-                x >= rectanglePosition.left &&
+                static_cast<int32_t>(x) >= rectanglePosition.left &&
                 x < rectanglePosition.left + rectangleDimensions.width &&
-                y >= rectanglePosition.top &&
+                static_cast<int32_t>(y) >= rectanglePosition.top &&
                 y < rectanglePosition.top + rectangleDimensions.height) {
                 ASSERT_EQ(pixelColor, COLOR_LIGHT_GREEN);
             }
@@ -102,9 +105,9 @@ TEST_F(RenderingEngineTests, DrawRectangleInnerStroke) {
             const odr::PixelColor pixelColor = renderedImage.GetColor(odr::PixelCoordinates{ x, y });
 
             const bool isInRectangle =
-                x >= rectanglePosition.left &&
+                static_cast<int32_t>(x) >= rectanglePosition.left &&
                 x < rectanglePosition.left + rectangleDimensions.width &&
-                y >= rectanglePosition.top &&
+                static_cast<int32_t>(y) >= rectanglePosition.top &&
                 y < rectanglePosition.top + rectangleDimensions.height;
             const bool isInInnerRectangle =
                 x >= rectanglePosition.left + strokeWidth &&
@@ -153,14 +156,14 @@ TEST_F(RenderingEngineTests, DrawRectangleBlend) {
             const odr::PixelColor pixelColor = renderedImage.GetColor(odr::PixelCoordinates{ x, y });
 
             const bool isInGreenImage =
-                x >= greenRectanglePosition.left &&
+                static_cast<int32_t>(x) >= greenRectanglePosition.left &&
                 x < greenRectanglePosition.left + greenRectangleDimensions.width &&
-                y >= greenRectanglePosition.top &&
+                static_cast<int32_t>(y) >= greenRectanglePosition.top &&
                 y < greenRectanglePosition.top + greenRectangleDimensions.height;
             const bool isInRedImage =
-                x >= redRectanglePosition.left &&
+                static_cast<int32_t>(x) >= redRectanglePosition.left &&
                 x < redRectanglePosition.left + redRectangleDimensions.width &&
-                y >= redRectanglePosition.top &&
+                static_cast<int32_t>(y) >= redRectanglePosition.top &&
                 y < redRectanglePosition.top + redRectangleDimensions.height;
 
             if (isInGreenImage && isInRedImage) {
@@ -182,6 +185,186 @@ TEST_F(RenderingEngineTests, DrawRectangleBlend) {
     ASSERT_TRUE(isImgSaved);
 }
 
+TEST_F(RenderingEngineTests, DrawRectangleBands) {
+    struct Rectangle {
+        odr::PixelCoordinatesUnbounded position;
+        odr::ImageDimensions dimensions;
+        odr::PixelColor fillColor;
+        uint32_t strokeWidth;
+        odr::PixelColor strokeColor;
+    };
+    // Opaque, translucent and transparent fills and strokes, clipped, and a stroke covering everything
+    const Rectangle rectangles[] = {
+        { { -10, -5 }, { 120, 90 }, { 10, 200, 30, 255 }, 7, COLOR_DARK_RED },
+        { { 50, 40 }, { 100, 60 }, { 1, 2, 3, 0 }, 12, { 200, 100, 50, 255 } },
+        { { 30, 100 }, { 40, 20 }, COLOR_LIGHT_GREEN, 15, { 90, 90, 90, 255 } },
+        { { 100, 10 }, { 500, 500 }, { 255, 255, 255, 255 }, 3, { 0, 0, 0, 255 } },
+        { { 120, 70 }, { 60, 60 }, { 40, 50, 60, 255 }, 0, { 0, 0, 0, 0 } },
+    };
+
+    odr::Image imgA;
+    ASSERT_TRUE(imgA.Load(std::string(TESTING_IMAGES_DIR) + "image-A.rgba"));
+    odr::Image background;
+    ASSERT_TRUE(background.Initialize({ 200, 150 }, odr::COLOR_TRANSPARENT));
+    ASSERT_TRUE(background.CopyRect(imgA, { { 0, 0 }, { 200, 150 } }, { 0, 0 }));
+
+    // Every pixel blended on its own, the colors in the pixel format
+    const auto renderExpected = [&](odr::PixelFormat pixelFormat, odr::BlendMode blendMode, odr::Image& expectedImage) {
+        const bool isPremultiplied = pixelFormat == odr::PixelFormat::Premultiplied;
+        const auto blendPixel = [&](unsigned char* pixel, const odr::PixelColor& color) {
+            const odr::PixelColor pixelColor{ pixel[0], pixel[1], pixel[2], pixel[3] };
+            odr::PixelColor blended;
+            if (isPremultiplied) {
+                blended = odr::PixelColor::BlendPremultiplied(pixelColor, color);
+            } else if (blendMode == odr::BlendMode::FixedPoint) {
+                blended = odr::PixelColor::BlendFixedPoint(pixelColor, color);
+            } else {
+                blended = odr::PixelColor::Blend(pixelColor, color);
+            }
+            pixel[0] = blended.r;
+            pixel[1] = blended.g;
+            pixel[2] = blended.b;
+            pixel[3] = blended.a;
+        };
+
+        odr::Image convertedBackground;
+        ASSERT_TRUE(convertedBackground.CloneFrom(background));
+        ASSERT_TRUE(convertedBackground.ConvertToPixelFormat(pixelFormat));
+        ASSERT_TRUE(expectedImage.Initialize(background.GetDimensions(), odr::COLOR_TRANSPARENT, pixelFormat));
+
+        for (uint32_t y = 0; y < 150; y++) {
+            const unsigned char* backgroundRow = static_cast<const odr::Image&>(convertedBackground).GetRowData(y);
+            unsigned char* row = expectedImage.GetRowData(y);
+            for (uint32_t x = 0; x < 200; x++) {
+                const unsigned char* pixel = backgroundRow + x * 4;
+                blendPixel(row + x * 4, odr::PixelColor{ pixel[0], pixel[1], pixel[2], pixel[3] });
+            }
+        }
+
+        for (const Rectangle& rectangle : rectangles) {
+            for (uint32_t y = 0; y < 150; y++) {
+                unsigned char* row = expectedImage.GetRowData(y);
+                for (uint32_t x = 0; x < 200; x++) {
+                    const int64_t left = static_cast<int64_t>(x) - rectangle.position.left;
+                    const int64_t top = static_cast<int64_t>(y) - rectangle.position.top;
+                    if (left < 0 || top < 0 || left >= rectangle.dimensions.width || top >= rectangle.dimensions.height) {
+                        continue;
+                    }
+                    const bool isInInterior =
+                        left >= rectangle.strokeWidth && left + rectangle.strokeWidth < rectangle.dimensions.width &&
+                        top >= rectangle.strokeWidth && top + rectangle.strokeWidth < rectangle.dimensions.height;
+                    const odr::PixelColor color = isInInterior ? rectangle.fillColor : rectangle.strokeColor;
+
+                    blendPixel(row + x * 4, isPremultiplied ? odr::PixelColor::Premultiplied(color) : color);
+                }
+            }
+        }
+
+        expectedImage.MarkContentChanged();
+        ASSERT_TRUE(expectedImage.ConvertToPixelFormat(odr::PixelFormat::Straight));
+    };
+
+    const std::pair<odr::PixelFormat, odr::BlendMode> modes[] = {
+        { odr::PixelFormat::Straight, odr::BlendMode::Float },
+        { odr::PixelFormat::Straight, odr::BlendMode::FixedPoint },
+        { odr::PixelFormat::Premultiplied, odr::BlendMode::Float },
+    };
+
+    for (const auto& mode : modes) {
+        odr::Image expectedImage;
+        renderExpected(mode.first, mode.second, expectedImage);
+
+        for (const odr::InstructionSet instructionSet : { odr::InstructionSet::Scalar, odr::InstructionSet::Sse2, odr::InstructionSet::Avx2 }) {
+            odr::RenderingEngineSettings settings;
+            settings.frameBufferPixelFormat = mode.first;
+            settings.blendMode = mode.second;
+            settings.maxInstructionSet = instructionSet;
+            settings.threadCount = 3;
+            settings.tileSize = 32;
+
+            odr::RenderingEngine engine(settings);
+            ASSERT_TRUE(engine.InitializeFrameBuffer(background.GetDimensions()));
+            ASSERT_TRUE(engine.Draw(background, { 0, 0 }, background.GetDimensions()));
+            for (const Rectangle& rectangle : rectangles) {
+                ASSERT_TRUE(engine.DrawRectangle(rectangle.position, rectangle.dimensions, rectangle.fillColor, rectangle.strokeWidth, rectangle.strokeColor));
+            }
+
+            odr::Image renderedImage;
+            ASSERT_TRUE(engine.Render(renderedImage));
+            ASSERT_EQ(renderedImage, expectedImage);
+        }
+    }
+}
+
+TEST_F(RenderingEngineTests, DrawImageContentInfo) {
+    odr::Image imgA;
+    ASSERT_TRUE(imgA.Load(std::string(TESTING_IMAGES_DIR) + "image-A.rgba"));
+    odr::Image background;
+    ASSERT_TRUE(background.Initialize({ 200, 150 }, odr::COLOR_TRANSPARENT));
+    ASSERT_TRUE(background.CopyRect(imgA, { { 0, 0 }, { 200, 150 } }, { 0, 0 }));
+
+    // Opaque, transparent and translucent content inside transparent margins
+    odr::Image opaqueImage;
+    ASSERT_TRUE(opaqueImage.Initialize({ 60, 40 }, { 10, 200, 30, 255 }));
+    ASSERT_TRUE(opaqueImage.FillRect({ { 5, 5 }, { 20, 10 } }, { 200, 100, 50, 255 }));
+    odr::Image transparentImage;
+    ASSERT_TRUE(transparentImage.Initialize({ 50, 50 }, { 1, 2, 3, 0 }));
+    odr::Image boundedImage;
+    ASSERT_TRUE(boundedImage.Initialize({ 80, 60 }, odr::COLOR_TRANSPARENT));
+    ASSERT_TRUE(boundedImage.FillRect({ { 20, 10 }, { 30, 25 } }, COLOR_LIGHT_GREEN));
+    ASSERT_TRUE(boundedImage.SetColor(COLOR_DARK_RED, { 70, 50 }));
+
+    ASSERT_TRUE(opaqueImage.GetContentInfo().isOpaque);
+    ASSERT_TRUE(transparentImage.GetContentInfo().isTransparent);
+    ASSERT_EQ(boundedImage.GetContentInfo().contentBounds, (odr::PixelRectangle{ { 20, 10 }, { 51, 41 } }));
+
+    // Views are drawn without the content info, every pixel blended
+    const auto drawScene = [&](odr::RenderingEngine& engine, bool isViewed) {
+        const auto draw = [&](const odr::Image& image, const odr::PixelCoordinatesUnbounded& position) {
+            return isViewed
+                ? engine.Draw(odr::ImageView(image), position, image.GetDimensions())
+                : engine.Draw(image, position, image.GetDimensions());
+        };
+        ASSERT_TRUE(engine.Draw(odr::ImageView(background), { 0, 0 }, background.GetDimensions()));
+        ASSERT_TRUE(draw(opaqueImage, { -10, 30 }));
+        ASSERT_TRUE(draw(transparentImage, { 100, 20 }));
+        ASSERT_TRUE(draw(boundedImage, { 130, 100 }));
+        ASSERT_TRUE(draw(opaqueImage, { 150, 110 }));
+    };
+
+    for (const odr::PixelFormat pixelFormat : { odr::PixelFormat::Straight, odr::PixelFormat::Premultiplied }) {
+        for (const odr::RenderMode renderMode : { odr::RenderMode::Immediate, odr::RenderMode::Deferred }) {
+            odr::RenderingEngineSettings settings;
+            settings.frameBufferPixelFormat = pixelFormat;
+            settings.renderMode = renderMode;
+
+            odr::RenderingEngine engine(settings);
+            ASSERT_TRUE(engine.InitializeFrameBuffer(background.GetDimensions()));
+            drawScene(engine, false);
+            odr::Image renderedImage;
+            ASSERT_TRUE(engine.Render(renderedImage));
+
+            odr::RenderingEngine referenceEngine(settings);
+            ASSERT_TRUE(referenceEngine.InitializeFrameBuffer(background.GetDimensions()));
+            drawScene(referenceEngine, true);
+            odr::Image referenceImage;
+            ASSERT_TRUE(referenceEngine.Render(referenceImage));
+
+            ASSERT_EQ(renderedImage, referenceImage);
+        }
+    }
+
+    // Transparent images leave premultiplied frame buffers unchanged and are not recorded
+    odr::RenderingEngineSettings settings;
+    settings.frameBufferPixelFormat = odr::PixelFormat::Premultiplied;
+    settings.renderMode = odr::RenderMode::Deferred;
+    odr::RenderingEngine engine(settings);
+    ASSERT_TRUE(engine.InitializeFrameBuffer(background.GetDimensions()));
+    ASSERT_TRUE(engine.Draw(transparentImage, { 10, 10 }, transparentImage.GetDimensions()));
+    ASSERT_TRUE(engine.Draw(transparentImage, { 10, 10 }, { 300, 200 }));
+    ASSERT_EQ(engine.GetDeferredCommandCount(), 0u);
+}
+
 TEST_F(RenderingEngineTests, DrawImage) {
     odr::RenderingEngine engine;
 
@@ -280,3 +463,845 @@ TEST_F(RenderingEngineTests, DrawComposite) {
         ASSERT_EQ(testImage, renderedImage);
     }
 }
+
+TEST_F(RenderingEngineTests, DrawClipped) {
+    odr::RenderingEngine engine;
+
+    const odr::ImageDimensions frameBufferDimensions{ 120, 80 };
+    const bool isBufferInitialized = engine.InitializeFrameBuffer(frameBufferDimensions);
+    ASSERT_TRUE(isBufferInitialized);
+
+    // Rectangle crossing the top left corner of the frame buffer
+    const odr::PixelCoordinatesUnbounded rectanglePosition{ -30, -20 };
+    const odr::ImageDimensions rectangleDimensions{ 100, 60 };
+    const uint32_t strokeWidth = 25;
+    const bool isRectangleDrawn = engine.DrawRectangle(rectanglePosition, rectangleDimensions, COLOR_LIGHT_GREEN, strokeWidth, COLOR_DARK_RED);
+    ASSERT_TRUE(isRectangleDrawn);
+
+    // Image entirely outside of the frame buffer, its wrapped-around right edge must not be drawn
+    odr::Image imgGreen;
+    const bool isImgInitialized = imgGreen.Initialize({ 10, 10 }, COLOR_LIGHT_GREEN);
+    ASSERT_TRUE(isImgInitialized);
+    const bool isImgDrawn = engine.Draw(imgGreen, { -1000, 10 }, { 500, 10 });
+    ASSERT_TRUE(isImgDrawn);
+
+    odr::Image renderedImage;
+    const bool isRendered = engine.Render(renderedImage);
+    ASSERT_TRUE(isRendered);
+
+    for (uint32_t y = 0u; y < frameBufferDimensions.height; y++) {
+        for (uint32_t x = 0u; x < frameBufferDimensions.width; x++) {
+            const odr::PixelColor pixelColor = renderedImage.GetColor(odr::PixelCoordinates{ x, y });
+
+            const int32_t rectX = static_cast<int32_t>(x) - rectanglePosition.left;
+            const int32_t rectY = static_cast<int32_t>(y) - rectanglePosition.top;
+            const bool isInRectangle =
+                rectX < static_cast<int32_t>(rectangleDimensions.width) &&
+                rectY < static_cast<int32_t>(rectangleDimensions.height);
+            const bool isInInnerRectangle =
+                rectX >= static_cast<int32_t>(strokeWidth) &&
+                rectX + strokeWidth < rectangleDimensions.width &&
+                rectY >= static_cast<int32_t>(strokeWidth) &&
+                rectY + strokeWidth < rectangleDimensions.height;
+
+            if (isInInnerRectangle) {
+                ASSERT_EQ(pixelColor, COLOR_LIGHT_GREEN);
+            }
+            else if (isInRectangle) {
+                ASSERT_EQ(pixelColor, COLOR_DARK_RED);
+            }
+            else {
+                ASSERT_EQ(pixelColor, odr::COLOR_TRANSPARENT);
+            }
+        }
+    }
+}
+
+TEST_F(RenderingEngineTests, InstructionSetsMatch) {
+    // Every combination of background and foreground alpha, with varying colors
+    const odr::ImageDimensions dimensions{ 256, 256 };
+    odr::Image bgImage;
+    odr::Image fgImage;
+    ASSERT_TRUE(bgImage.Initialize(dimensions, odr::COLOR_TRANSPARENT));
+    ASSERT_TRUE(fgImage.Initialize(dimensions, odr::COLOR_TRANSPARENT));
+
+    for (uint32_t y = 0u; y < dimensions.height; y++) {
+        for (uint32_t x = 0u; x < dimensions.width; x++) {
+            const odr::PixelColor bgColor{
+                static_cast<unsigned char>(x * 7 + y * 3),
+                static_cast<unsigned char>((x * 13) ^ y),
+                static_cast<unsigned char>(x + y * 5),
+                static_cast<unsigned char>(y) };
+            const odr::PixelColor fgColor{
+                static_cast<unsigned char>(x * 3 + y * 11),
+                static_cast<unsigned char>(x ^ (y * 17)),
+                static_cast<unsigned char>(x * 5 + y),
+                static_cast<unsigned char>(x) };
+
+            ASSERT_TRUE(bgImage.SetColor(bgColor, { x, y }));
+            ASSERT_TRUE(fgImage.SetColor(fgColor, { x, y }));
+        }
+    }
+
+    const auto render = [&](odr::InstructionSet instructionSet, odr::PixelFormat pixelFormat, odr::BlendMode blendMode, odr::Image& renderedImage) {
+        odr::RenderingEngineSettings settings;
+        settings.maxInstructionSet = instructionSet;
+        settings.frameBufferPixelFormat = pixelFormat;
+        settings.blendMode = blendMode;
+        odr::RenderingEngine engine(settings);
+
+        ASSERT_TRUE(engine.InitializeFrameBuffer({ 300, 260 }));
+        ASSERT_TRUE(engine.Draw(bgImage, { 1, 3 }, dimensions));
+        ASSERT_TRUE(engine.Draw(fgImage, { 1, 3 }, dimensions));
+        ASSERT_TRUE(engine.DrawRectangle({ 0, 0 }, { 299, 260 }, COLOR_LIGHT_GREEN, 13, COLOR_DARK_RED));
+        ASSERT_TRUE(engine.Render(renderedImage));
+    };
+
+    odr::Image scalarImage;
+    render(odr::InstructionSet::Scalar, odr::PixelFormat::Straight, odr::BlendMode::Float, scalarImage);
+
+    // Scalar kernels are PixelColor::Blend for each pixel
+    {
+        const odr::PixelCoordinates coords{ 200, 100 };
+        const odr::PixelCoordinates imageCoords{ 199, 97 };
+        const odr::PixelColor expectedColor = odr::PixelColor::Blend(
+            odr::PixelColor::Blend(bgImage.GetColor(imageCoords), fgImage.GetColor(imageCoords)),
+            COLOR_LIGHT_GREEN);
+        ASSERT_EQ(scalarImage.GetColor(coords), expectedColor);
+    }
+
+    odr::Image sse2Image;
+    render(odr::InstructionSet::Sse2, odr::PixelFormat::Straight, odr::BlendMode::Float, sse2Image);
+    ASSERT_EQ(scalarImage, sse2Image);
+
+    odr::Image avx2Image;
+    render(odr::InstructionSet::Avx2, odr::PixelFormat::Straight, odr::BlendMode::Float, avx2Image);
+    ASSERT_EQ(scalarImage, avx2Image);
+
+    // Premultiplied frame buffer
+    odr::Image scalarPremultipliedImage;
+    render(odr::InstructionSet::Scalar, odr::PixelFormat::Premultiplied, odr::BlendMode::Float, scalarPremultipliedImage);
+
+    odr::Image sse2PremultipliedImage;
+    render(odr::InstructionSet::Sse2, odr::PixelFormat::Premultiplied, odr::BlendMode::Float, sse2PremultipliedImage);
+    ASSERT_EQ(scalarPremultipliedImage, sse2PremultipliedImage);
+
+    odr::Image avx2PremultipliedImage;
+    render(odr::InstructionSet::Avx2, odr::PixelFormat::Premultiplied, odr::BlendMode::Float, avx2PremultipliedImage);
+    ASSERT_EQ(scalarPremultipliedImage, avx2PremultipliedImage);
+
+    // Fixed point blending
+    odr::Image scalarFixedPointImage;
+    render(odr::InstructionSet::Scalar, odr::PixelFormat::Straight, odr::BlendMode::FixedPoint, scalarFixedPointImage);
+    {
+        const odr::PixelCoordinates coords{ 200, 100 };
+        const odr::PixelCoordinates imageCoords{ 199, 97 };
+        const odr::PixelColor expectedColor = odr::PixelColor::BlendFixedPoint(
+            odr::PixelColor::BlendFixedPoint(bgImage.GetColor(imageCoords), fgImage.GetColor(imageCoords)),
+            COLOR_LIGHT_GREEN);
+        ASSERT_EQ(scalarFixedPointImage.GetColor(coords), expectedColor);
+    }
+
+    odr::Image sse2FixedPointImage;
+    render(odr::InstructionSet::Sse2, odr::PixelFormat::Straight, odr::BlendMode::FixedPoint, sse2FixedPointImage);
+    ASSERT_EQ(scalarFixedPointImage, sse2FixedPointImage);
+
+    odr::Image avx2FixedPointImage;
+    render(odr::InstructionSet::Avx2, odr::PixelFormat::Straight, odr::BlendMode::FixedPoint, avx2FixedPointImage);
+    ASSERT_EQ(scalarFixedPointImage, avx2FixedPointImage);
+}
+
+TEST_F(RenderingEngineTests, BlendModeFixedPoint) {
+    odr::RenderingEngineSettings settings;
+    settings.blendMode = odr::BlendMode::FixedPoint;
+    odr::RenderingEngine engine(settings);
+
+    const bool isBufferInitialized = engine.InitializeFrameBuffer({ 100, 100 });
+    ASSERT_TRUE(isBufferInitialized);
+
+    ASSERT_TRUE(engine.DrawRectangle({ 10, 10 }, { 50, 50 }, COLOR_LIGHT_GREEN, 0, COLOR_LIGHT_GREEN));
+    ASSERT_TRUE(engine.DrawRectangle({ 30, 30 }, { 50, 50 }, COLOR_DARK_RED, 0, COLOR_DARK_RED));
+
+    odr::Image renderedImage;
+    const bool isRendered = engine.Render(renderedImage);
+    ASSERT_TRUE(isRendered);
+
+    ASSERT_EQ(renderedImage.GetColor({ 20, 20 }), COLOR_LIGHT_GREEN);
+    ASSERT_EQ(renderedImage.GetColor({ 70, 70 }), COLOR_DARK_RED);
+    ASSERT_EQ(renderedImage.GetColor({ 40, 40 }), odr::PixelColor::BlendFixedPoint(COLOR_LIGHT_GREEN, COLOR_DARK_RED));
+}
+
+TEST_F(RenderingEngineTests, DrawRectangleBlendPremultiplied) {
+    odr::RenderingEngineSettings settings;
+    settings.frameBufferPixelFormat = odr::PixelFormat::Premultiplied;
+    odr::RenderingEngine engine(settings);
+
+    const bool isBufferInitialized = engine.InitializeFrameBuffer({ 100, 100 });
+    ASSERT_TRUE(isBufferInitialized);
+
+    ASSERT_TRUE(engine.DrawRectangle({ 10, 10 }, { 50, 50 }, COLOR_LIGHT_GREEN, 0, COLOR_LIGHT_GREEN));
+    ASSERT_TRUE(engine.DrawRectangle({ 30, 30 }, { 50, 50 }, COLOR_DARK_RED, 0, COLOR_DARK_RED));
+
+    odr::Image renderedImage;
+    const bool isRendered = engine.Render(renderedImage);
+    ASSERT_TRUE(isRendered);
+    ASSERT_EQ(renderedImage.GetPixelFormat(), odr::PixelFormat::Straight);
+
+    // 8-bit premultiplied colors lose precision
+    const auto assertNearColor = [](const odr::PixelColor& color, const odr::PixelColor& expectedColor) {
+        ASSERT_NEAR(color.r, expectedColor.r, 1);
+        ASSERT_NEAR(color.g, expectedColor.g, 1);
+        ASSERT_NEAR(color.b, expectedColor.b, 1);
+        ASSERT_EQ(color.a, expectedColor.a);
+    };
+
+    ASSERT_EQ(renderedImage.GetColor({ 0, 0 }), odr::COLOR_TRANSPARENT);
+    assertNearColor(renderedImage.GetColor({ 20, 20 }), COLOR_LIGHT_GREEN);
+    assertNearColor(renderedImage.GetColor({ 70, 70 }), COLOR_DARK_RED);
+    assertNearColor(renderedImage.GetColor({ 40, 40 }), odr::PixelColor::Blend(COLOR_LIGHT_GREEN, COLOR_DARK_RED));
+}
+
+TEST_F(RenderingEngineTests, DrawCompositeTiled) {
+    odr::RenderingEngineSettings settings;
+    settings.threadCount = 4;
+    settings.tileSize = 48;
+    odr::RenderingEngine engine(settings);
+    ASSERT_EQ(engine.GetThreadCount(), 4u);
+
+    odr::Image imgA;
+    ASSERT_TRUE(imgA.Load(std::string(TESTING_IMAGES_DIR) + "image-A.rgba"));
+    odr::Image imgB;
+    ASSERT_TRUE(imgB.Load(std::string(TESTING_IMAGES_DIR) + "image-B.rgba"));
+    odr::Image imgC;
+    ASSERT_TRUE(imgC.Load(std::string(TESTING_IMAGES_DIR) + "image-C.rgba"));
+
+    ASSERT_TRUE(engine.InitializeFrameBuffer({ 640, 480 }));
+    ASSERT_TRUE(engine.Draw(imgA, { -40, 60 }, { 720, 360 }));
+    ASSERT_TRUE(engine.DrawRectangle(
+        { 8, 8 },
+        { 624, 464 },
+        odr::PixelColor::RGBAlpha(0x00, 0x00, 0xFF, 12.5),
+        24,
+        odr::PixelColor::RGBAlpha(0x00, 0x40, 0x40, 100.0)));
+    ASSERT_TRUE(engine.Draw(imgB, { 0, 0 }, { 640, 480 }));
+    ASSERT_TRUE(engine.Draw(imgC, { 0, 0 }, { 256, 256 }));
+
+    odr::Image renderedImage;
+    ASSERT_TRUE(engine.Render(renderedImage));
+
+    // Identical to the serial engine
+    odr::Image testImage;
+    ASSERT_TRUE(testImage.Load(std::string(TESTING_IMAGES_DIR) + "test-image-composite_640x480.rgba"));
+    ASSERT_EQ(testImage, renderedImage);
+}
+
+TEST_F(RenderingEngineTests, DrawCompositeDeferred) {
+    odr::RenderingEngineSettings settings;
+    settings.renderMode = odr::RenderMode::Deferred;
+    settings.threadCount = 4;
+    settings.tileSize = 48;
+    odr::RenderingEngine engine(settings);
+
+    odr::Image imgA;
+    ASSERT_TRUE(imgA.Load(std::string(TESTING_IMAGES_DIR) + "image-A.rgba"));
+    odr::Image imgB;
+    ASSERT_TRUE(imgB.Load(std::string(TESTING_IMAGES_DIR) + "image-B.rgba"));
+    odr::Image imgC;
+    ASSERT_TRUE(imgC.Load(std::string(TESTING_IMAGES_DIR) + "image-C.rgba"));
+
+    ASSERT_TRUE(engine.InitializeFrameBuffer({ 640, 480 }));
+    ASSERT_TRUE(engine.Draw(imgA, { -40, 60 }, { 720, 360 }));
+    ASSERT_TRUE(engine.DrawRectangle(
+        { 8, 8 },
+        { 624, 464 },
+        odr::PixelColor::RGBAlpha(0x00, 0x00, 0xFF, 12.5),
+        24,
+        odr::PixelColor::RGBAlpha(0x00, 0x40, 0x40, 100.0)));
+    ASSERT_TRUE(engine.Draw(imgB, { 0, 0 }, { 640, 480 }));
+    ASSERT_TRUE(engine.Draw(imgC, { 0, 0 }, { 256, 256 }));
+    // Fully clipped, not recorded
+    ASSERT_TRUE(engine.Draw(imgC, { 700, 0 }, { 256, 256 }));
+    ASSERT_EQ(engine.GetDeferredCommandCount(), 4u);
+
+    // The recorded images are copies
+    imgB.Clear();
+
+    odr::Image renderedImage;
+    ASSERT_TRUE(engine.Render(renderedImage));
+    ASSERT_EQ(engine.GetDeferredCommandCount(), 0u);
+
+    odr::Image testImage;
+    ASSERT_TRUE(testImage.Load(std::string(TESTING_IMAGES_DIR) + "test-image-composite_640x480.rgba"));
+    ASSERT_EQ(testImage, renderedImage);
+}
+
+TEST_F(RenderingEngineTests, DeferredRectanglesMerged) {
+    const auto render = [](odr::RenderMode renderMode, odr::Image& renderedImage) {
+        odr::RenderingEngineSettings settings;
+        settings.renderMode = renderMode;
+        odr::RenderingEngine engine(settings);
+        ASSERT_TRUE(engine.InitializeFrameBuffer({ 100, 100 }));
+
+        // Row of adjacent cells, then a column below the last one
+        for (int32_t left = 0; left < 80; left += 20) {
+            ASSERT_TRUE(engine.DrawRectangle({ left, 10 }, { 20, 20 }, COLOR_LIGHT_GREEN, 0, COLOR_LIGHT_GREEN));
+        }
+        ASSERT_TRUE(engine.DrawRectangle({ 60, 30 }, { 20, 50 }, COLOR_LIGHT_GREEN, 0, COLOR_LIGHT_GREEN));
+        // Stroke only, same as a filled rectangle of the stroke color
+        ASSERT_TRUE(engine.DrawRectangle({ 60, 80 }, { 20, 20 }, COLOR_DARK_RED, 10, COLOR_LIGHT_GREEN));
+        // Overlapping, must not be merged
+        ASSERT_TRUE(engine.DrawRectangle({ 50, 50 }, { 30, 30 }, COLOR_LIGHT_GREEN, 0, COLOR_LIGHT_GREEN));
+        ASSERT_TRUE(engine.DrawRectangle({ 5, 5 }, { 30, 30 }, COLOR_DARK_RED, 4, COLOR_LIGHT_GREEN));
+
+        if (renderMode == odr::RenderMode::Deferred) {
+            ASSERT_EQ(engine.GetDeferredCommandCount(), 4u);
+        }
+
+        ASSERT_TRUE(engine.Render(renderedImage));
+    };
+
+    odr::Image immediateImage;
+    render(odr::RenderMode::Immediate, immediateImage);
+    odr::Image deferredImage;
+    render(odr::RenderMode::Deferred, deferredImage);
+
+    ASSERT_EQ(immediateImage, deferredImage);
+}
+
+TEST_F(RenderingEngineTests, DeferredOcclusionCulling) {
+    const odr::PixelColor opaqueBlue{ 0x20, 0x40, 0xC0, 0xFF };
+    const odr::PixelColor opaqueGray{ 0x80, 0x80, 0x80, 0xFF };
+
+    odr::Image imgB;
+    ASSERT_TRUE(imgB.Load(std::string(TESTING_IMAGES_DIR) + "image-B.rgba"));
+    odr::Image opaqueImage;
+    ASSERT_TRUE(opaqueImage.Initialize({ 120, 40 }, opaqueGray));
+
+    const auto render = [&](odr::RenderingEngineSettings settings, bool isCullingEnabled, odr::Image& renderedImage, uint64_t& culledPixelCount) {
+        settings.renderMode = odr::RenderMode::Deferred;
+        settings.isOcclusionCullingEnabled = isCullingEnabled;
+        settings.threadCount = 3;
+        settings.tileSize = 32;
+        odr::RenderingEngine engine(settings);
+        ASSERT_TRUE(engine.InitializeFrameBuffer({ 200, 150 }));
+
+        ASSERT_TRUE(engine.DrawRectangle({ 0, 0 }, { 200, 150 }, COLOR_LIGHT_GREEN, 0, COLOR_LIGHT_GREEN));
+        ASSERT_TRUE(engine.Draw(imgB, { -20, -10 }, { 240, 170 }));
+        // Full-bleed opaque background over the left part
+        ASSERT_TRUE(engine.DrawRectangle({ -10, -10 }, { 120, 200 }, opaqueBlue, 0, opaqueBlue));
+        // Opaque panel with a translucent stroke, only the interior hides the content below
+        ASSERT_TRUE(engine.DrawRectangle({ 90, 30 }, { 80, 80 }, opaqueGray, 6, COLOR_DARK_RED));
+        ASSERT_TRUE(engine.Draw(opaqueImage, { 60, 100 }, { 120, 40 }));
+        ASSERT_TRUE(engine.DrawRectangle({ 40, 40 }, { 100, 100 }, COLOR_DARK_RED, 0, COLOR_DARK_RED));
+
+        ASSERT_TRUE(engine.Render(renderedImage));
+        culledPixelCount = engine.GetCulledPixelCount();
+    };
+
+    std::vector<odr::RenderingEngineSettings> settingsVariants(4);
+    settingsVariants[1].maxInstructionSet = odr::InstructionSet::Scalar;
+    settingsVariants[2].blendMode = odr::BlendMode::FixedPoint;
+    settingsVariants[3].frameBufferPixelFormat = odr::PixelFormat::Premultiplied;
+
+    for (const odr::RenderingEngineSettings& settings : settingsVariants) {
+        odr::Image culledImage;
+        uint64_t culledPixelCount = 0;
+        render(settings, true, culledImage, culledPixelCount);
+        ASSERT_GT(culledPixelCount, 0u);
+
+        odr::Image referenceImage;
+        uint64_t referenceCulledPixelCount = 0;
+        render(settings, false, referenceImage, referenceCulledPixelCount);
+        ASSERT_EQ(referenceCulledPixelCount, 0u);
+
+        ASSERT_EQ(culledImage, referenceImage);
+    }
+}
+
+TEST_F(RenderingEngineTests, DeferredOcclusionCullingCount) {
+    odr::RenderingEngineSettings settings;
+    settings.renderMode = odr::RenderMode::Deferred;
+    odr::RenderingEngine engine(settings);
+    ASSERT_TRUE(engine.InitializeFrameBuffer({ 100, 100 }));
+
+    ASSERT_TRUE(engine.DrawRectangle({ 0, 0 }, { 100, 100 }, COLOR_LIGHT_GREEN, 0, COLOR_LIGHT_GREEN));
+    ASSERT_TRUE(engine.DrawRectangle({ 20, 0 }, { 50, 30 }, COLOR_DARK_RED, 0, COLOR_DARK_RED));
+    ASSERT_TRUE(engine.DrawRectangle({ 0, 10 }, { 100, 90 }, odr::PixelColor{ 0x10, 0x20, 0x30, 0xFF }, 0, COLOR_DARK_RED));
+
+    odr::Image renderedImage;
+    ASSERT_TRUE(engine.Render(renderedImage));
+
+    // Rows 10 and below of the first two rectangles are hidden
+    ASSERT_EQ(engine.GetCulledPixelCount(), 100u * 90u + 50u * 20u);
+    ASSERT_EQ(renderedImage.GetColor({ 30, 5 }), odr::PixelColor::Blend(COLOR_LIGHT_GREEN, COLOR_DARK_RED));
+    ASSERT_EQ(renderedImage.GetColor({ 30, 50 }), (odr::PixelColor{ 0x10, 0x20, 0x30, 0xFF }));
+}
+
+TEST_F(RenderingEngineTests, RetainedIncrementalRender) {
+    odr::Image imgB;
+    ASSERT_TRUE(imgB.Load(std::string(TESTING_IMAGES_DIR) + "image-B.rgba"));
+
+    const auto drawScene = [&](odr::RenderingEngine& engine, const odr::PixelColor& panelColor) {
+        ASSERT_TRUE(engine.DrawRectangle({ 10, 10 }, { 180, 130 }, COLOR_LIGHT_GREEN, 4, COLOR_DARK_RED));
+        ASSERT_TRUE(engine.Draw(imgB, { 0, 0 }, { 200, 150 }));
+        ASSERT_TRUE(engine.DrawRectangle({ 120, 20 }, { 40, 30 }, panelColor, 0, panelColor));
+    };
+
+    odr::RenderingEngineSettings settings;
+    settings.renderMode = odr::RenderMode::Retained;
+    settings.threadCount = 2;
+    settings.tileSize = 32;
+    odr::RenderingEngine engine(settings);
+    ASSERT_TRUE(engine.InitializeFrameBuffer({ 200, 150 }));
+
+    // First frame is rendered whole
+    drawScene(engine, COLOR_DARK_RED);
+    odr::Image renderedImage;
+    std::vector<odr::PixelRectangle> changedRegions;
+    ASSERT_TRUE(engine.Render(renderedImage, changedRegions));
+    ASSERT_EQ(changedRegions.size(), 1u);
+    ASSERT_EQ(changedRegions[0], (odr::PixelRectangle{ { 0, 0 }, { 200, 150 } }));
+
+    // Same scene, nothing to do
+    engine.BeginFrame();
+    drawScene(engine, COLOR_DARK_RED);
+    ASSERT_TRUE(engine.Render(renderedImage, changedRegions));
+    ASSERT_TRUE(changedRegions.empty());
+
+    // Only the edited panel is recomposited
+    engine.BeginFrame();
+    drawScene(engine, COLOR_LIGHT_GREEN);
+    ASSERT_TRUE(engine.Render(renderedImage, changedRegions));
+    ASSERT_EQ(changedRegions.size(), 1u);
+    ASSERT_EQ(changedRegions[0], (odr::PixelRectangle{ { 120, 20 }, { 40, 30 } }));
+
+    // Identical to rendering the edited scene from scratch
+    odr::RenderingEngine referenceEngine;
+    ASSERT_TRUE(referenceEngine.InitializeFrameBuffer({ 200, 150 }));
+    drawScene(referenceEngine, COLOR_LIGHT_GREEN);
+    odr::Image referenceImage;
+    ASSERT_TRUE(referenceEngine.Render(referenceImage));
+    ASSERT_EQ(renderedImage, referenceImage);
+
+    // Removed content is cleared
+    engine.BeginFrame();
+    ASSERT_TRUE(engine.DrawRectangle({ 10, 10 }, { 180, 130 }, COLOR_LIGHT_GREEN, 4, COLOR_DARK_RED));
+    ASSERT_TRUE(engine.Render(renderedImage, changedRegions));
+    ASSERT_EQ(changedRegions.size(), 1u);
+    ASSERT_EQ(changedRegions[0], (odr::PixelRectangle{ { 0, 0 }, { 200, 150 } }));
+    ASSERT_EQ(renderedImage.GetColor({ 0, 0 }), odr::COLOR_TRANSPARENT);
+    ASSERT_EQ(renderedImage.GetColor({ 100, 70 }), COLOR_LIGHT_GREEN);
+}
+
+TEST_F(RenderingEngineTests, RetainedReusesUnchangedImages) {
+    odr::Image imgB;
+    ASSERT_TRUE(imgB.Load(std::string(TESTING_IMAGES_DIR) + "image-B.rgba"));
+
+    odr::RenderingEngineSettings settings;
+    settings.renderMode = odr::RenderMode::Retained;
+    odr::RenderingEngine engine(settings);
+    ASSERT_TRUE(engine.InitializeFrameBuffer({ 200, 150 }));
+
+    // Image data allocated while recording a frame - the resampled copies of the images
+    const auto recordFrame = [&]() {
+        const auto allocator = std::make_shared<odr::ImageAllocator>();
+        odr::ImageAllocatorScope allocatorScope(allocator);
+        engine.BeginFrame();
+        EXPECT_TRUE(engine.Draw(imgB, { -20, 10 }, { 300, 120 }));
+        EXPECT_TRUE(engine.Draw(imgB, { 50, 50 }, imgB.GetDimensions()));
+        return allocator->GetAllocationCount();
+    };
+
+    ASSERT_EQ(recordFrame(), 2u);
+    odr::Image renderedImage;
+    std::vector<odr::PixelRectangle> changedRegions;
+    ASSERT_TRUE(engine.Render(renderedImage, changedRegions));
+
+    // Unchanged images are neither resampled nor compared again
+    ASSERT_EQ(recordFrame(), 0u);
+    ASSERT_TRUE(engine.Render(renderedImage, changedRegions));
+    ASSERT_TRUE(changedRegions.empty());
+
+    // A changed image is recorded again
+    ASSERT_TRUE(imgB.SetColor(COLOR_LIGHT_GREEN, { 60, 30 }));
+    ASSERT_EQ(recordFrame(), 2u);
+    ASSERT_TRUE(engine.Render(renderedImage, changedRegions));
+    ASSERT_FALSE(changedRegions.empty());
+
+    odr::RenderingEngine referenceEngine;
+    ASSERT_TRUE(referenceEngine.InitializeFrameBuffer({ 200, 150 }));
+    ASSERT_TRUE(referenceEngine.Draw(imgB, { -20, 10 }, { 300, 120 }));
+    ASSERT_TRUE(referenceEngine.Draw(imgB, { 50, 50 }, imgB.GetDimensions()));
+    odr::Image referenceImage;
+    ASSERT_TRUE(referenceEngine.Render(referenceImage));
+    ASSERT_EQ(renderedImage, referenceImage);
+}
+
+TEST_F(RenderingEngineTests, DrawScaledFused) {
+    odr::Image imgA;
+    ASSERT_TRUE(imgA.Load(std::string(TESTING_IMAGES_DIR) + "image-A.rgba"));
+
+    for (const odr::PixelFormat pixelFormat : { odr::PixelFormat::Straight, odr::PixelFormat::Premultiplied }) {
+        odr::RenderingEngineSettings settings;
+        settings.frameBufferPixelFormat = pixelFormat;
+
+        // Reference: the whole scaled image composited at its position
+        const odr::PixelCoordinatesUnbounded imagePosition{ -300, -200 };
+        const odr::ImageDimensions imageDimensions{ 900, 700 };
+        odr::Image scaledImage = imgA.Scaled(imageDimensions);
+        odr::Image referenceImage;
+        ASSERT_TRUE(referenceImage.Initialize({ 320, 240 }, odr::COLOR_TRANSPARENT));
+        for (uint32_t y = 0; y < 240; y++) {
+            for (uint32_t x = 0; x < 320; x++) {
+                const odr::PixelColor color = scaledImage.GetColor({ x + 300, y + 200 });
+                referenceImage.SetColor(pixelFormat == odr::PixelFormat::Premultiplied
+                    ? odr::PixelColor::Unpremultiplied(odr::PixelColor::Premultiplied(color))
+                    : odr::PixelColor::Blend(odr::COLOR_TRANSPARENT, color), { x, y });
+            }
+        }
+
+        for (const odr::RenderMode renderMode : { odr::RenderMode::Immediate, odr::RenderMode::Deferred }) {
+            settings.renderMode = renderMode;
+            odr::RenderingEngine engine(settings);
+            ASSERT_TRUE(engine.InitializeFrameBuffer({ 320, 240 }));
+            ASSERT_TRUE(engine.Draw(imgA, imagePosition, imageDimensions));
+
+            odr::Image renderedImage;
+            ASSERT_TRUE(engine.Render(renderedImage));
+            ASSERT_EQ(renderedImage, referenceImage);
+        }
+    }
+}
+
+TEST_F(RenderingEngineTests, DrawHugeScaledImage) {
+    odr::Image imgC;
+    ASSERT_TRUE(imgC.Load(std::string(TESTING_IMAGES_DIR) + "image-C.rgba"));
+
+    // The whole scaled image would take gigabytes, only the visible part is computed
+    const odr::PixelCoordinatesUnbounded imagePosition{ -30000, -20000 };
+    const odr::ImageDimensions imageDimensions{ 60000, 40000 };
+
+    odr::Image immediateImage;
+    {
+        odr::RenderingEngine engine;
+        ASSERT_TRUE(engine.InitializeFrameBuffer({ 200, 100 }));
+        ASSERT_TRUE(engine.Draw(imgC, imagePosition, imageDimensions));
+        ASSERT_TRUE(engine.Render(immediateImage));
+    }
+
+    odr::Image deferredImage;
+    {
+        odr::RenderingEngineSettings settings;
+        settings.renderMode = odr::RenderMode::Deferred;
+        odr::RenderingEngine engine(settings);
+        ASSERT_TRUE(engine.InitializeFrameBuffer({ 200, 100 }));
+        ASSERT_TRUE(engine.Draw(imgC, imagePosition, imageDimensions));
+        ASSERT_TRUE(engine.Render(deferredImage));
+    }
+
+    ASSERT_EQ(immediateImage, deferredImage);
+
+    // Upscaled around the source center
+    const odr::ImageDimensions& sourceDimensions = imgC.GetDimensions();
+    const odr::PixelColor sourceColor = imgC.GetColor({ sourceDimensions.width / 2, sourceDimensions.height / 2 });
+    ASSERT_EQ(immediateImage.GetColor({ 0, 0 }), odr::PixelColor::Blend(odr::COLOR_TRANSPARENT, sourceColor));
+}
+
+TEST_F(RenderingEngineTests, DrawScaledFilters) {
+    odr::Image imgC;
+    ASSERT_TRUE(imgC.Load(std::string(TESTING_IMAGES_DIR) + "image-C.rgba"));
+
+    const odr::PixelCoordinatesUnbounded imagePosition{ -50, 20 };
+    const odr::ImageDimensions imageDimensions{ 430, 170 };
+
+    for (const odr::ResamplingFilter filter : {
+        odr::ResamplingFilter::SummedAreaBox,
+        odr::ResamplingFilter::Bilinear,
+        odr::ResamplingFilter::Bicubic,
+        odr::ResamplingFilter::Lanczos3 }) {
+        odr::Image referenceImage;
+        {
+            odr::RenderingEngine engine;
+            ASSERT_TRUE(engine.InitializeFrameBuffer({ 320, 240 }));
+            const odr::Image scaledImage = imgC.Scaled(imageDimensions, filter);
+            ASSERT_TRUE(engine.Draw(scaledImage, imagePosition, imageDimensions));
+            ASSERT_TRUE(engine.Render(referenceImage));
+        }
+
+        // Fused, tiled and recorded draws compute the same pixels
+        for (const odr::RenderMode renderMode : { odr::RenderMode::Immediate, odr::RenderMode::Deferred }) {
+            odr::RenderingEngineSettings settings;
+            settings.resamplingFilter = filter;
+            settings.renderMode = renderMode;
+            settings.threadCount = 3;
+            settings.tileSize = 40;
+            odr::RenderingEngine engine(settings);
+            ASSERT_TRUE(engine.InitializeFrameBuffer({ 320, 240 }));
+            ASSERT_TRUE(engine.Draw(imgC, imagePosition, imageDimensions));
+
+            odr::Image renderedImage;
+            ASSERT_TRUE(engine.Render(renderedImage));
+            ASSERT_EQ(renderedImage, referenceImage);
+        }
+    }
+}
+
+TEST_F(RenderingEngineTests, DrawScaledFromMipmaps) {
+    odr::Image imgC;
+    ASSERT_TRUE(imgC.Load(std::string(TESTING_IMAGES_DIR) + "image-C.rgba"));
+    imgC.SetMipmapsEnabled(true);
+
+    const odr::ImageDimensions& sourceDimensions = imgC.GetDimensions();
+    // Exactly a mipmap level, and between two levels
+    for (const odr::ImageDimensions& imageDimensions : {
+        odr::ImageDimensions{ sourceDimensions.width / 2, sourceDimensions.height / 2 },
+        odr::ImageDimensions{ 210, 130 } }) {
+        odr::Image referenceImage;
+        {
+            odr::RenderingEngine engine;
+            ASSERT_TRUE(engine.InitializeFrameBuffer({ 320, 240 }));
+            const odr::Image scaledImage = imgC.Scaled(imageDimensions, odr::ResamplingFilter::Bilinear);
+            ASSERT_TRUE(engine.Draw(scaledImage, { -30, 10 }, imageDimensions));
+            ASSERT_TRUE(engine.Render(referenceImage));
+        }
+
+        for (const odr::RenderMode renderMode : { odr::RenderMode::Immediate, odr::RenderMode::Deferred }) {
+            odr::RenderingEngineSettings settings;
+            settings.resamplingFilter = odr::ResamplingFilter::Bilinear;
+            settings.renderMode = renderMode;
+            settings.threadCount = 3;
+            settings.tileSize = 40;
+            odr::RenderingEngine engine(settings);
+            ASSERT_TRUE(engine.InitializeFrameBuffer({ 320, 240 }));
+            ASSERT_TRUE(engine.Draw(imgC, { -30, 10 }, imageDimensions));
+
+            odr::Image renderedImage;
+            ASSERT_TRUE(engine.Render(renderedImage));
+            ASSERT_EQ(renderedImage, referenceImage);
+        }
+    }
+}
+
+TEST_F(RenderingEngineTests, TakeFrameBuffer) {
+    for (const odr::PixelFormat pixelFormat : { odr::PixelFormat::Straight, odr::PixelFormat::Premultiplied }) {
+        odr::RenderingEngineSettings settings;
+        settings.frameBufferPixelFormat = pixelFormat;
+        odr::RenderingEngine engine(settings);
+        ASSERT_TRUE(engine.InitializeFrameBuffer({ 320, 240 }));
+
+        odr::Image renderedImage;
+        odr::Image takenImage;
+        std::vector<const unsigned char*> takenFrameData;
+        for (uint32_t frame = 0; frame < 3; frame++) {
+            ASSERT_TRUE(engine.DrawRectangle({ 10 + static_cast<int32_t>(frame) * 20, 30 }, { 100, 50 }, COLOR_LIGHT_GREEN, 3, COLOR_DARK_RED));
+            ASSERT_TRUE(engine.Render(renderedImage));
+            ASSERT_TRUE(engine.TakeFrameBuffer(takenImage));
+            ASSERT_EQ(takenImage.GetPixelFormat(), odr::PixelFormat::Straight);
+            ASSERT_EQ(takenImage, renderedImage);
+
+            // Two buffers alternate between the engine and the caller
+            const odr::Image& constTakenImage = takenImage;
+            takenFrameData.push_back(constTakenImage.GetRowData(0));
+            if (frame >= 2) {
+                ASSERT_EQ(takenFrameData[frame], takenFrameData[frame - 2]);
+            }
+
+            odr::Image nextFrame;
+            ASSERT_TRUE(engine.Render(nextFrame));
+            ASSERT_EQ(nextFrame.GetColor({ 50, 50 }), odr::COLOR_TRANSPARENT);
+        }
+    }
+}
+
+TEST_F(RenderingEngineTests, TakeFrameBufferRetained) {
+    odr::Image imgA;
+    ASSERT_TRUE(imgA.Load(std::string(TESTING_IMAGES_DIR) + "image-A.rgba"));
+
+    for (const odr::PixelFormat pixelFormat : { odr::PixelFormat::Straight, odr::PixelFormat::Premultiplied }) {
+        odr::RenderingEngineSettings settings;
+        settings.frameBufferPixelFormat = pixelFormat;
+        settings.renderMode = odr::RenderMode::Retained;
+        odr::RenderingEngine engine(settings);
+        ASSERT_TRUE(engine.InitializeFrameBuffer({ 320, 240 }));
+
+        odr::RenderingEngineSettings referenceSettings;
+        referenceSettings.frameBufferPixelFormat = pixelFormat;
+        odr::RenderingEngine referenceEngine(referenceSettings);
+
+        odr::Image takenImage;
+        for (uint32_t frame = 0; frame < 3; frame++) {
+            const odr::PixelCoordinatesUnbounded movingPosition{ 10 + static_cast<int32_t>(frame) * 20, 30 };
+            const auto drawScene = [&](odr::RenderingEngine& sceneEngine) {
+                ASSERT_TRUE(sceneEngine.Draw(imgA, { 0, 0 }, { 200, 150 }));
+                ASSERT_TRUE(sceneEngine.DrawRectangle(movingPosition, { 100, 50 }, COLOR_LIGHT_GREEN, 3, COLOR_DARK_RED));
+            };
+
+            engine.BeginFrame();
+            drawScene(engine);
+            ASSERT_TRUE(engine.TakeFrameBuffer(takenImage));
+
+            odr::Image referenceImage;
+            ASSERT_TRUE(referenceEngine.InitializeFrameBuffer({ 320, 240 }));
+            drawScene(referenceEngine);
+            ASSERT_TRUE(referenceEngine.Render(referenceImage));
+            ASSERT_EQ(takenImage, referenceImage);
+
+            // The scene is retained, the next frame buffer already holds it
+            odr::Image nextFrame;
+            ASSERT_TRUE(engine.Render(nextFrame));
+            ASSERT_EQ(nextFrame, referenceImage);
+        }
+    }
+}
+
+TEST_F(RenderingEngineTests, LayerGroups) {
+    constexpr odr::PixelColor COLOR_OPAQUE_BLUE{ 0x20, 0x40, 0xF0, 0xFF };
+
+    odr::Image imgA;
+    ASSERT_TRUE(imgA.Load(std::string(TESTING_IMAGES_DIR) + "image-A.rgba"));
+
+    const auto drawBackground = [&](odr::RenderingEngine& engine) {
+        ASSERT_TRUE(engine.Draw(imgA, { 0, 0 }, { 200, 150 }));
+    };
+    const auto drawGroup = [&](odr::RenderingEngine& engine) {
+        ASSERT_TRUE(engine.DrawRectangle({ 30, 20 }, { 80, 60 }, COLOR_LIGHT_GREEN, 4, COLOR_OPAQUE_BLUE));
+        ASSERT_TRUE(engine.DrawRectangle({ 70, 50 }, { 60, 60 }, COLOR_DARK_RED, 0, COLOR_DARK_RED));
+    };
+
+    for (const odr::PixelFormat pixelFormat : { odr::PixelFormat::Straight, odr::PixelFormat::Premultiplied }) {
+        odr::RenderingEngineSettings settings;
+        settings.frameBufferPixelFormat = pixelFormat;
+
+        // A fully opaque group looks like its content drawn directly, up to rounding
+        odr::RenderingEngine directEngine(settings);
+        ASSERT_TRUE(directEngine.InitializeFrameBuffer({ 200, 150 }));
+        drawBackground(directEngine);
+        drawGroup(directEngine);
+        odr::Image directImage;
+        ASSERT_TRUE(directEngine.Render(directImage));
+
+        odr::RenderingEngine engine(settings);
+        ASSERT_TRUE(engine.InitializeFrameBuffer({ 200, 150 }));
+        drawBackground(engine);
+        ASSERT_TRUE(engine.BeginLayer({ 30, 20 }, { 100, 90 }, 255));
+        ASSERT_EQ(engine.GetLayerDepth(), 1u);
+        drawGroup(engine);
+        ASSERT_TRUE(engine.EndLayer());
+        ASSERT_EQ(engine.GetLayerDepth(), 0u);
+        ASSERT_EQ(engine.GetLayerByteSize(), 100u * 90u * 4u);
+
+        odr::Image layeredImage;
+        ASSERT_TRUE(engine.Render(layeredImage));
+        odr::ImageComparisonSettings comparisonSettings;
+        comparisonSettings.tolerance = 2;
+        ASSERT_TRUE(odr::Image::Compare(layeredImage, directImage, comparisonSettings).IsMatch());
+
+        // The group opacity scales the alpha of the whole group, overlapping content is not blended twice
+        odr::RenderingEngine translucentEngine(settings);
+        ASSERT_TRUE(translucentEngine.InitializeFrameBuffer({ 200, 150 }));
+        ASSERT_TRUE(translucentEngine.BeginLayer({ 0, 0 }, { 200, 150 }, 0x80));
+        drawGroup(translucentEngine);
+        ASSERT_TRUE(translucentEngine.EndLayer());
+        odr::Image translucentImage;
+        ASSERT_TRUE(translucentEngine.Render(translucentImage));
+        ASSERT_EQ(translucentImage.GetColor({ 50, 21 }).a, 0x80);
+        ASSERT_EQ(translucentImage.GetColor({ 50, 40 }).a, 0x40);
+        ASSERT_EQ(translucentImage.GetColor({ 80, 55 }).a, 0x60);
+        ASSERT_EQ(translucentImage.GetColor({ 150, 100 }), odr::COLOR_TRANSPARENT);
+
+        // Transparent groups change nothing
+        ASSERT_TRUE(engine.BeginLayer({ 0, 0 }, { 200, 150 }, 0));
+        drawGroup(engine);
+        ASSERT_TRUE(engine.EndLayer());
+        odr::Image unchangedImage;
+        ASSERT_TRUE(engine.Render(unchangedImage));
+        ASSERT_EQ(unchangedImage, layeredImage);
+    }
+}
+
+TEST_F(RenderingEngineTests, LayerGroupsNested) {
+    // Nested layers are clipped to the enclosing ones and to the frame buffer
+    odr::RenderingEngine engine;
+    ASSERT_TRUE(engine.InitializeFrameBuffer({ 200, 150 }));
+    ASSERT_TRUE(engine.BeginLayer({ -20, 10 }, { 100, 100 }, 255));
+    ASSERT_TRUE(engine.BeginLayer({ 40, 50 }, { 200, 200 }, 255));
+    ASSERT_EQ(engine.GetLayerByteSize(), (80u * 100u + 40u * 60u) * 4u);
+    ASSERT_TRUE(engine.DrawRectangle({ 0, 0 }, { 200, 150 }, COLOR_LIGHT_GREEN, 0, COLOR_LIGHT_GREEN));
+
+    // Fully clipped layers take no buffer
+    ASSERT_TRUE(engine.BeginLayer({ 300, 10 }, { 10, 10 }, 255));
+    ASSERT_TRUE(engine.DrawRectangle({ 0, 0 }, { 200, 150 }, COLOR_DARK_RED, 0, COLOR_DARK_RED));
+    ASSERT_TRUE(engine.EndLayer());
+    ASSERT_EQ(engine.GetLayerByteSize(), (80u * 100u + 40u * 60u) * 4u);
+
+    // Nothing is rendered while layers are open
+    odr::Image renderedImage;
+    ASSERT_FALSE(engine.Render(renderedImage));
+    ASSERT_TRUE(engine.EndLayer());
+    ASSERT_TRUE(engine.EndLayer());
+    ASSERT_FALSE(engine.EndLayer());
+    ASSERT_TRUE(engine.Render(renderedImage));
+
+    for (uint32_t y = 0; y < 150; y++) {
+        for (uint32_t x = 0; x < 200; x++) {
+            const bool isInside = x >= 40 && x < 80 && y >= 50 && y < 110;
+            ASSERT_EQ(renderedImage.GetColor({ x, y }), isInside ? COLOR_LIGHT_GREEN : odr::COLOR_TRANSPARENT);
+        }
+    }
+}
+
+TEST_F(RenderingEngineTests, LayerGroupsRenderModes) {
+    odr::Image imgA;
+    ASSERT_TRUE(imgA.Load(std::string(TESTING_IMAGES_DIR) + "image-A.rgba"));
+
+    const auto drawFrame = [&](odr::RenderingEngine& engine) {
+        ASSERT_TRUE(engine.DrawRectangle({ 10, 10 }, { 180, 130 }, COLOR_LIGHT_GREEN, 4, COLOR_DARK_RED));
+        ASSERT_TRUE(engine.BeginLayer({ 20, 20 }, { 120, 90 }, 0xC0));
+        ASSERT_TRUE(engine.Draw(imgA, { -50, -40 }, { 300, 200 }));
+        ASSERT_TRUE(engine.BeginLayer({ 60, 40 }, { 50, 50 }, 0x60));
+        ASSERT_TRUE(engine.DrawRectangle({ 50, 30 }, { 40, 40 }, COLOR_DARK_RED, 0, COLOR_DARK_RED));
+        ASSERT_TRUE(engine.EndLayer());
+        ASSERT_TRUE(engine.EndLayer());
+        ASSERT_TRUE(engine.DrawRectangle({ 100, 60 }, { 40, 40 }, COLOR_LIGHT_GREEN, 0, COLOR_LIGHT_GREEN));
+    };
+
+    const auto render = [&](odr::RenderMode renderMode, uint32_t threadCount, odr::Image& renderedImage) {
+        odr::RenderingEngineSettings settings;
+        settings.frameBufferPixelFormat = odr::PixelFormat::Premultiplied;
+        settings.renderMode = renderMode;
+        settings.threadCount = threadCount;
+        settings.tileSize = 32;
+        odr::RenderingEngine engine(settings);
+        ASSERT_TRUE(engine.InitializeFrameBuffer({ 200, 150 }));
+
+        // Every frame starts transparent, the retained scene is recomposited where it changed
+        for (uint32_t frame = 0; frame < 3; frame++) {
+            if (renderMode == odr::RenderMode::Retained) {
+                engine.BeginFrame();
+            } else {
+                ASSERT_TRUE(engine.InitializeFrameBuffer({ 200, 150 }));
+            }
+            ASSERT_EQ(engine.GetLayerByteSize(), 0u);
+            drawFrame(engine);
+            ASSERT_EQ(engine.GetLayerByteSize(), (120u * 90u + 50u * 50u) * 4u);
+
+            std::vector<odr::PixelRectangle> changedRegions;
+            ASSERT_TRUE(engine.Render(renderedImage, changedRegions));
+            // The unchanged scene is not recomposited
+            if (renderMode == odr::RenderMode::Retained && frame > 0) {
+                ASSERT_TRUE(changedRegions.empty());
+            }
+        }
+
+        // Layer buffers are recycled across frames
+        ASSERT_GT(engine.GetLayerAllocator().GetReusedAllocationCount(), 0u);
+    };
+
+    odr::Image immediateImage;
+    render(odr::RenderMode::Immediate, 1, immediateImage);
+    for (const odr::RenderMode renderMode : { odr::RenderMode::Immediate, odr::RenderMode::Deferred, odr::RenderMode::Retained }) {
+        odr::Image renderedImage;
+        render(renderMode, 4, renderedImage);
+        ASSERT_EQ(renderedImage, immediateImage);
+    }
+}
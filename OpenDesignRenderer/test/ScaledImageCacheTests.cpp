@@ -0,0 +1,131 @@
+#include <memory>
+#include <gtest/gtest.h>
+
+#include <OpenDesignRenderer/Image.h>
+#include <OpenDesignRenderer/PixelColor.h>
+#include <OpenDesignRenderer/RenderingEngine.h>
+#include <OpenDesignRenderer/ScaledImageCache.h>
+
+
+namespace {
+constexpr odr::PixelColor COLOR_LIGHT_GREEN{ 0x70, 0xF0, 0x70, 0x80 };
+}
+
+//! ScaledImageCache class tests.
+class ScaledImageCacheTests : public ::testing::Test {
+protected:
+    virtual void SetUp() override {
+    }
+};
+
+TEST_F(ScaledImageCacheTests, HitAndMiss) {
+    odr::Image imgA;
+    ASSERT_TRUE(imgA.Load(std::string(TESTING_IMAGES_DIR) + "image-A.rgba"));
+
+    odr::ScaledImageCache cache(1024 * 1024);
+
+    const std::shared_ptr<const odr::Image> scaledImage = cache.FindOrCreate(imgA, { 150, 200 }, odr::PixelFormat::Straight);
+    ASSERT_NE(scaledImage, nullptr);
+    ASSERT_EQ(*scaledImage, imgA.Scaled({ 150, 200 }));
+    ASSERT_EQ(cache.GetMissCount(), 1u);
+    ASSERT_EQ(cache.GetHitCount(), 0u);
+    ASSERT_EQ(cache.GetByteSize(), 150u * 200u * 4u);
+
+    ASSERT_EQ(cache.FindOrCreate(imgA, { 150, 200 }, odr::PixelFormat::Straight), scaledImage);
+    ASSERT_EQ(cache.GetHitCount(), 1u);
+
+    // Another size and another pixel format are other entries
+    ASSERT_NE(cache.FindOrCreate(imgA, { 150, 100 }, odr::PixelFormat::Straight), nullptr);
+    ASSERT_NE(cache.FindOrCreate(imgA, { 150, 200 }, odr::PixelFormat::Premultiplied), nullptr);
+    ASSERT_EQ(cache.GetMissCount(), 3u);
+    ASSERT_EQ(cache.GetEntryCount(), 3u);
+
+    // Changed content is never served from the cache
+    ASSERT_TRUE(imgA.SetColor(COLOR_LIGHT_GREEN, { 0, 0 }));
+    ASSERT_EQ(cache.Find(imgA, { 150, 200 }, odr::PixelFormat::Straight), nullptr);
+    ASSERT_EQ(cache.GetMissCount(), 4u);
+}
+
+TEST_F(ScaledImageCacheTests, LeastRecentlyUsedEviction) {
+    odr::Image imgC;
+    ASSERT_TRUE(imgC.Load(std::string(TESTING_IMAGES_DIR) + "image-C.rgba"));
+
+    // Room for two 100x100 images
+    odr::ScaledImageCache cache(2 * 100 * 100 * 4);
+
+    ASSERT_NE(cache.FindOrCreate(imgC, { 100, 100 }, odr::PixelFormat::Straight), nullptr);
+    ASSERT_NE(cache.FindOrCreate(imgC, { 100, 100 }, odr::PixelFormat::Premultiplied), nullptr);
+    // Touch the first one, the second one is now the least recently used
+    ASSERT_NE(cache.Find(imgC, { 100, 100 }, odr::PixelFormat::Straight), nullptr);
+    ASSERT_NE(cache.FindOrCreate(imgC, { 50, 200 }, odr::PixelFormat::Straight), nullptr);
+
+    ASSERT_EQ(cache.GetEntryCount(), 2u);
+    ASSERT_LE(cache.GetByteSize(), cache.GetByteBudget());
+    ASSERT_NE(cache.Find(imgC, { 100, 100 }, odr::PixelFormat::Straight), nullptr);
+    ASSERT_EQ(cache.Find(imgC, { 100, 100 }, odr::PixelFormat::Premultiplied), nullptr);
+
+    // Larger than the whole budget
+    ASSERT_FALSE(cache.IsCacheable({ 200, 200 }));
+    ASSERT_EQ(cache.FindOrCreate(imgC, { 200, 200 }, odr::PixelFormat::Straight), nullptr);
+    ASSERT_EQ(cache.GetEntryCount(), 2u);
+}
+
+TEST_F(ScaledImageCacheTests, Invalidate) {
+    odr::Image imgA;
+    ASSERT_TRUE(imgA.Load(std::string(TESTING_IMAGES_DIR) + "image-A.rgba"));
+    odr::Image imgC;
+    ASSERT_TRUE(imgC.Load(std::string(TESTING_IMAGES_DIR) + "image-C.rgba"));
+
+    odr::ScaledImageCache cache(1024 * 1024);
+    ASSERT_NE(cache.FindOrCreate(imgA, { 100, 100 }, odr::PixelFormat::Straight), nullptr);
+    ASSERT_NE(cache.FindOrCreate(imgA, { 50, 50 }, odr::PixelFormat::Straight), nullptr);
+    ASSERT_NE(cache.FindOrCreate(imgC, { 100, 100 }, odr::PixelFormat::Straight), nullptr);
+
+    cache.Invalidate(imgA);
+    ASSERT_EQ(cache.GetEntryCount(), 1u);
+    ASSERT_EQ(cache.GetByteSize(), 100u * 100u * 4u);
+    ASSERT_EQ(cache.Find(imgA, { 100, 100 }, odr::PixelFormat::Straight), nullptr);
+
+    cache.Clear();
+    ASSERT_EQ(cache.GetEntryCount(), 0u);
+    ASSERT_EQ(cache.GetByteSize(), 0u);
+}
+
+TEST_F(ScaledImageCacheTests, SharedByEngines) {
+    odr::Image imgA;
+    ASSERT_TRUE(imgA.Load(std::string(TESTING_IMAGES_DIR) + "image-A.rgba"));
+    odr::Image imgB;
+    ASSERT_TRUE(imgB.Load(std::string(TESTING_IMAGES_DIR) + "image-B.rgba"));
+    odr::Image imgC;
+    ASSERT_TRUE(imgC.Load(std::string(TESTING_IMAGES_DIR) + "image-C.rgba"));
+
+    odr::Image testImage;
+    ASSERT_TRUE(testImage.Load(std::string(TESTING_IMAGES_DIR) + "test-image-composite_640x480.rgba"));
+
+    odr::RenderingEngineSettings settings;
+    settings.scaledImageCache = std::make_shared<odr::ScaledImageCache>(8 * 1024 * 1024);
+
+    for (const odr::RenderMode renderMode : { odr::RenderMode::Immediate, odr::RenderMode::Deferred }) {
+        settings.renderMode = renderMode;
+        odr::RenderingEngine engine(settings);
+
+        ASSERT_TRUE(engine.InitializeFrameBuffer({ 640, 480 }));
+        ASSERT_TRUE(engine.Draw(imgA, { -40, 60 }, { 720, 360 }));
+        ASSERT_TRUE(engine.DrawRectangle(
+            { 8, 8 },
+            { 624, 464 },
+            odr::PixelColor::RGBAlpha(0x00, 0x00, 0xFF, 12.5),
+            24,
+            odr::PixelColor::RGBAlpha(0x00, 0x40, 0x40, 100.0)));
+        ASSERT_TRUE(engine.Draw(imgB, { 0, 0 }, { 640, 480 }));
+        ASSERT_TRUE(engine.Draw(imgC, { 0, 0 }, { 256, 256 }));
+
+        odr::Image renderedImage;
+        ASSERT_TRUE(engine.Render(renderedImage));
+        ASSERT_EQ(testImage, renderedImage);
+    }
+
+    // Images B and C are drawn in their own size without the cache, the second engine reused the scaled image A
+    ASSERT_EQ(settings.scaledImageCache->GetMissCount(), 1u);
+    ASSERT_EQ(settings.scaledImageCache->GetHitCount(), 1u);
+}